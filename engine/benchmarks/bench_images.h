@@ -0,0 +1,59 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ventus {
+namespace bench {
+
+/**
+ * Synthetic photo-like BGR image: blurred noise, so JPEG sees texture
+ * and edges rather than flat color that compresses to nothing.
+ * @param width Image width
+ * @param height Image height
+ * @param seed Noise seed; equal seeds give equal images
+ */
+inline cv::Mat syntheticImage(int width, int height, uint64_t seed = 42) {
+    cv::Mat noise(height, width, CV_8UC3);
+    cv::RNG rng(seed);
+    rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat image;
+    cv::GaussianBlur(noise, image, cv::Size(7, 7), 0);
+    return image;
+}
+
+/**
+ * JPEG encoding of syntheticImage().
+ * @param quality libjpeg quality, 1-100
+ */
+inline std::vector<uint8_t> syntheticJpeg(int width, int height, int quality) {
+    std::vector<uint8_t> encoded;
+    cv::imencode(".jpg", syntheticImage(width, height), encoded,
+                 {cv::IMWRITE_JPEG_QUALITY, quality});
+    return encoded;
+}
+
+// Upload sizes seen in production: webcam, HD, phone photos
+constexpr int kImageSizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}, {4032, 3024}};
+
+inline void imageSizes(::benchmark::internal::Benchmark* b) {
+    for (const auto& size : kImageSizes) {
+        b->Args({size[0], size[1]});
+    }
+    b->ArgNames({"width", "height"});
+}
+
+// Each size at a typical and a high-quality phone JPEG setting
+inline void jpegSizes(::benchmark::internal::Benchmark* b) {
+    for (int quality : {75, 95}) {
+        for (const auto& size : kImageSizes) {
+            b->Args({size[0], size[1], quality});
+        }
+    }
+    b->ArgNames({"width", "height", "quality"});
+}
+
+}  // namespace bench
+}  // namespace ventus
@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+#include "bench_images.h"
+#include "inference_engine.h"
+#include "scene_classifier.h"
+#include "scene_postprocessor.h"
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+
+namespace ventus {
+namespace bench {
+
+namespace {
+
+bool fileExists(const std::string& path) {
+    return !path.empty() && std::ifstream(path).good();
+}
+
+// Model locations, overridable so the suite runs against real models;
+// falls back to the deployed model, then to the synthetic stand-in
+std::string modelPath(const char* env, const char* deployed, const char* synthetic) {
+    if (const char* path = std::getenv(env)) {
+        return path;
+    }
+    return fileExists(deployed) ? deployed : synthetic;
+}
+
+std::string sceneModelPath() {
+    return modelPath("VENTUS_SCENE_MODEL", "models/scene_classifier.tflite",
+                     VENTUS_TEST_MODEL_DIR "/scene_float.tflite");
+}
+
+std::string faceModelPath() {
+    return modelPath("VENTUS_FACE_MODEL", "models/face_detector.tflite",
+                     VENTUS_TEST_MODEL_DIR "/face_float.tflite");
+}
+
+// Shared across benchmark threads; built on first use so benchmarks that
+// need no model run without one
+SceneClassifier& sharedClassifier() {
+    static SceneClassifier classifier([] {
+        SceneClassifier::Config config;
+        config.model_path = sceneModelPath();
+        config.pool_size = 4;
+        config.num_threads = 1;
+        return config;
+    }());
+    return classifier;
+}
+
+InferenceEngine& sharedEngine() {
+    static InferenceEngine engine([] {
+        InferenceEngine::Config config;
+        config.scene_model_path = sceneModelPath();
+        if (fileExists(faceModelPath())) {
+            config.face_model_path = faceModelPath();
+        }
+        config.num_threads = 1;
+        config.pool_size = 4;
+        return config;
+    }());
+    return engine;
+}
+
+}  // namespace
+
+// Top-k and outdoor score over one image's class scores
+void BM_ScenePostprocess(benchmark::State& state) {
+    std::vector<int> outdoor_indices;
+    for (size_t i = 0; i < kOutdoorLabels.size(); ++i) {
+        outdoor_indices.push_back(static_cast<int>(i));
+    }
+    const int num_classes = static_cast<int>(kOutdoorLabels.size() + kIndoorLabels.size());
+    ScenePostprocessor postprocessor(num_classes, outdoor_indices, 5, 0.6f);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> score(0.0f, 1.0f);
+    std::vector<float> scores(num_classes);
+    for (float& s : scores) {
+        s = score(rng);
+    }
+
+    ClassificationResult result;
+    for (auto _ : state) {
+        postprocessor.run(scores.data(), result);
+        benchmark::DoNotOptimize(result.outdoor_score);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * num_classes * static_cast<int64_t>(sizeof(float)));
+}
+BENCHMARK(BM_ScenePostprocess);
+
+// Scene model invoke plus postprocessing on a prepared input tensor
+void BM_Classify(benchmark::State& state) {
+    if (!fileExists(sceneModelPath())) {
+        state.SkipWithError("Scene model not found; set VENTUS_SCENE_MODEL");
+        return;
+    }
+    SceneClassifier& classifier = sharedClassifier();
+    std::vector<uint8_t> input(classifier.inputBytes(), 0);
+    for (auto _ : state) {
+        ClassificationResult result = classifier.classify(input);
+        benchmark::DoNotOptimize(result.outdoor_score);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_Classify)->ThreadRange(1, 4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// A full request: decode, preprocess, both models and the verdict
+void BM_Verify(benchmark::State& state) {
+    if (!fileExists(sceneModelPath())) {
+        state.SkipWithError("Scene model not found; set VENTUS_SCENE_MODEL");
+        return;
+    }
+    const auto jpeg = syntheticJpeg(static_cast<int>(state.range(0)),
+                                    static_cast<int>(state.range(1)),
+                                    static_cast<int>(state.range(2)));
+    InferenceEngine& engine = sharedEngine();
+    for (auto _ : state) {
+        VerificationResult result = engine.verify(jpeg.data(), jpeg.size());
+        if (!result.success) {
+            state.SkipWithError(result.error_message.c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(result.verification_passed);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(jpeg.size()));
+}
+BENCHMARK(BM_Verify)->Apply(jpegSizes)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Verify)->Args({1920, 1080, 75})->Threads(4)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace bench
+}  // namespace ventus
+
+BENCHMARK_MAIN();
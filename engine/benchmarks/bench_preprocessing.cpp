@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+#include "bench_images.h"
+#include "preprocessing.h"
+
+namespace ventus {
+namespace bench {
+
+namespace {
+
+size_t pixelBytes(const cv::Mat& image) {
+    return image.total() * image.elemSize();
+}
+
+Preprocessor::Config formatConfig(TensorType type) {
+    Preprocessor::Config config;
+    config.input_format.type = type;
+    if (type != TensorType::kFloat32) {
+        config.input_format.scale = 1.0f / 255.0f;
+        config.input_format.zero_point = type == TensorType::kInt8 ? -128 : 0;
+    }
+    return config;
+}
+
+}  // namespace
+
+// JPEG decode as the engine does it, including DCT-scaled decode
+void BM_Decode(benchmark::State& state) {
+    const auto jpeg = syntheticJpeg(static_cast<int>(state.range(0)),
+                                    static_cast<int>(state.range(1)),
+                                    static_cast<int>(state.range(2)));
+    Preprocessor preprocessor;
+    for (auto _ : state) {
+        cv::Mat image = preprocessor.decode(jpeg.data(), jpeg.size());
+        benchmark::DoNotOptimize(image.data);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(jpeg.size()));
+}
+BENCHMARK(BM_Decode)->Apply(jpegSizes)->Unit(benchmark::kMicrosecond);
+
+// Baseline for the scaled decode: always decode at full resolution
+void BM_DecodeFullResolution(benchmark::State& state) {
+    const auto jpeg = syntheticJpeg(static_cast<int>(state.range(0)),
+                                    static_cast<int>(state.range(1)),
+                                    static_cast<int>(state.range(2)));
+    Preprocessor::Config config;
+    config.scaled_decode = false;
+    Preprocessor preprocessor(config);
+    for (auto _ : state) {
+        cv::Mat image = preprocessor.decode(jpeg.data(), jpeg.size());
+        benchmark::DoNotOptimize(image.data);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(jpeg.size()));
+}
+BENCHMARK(BM_DecodeFullResolution)->Apply(jpegSizes)->Unit(benchmark::kMicrosecond);
+
+// The resize step of Preprocessor::process, down to the model input
+void BM_Resize(benchmark::State& state) {
+    const cv::Mat image = syntheticImage(static_cast<int>(state.range(0)),
+                                         static_cast<int>(state.range(1)));
+    const Preprocessor preprocessor;
+    cv::Mat resized;
+    for (auto _ : state) {
+        cv::resize(image, resized,
+                   cv::Size(preprocessor.targetWidth(), preprocessor.targetHeight()),
+                   0, 0, cv::INTER_LINEAR);
+        benchmark::DoNotOptimize(resized.data);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pixelBytes(image)));
+}
+BENCHMARK(BM_Resize)->Apply(imageSizes)->Unit(benchmark::kMicrosecond);
+
+// Color conversion and normalization alone: the input is already at the
+// target size, so process skips the resize. Arg is the TensorType.
+void BM_Normalize(benchmark::State& state) {
+    Preprocessor preprocessor(formatConfig(static_cast<TensorType>(state.range(0))));
+    const cv::Mat image = syntheticImage(preprocessor.targetWidth(), preprocessor.targetHeight());
+    std::vector<uint8_t> tensor(preprocessor.tensorBytes());
+    for (auto _ : state) {
+        preprocessor.processInto(image, tensor.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pixelBytes(image)));
+}
+BENCHMARK(BM_Normalize)
+    ->Arg(static_cast<int>(TensorType::kFloat32))
+    ->Arg(static_cast<int>(TensorType::kUInt8))
+    ->Arg(static_cast<int>(TensorType::kInt8))
+    ->ArgName("format");
+
+// Resize and normalize from a decoded frame
+void BM_Process(benchmark::State& state) {
+    const cv::Mat image = syntheticImage(static_cast<int>(state.range(0)),
+                                         static_cast<int>(state.range(1)));
+    Preprocessor preprocessor;
+    std::vector<uint8_t> tensor(preprocessor.tensorBytes());
+    for (auto _ : state) {
+        preprocessor.processInto(image, tensor.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(pixelBytes(image)));
+}
+BENCHMARK(BM_Process)->Apply(imageSizes)->Unit(benchmark::kMicrosecond);
+
+// Everything between the uploaded bytes and the model input
+void BM_DecodeAndProcess(benchmark::State& state) {
+    const auto jpeg = syntheticJpeg(static_cast<int>(state.range(0)),
+                                    static_cast<int>(state.range(1)),
+                                    static_cast<int>(state.range(2)));
+    Preprocessor preprocessor;
+    std::vector<uint8_t> tensor(preprocessor.tensorBytes());
+    for (auto _ : state) {
+        cv::Mat image = preprocessor.decode(jpeg.data(), jpeg.size());
+        preprocessor.processInto(image, tensor.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(jpeg.size()));
+}
+BENCHMARK(BM_DecodeAndProcess)->Apply(jpegSizes)->Unit(benchmark::kMicrosecond);
+
+}  // namespace bench
+}  // namespace ventus
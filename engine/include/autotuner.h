@@ -0,0 +1,88 @@
+#pragma once
+
+#include "delegate_policy.h"
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * Startup calibration of intra-op threads, interpreter pool size and
+ * micro-batch size. Each candidate runs the real scene model on synthetic
+ * input under closed-loop load from pool_size * max_batch_size clients;
+ * the fastest candidate whose p99 latency meets the target wins.
+ */
+class Autotuner {
+public:
+    struct Config {
+        std::string scene_model_path;
+        DelegatePolicy delegate = DelegatePolicy::kXnnpack;
+        double p99_target_ms = 50.0;
+        double seconds_per_trial = 2.0;
+        int max_batch_wait_us = 2000;
+
+        // Candidates; empty thread and pool lists are derived from the
+        // host's hardware threads
+        std::vector<int> thread_counts;
+        std::vector<int> pool_sizes;
+        std::vector<int> batch_sizes = {1, 2, 4, 8};
+    };
+
+    /**
+     * Measurements of one candidate configuration.
+     */
+    struct Trial {
+        int num_threads = 1;
+        int pool_size = 1;
+        int max_batch_size = 1;
+        double images_per_second = 0.0;
+        double p50_ms = 0.0;
+        double p99_ms = 0.0;
+        std::string error;  // Set when the candidate could not run
+    };
+
+    struct Result {
+        Trial best;
+        std::vector<Trial> trials;
+        bool met_target = false;  // Otherwise best is the lowest-p99 trial
+    };
+
+    explicit Autotuner(const Config& config);
+
+    /**
+     * Run every candidate and pick one.
+     * @param log Progress lines are written here when non-null
+     * @throws std::runtime_error if no candidate could run at all
+     */
+    Result run(std::ostream* log = nullptr) const;
+
+    /**
+     * Identifies what a persisted result was tuned for: the model's
+     * content, the delegate, the latency target and the host's thread
+     * count. A result tuned for anything else is not reused.
+     */
+    std::string fingerprint() const;
+
+    /**
+     * Write a chosen configuration so later starts can skip the sweep.
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& path, const Trial& trial) const;
+
+    /**
+     * Read a configuration written by save().
+     * @return Nothing if the file is missing, malformed or was tuned for
+     *         a different fingerprint()
+     */
+    std::optional<Trial> load(const std::string& path) const;
+
+private:
+    Config config_;
+
+    std::vector<Trial> candidates() const;
+    Trial runTrial(const Trial& candidate) const;
+};
+
+}  // namespace ventus
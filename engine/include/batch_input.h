@@ -0,0 +1,94 @@
+#pragma once
+
+#include "result_cache.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * Sequential reader for ustar, GNU and pax tar archives. Every header
+ * block is checked against its checksum, and an archive that ends inside
+ * a header or a member's data is reported instead of read as shorter.
+ */
+class TarReader {
+public:
+    /**
+     * @param path Archive to read
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit TarReader(const std::string& path);
+
+    /**
+     * Advance to the next regular file, skipping whatever of the current
+     * member read() did not consume. GNU long names and pax path records
+     * apply to the member that follows them.
+     * @param name Set to the member's path inside the archive
+     * @return false at the end of the archive
+     * @throws std::runtime_error on a corrupt or truncated archive
+     */
+    bool next(std::string* name);
+
+    /**
+     * Contents of the member next() stopped at. Callable once per member.
+     * @throws std::runtime_error if the archive is truncated
+     */
+    std::vector<uint8_t> read();
+
+private:
+    std::string path_;
+    std::ifstream archive_;
+    uint64_t archive_size_ = 0;
+    uint64_t member_size_ = 0;
+    uint64_t next_header_ = 0;  // Offset of the block after the current member
+    bool member_unread_ = false;
+
+    [[noreturn]] void fail(const std::string& reason) const;
+    void seekTo(uint64_t offset);
+    bool readHeader(char* header);
+};
+
+/**
+ * Completed inputs of an offline batch run, so a re-run skips them. The
+ * file starts with the scene model hash it was written for; each further
+ * line is the key of an input whose result has reached the output.
+ */
+class BatchCheckpoint {
+public:
+    /**
+     * Load the checkpoint at `path`, or start one if it does not exist.
+     * @param path Checkpoint file; empty disables checkpointing
+     * @param model_hash Scene model hash the results come from
+     * @throws std::runtime_error if the file was written for another
+     *         model or cannot be written
+     */
+    BatchCheckpoint(const std::string& path, const std::string& model_hash);
+
+    /**
+     * Key recorded for an input: its path, or the archive path and
+     * member name joined by ':'.
+     */
+    static ContentHash key(const std::string& name);
+
+    bool enabled() const { return out_.is_open(); }
+    size_t size() const { return done_.size(); }
+
+    /**
+     * Read-only after construction, so workers may call it concurrently.
+     */
+    bool contains(const ContentHash& key) const { return done_.count(key) > 0; }
+
+    /**
+     * Record keys whose result lines have already been flushed.
+     */
+    void commit(const std::vector<ContentHash>& keys);
+
+private:
+    std::unordered_set<ContentHash, ContentHashHasher> done_;
+    std::ofstream out_;
+};
+
+}  // namespace ventus
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+namespace ventus {
+
+/**
+ * How pooled interpreters execute model ops.
+ */
+enum class DelegatePolicy {
+    kXnnpack,  // XNNPACK delegate; packed weights shared by a pool's interpreters
+    kBuiltin,  // TFLite's builtin kernels without any delegate
+    kMinimal   // Builtin kernels, registering only the ops Ventus models use
+};
+
+/**
+ * Lower-case policy name, as accepted by parseDelegatePolicy().
+ */
+const char* delegatePolicyName(DelegatePolicy policy);
+
+/**
+ * @throws std::invalid_argument for names other than xnnpack, builtin and minimal
+ */
+DelegatePolicy parseDelegatePolicy(const std::string& name);
+
+/**
+ * Mean Invoke() time of one interpreter under a delegate policy.
+ */
+struct DelegateBenchmark {
+    DelegatePolicy policy = DelegatePolicy::kXnnpack;
+    double invoke_ms = 0.0;
+    std::string error;  // Set when the model could not run under this policy
+};
+
+}  // namespace ventus
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+namespace ventus {
+
+/**
+ * Face detection result.
+ * Box is normalized to the source image: (x, y) is the top-left corner.
+ */
+struct FaceResult {
+    float x, y, width, height;
+    float confidence;
+};
+
+/**
+ * Mapping from model input coordinates back to the source image,
+ * undoing the letterbox padding: image = (model - offset) * scale.
+ */
+struct FaceLetterbox {
+    float offset_x = 0.0f;
+    float offset_y = 0.0f;
+    float scale_x = 1.0f;
+    float scale_y = 1.0f;
+};
+
+/**
+ * Candidate box in normalized model input coordinates.
+ */
+struct FaceDetection {
+    float xmin, ymin, xmax, ymax;
+    float score;  // Sigmoid of the anchor's logit
+};
+
+/**
+ * Anchor centers, normalized to the model input, stored as
+ * structure-of-arrays so decoding vectorizes.
+ */
+struct FaceAnchors {
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+// BlazeFace (short-range) reports one box per anchor
+constexpr int kFaceAnchors = 896;
+
+/**
+ * BlazeFace short-range anchor layout: 2 anchors per cell at stride 8,
+ * then 6 per cell at stride 16, in row-major cell order.
+ * @throws std::runtime_error if the input size does not yield 896 anchors
+ */
+FaceAnchors blazeFaceAnchors(int input_width, int input_height);
+
+/**
+ * Decode the raw model outputs into the anchors scoring at least the
+ * threshold.
+ * @param boxes kFaceAnchors rows of box_stride regressors; the first four
+ *        are center offset and size in input pixels
+ * @param scores kFaceAnchors logits
+ * @return Candidates in anchor order
+ */
+std::vector<FaceDetection> decodeFaceCandidates(const float* boxes, int box_stride,
+                                                const float* scores,
+                                                const FaceAnchors& anchors,
+                                                int input_width, int input_height,
+                                                float score_threshold);
+
+/**
+ * Weighted non-maximum suppression: each cluster of boxes overlapping
+ * the strongest remaining one by more than iou_threshold is averaged by
+ * score and keeps the score of that strongest member. The merged boxes
+ * are then mapped back to the source image.
+ * @return At most max_faces faces, sorted by descending confidence
+ */
+std::vector<FaceResult> mergeFaceDetections(std::vector<FaceDetection> candidates,
+                                            const FaceLetterbox& letterbox,
+                                            float iou_threshold, int max_faces);
+
+}  // namespace ventus
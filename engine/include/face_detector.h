@@ -0,0 +1,96 @@
+#pragma once
+
+#include "delegate_policy.h"
+#include "face_decode.h"
+#include "preprocessing.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ventus {
+
+class InterpreterPool;
+
+/**
+ * BlazeFace (short-range) face detector on TFLite.
+ * Letterboxes the already-decoded frame into the 128x128 model input,
+ * decodes the 896 SSD anchors and merges overlapping detections with
+ * weighted non-maximum suppression.
+ */
+class FaceDetector {
+public:
+    struct Config {
+        std::string model_path;
+        int num_threads = 1;
+        int pool_size = 1;
+        DelegatePolicy delegate = DelegatePolicy::kXnnpack;
+        float score_threshold = 0.5f;
+        float iou_threshold = 0.3f;  // Overlap at which detections merge
+        int max_faces = 8;
+    };
+
+    using Letterbox = FaceLetterbox;
+
+    explicit FaceDetector(const Config& config);
+    ~FaceDetector();
+
+    // Prevent copying
+    FaceDetector(const FaceDetector&) = delete;
+    FaceDetector& operator=(const FaceDetector&) = delete;
+
+    /**
+     * Detect faces in a decoded image.
+     * @param image Decoded BGR image, any size
+     * @param cancelled Optional flag; once set, detection returns no faces.
+     *        It is checked before and after the model runs, and between
+     *        ops only with builtin kernels: under XNNPACK the whole graph
+     *        is one delegated op, so a running Invoke() completes
+     * @return Faces sorted by descending confidence
+     */
+    std::vector<FaceResult> detect(const cv::Mat& image,
+                                   const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * Build the model input for an image without running the model, so
+     * preprocessing can happen on a different thread than inference.
+     * @param image Decoded BGR image, any size
+     * @param dst Output, inputBytes() bytes
+     * @return Letterbox to pass to detect() with the same input
+     */
+    Letterbox prepareInput(const cv::Mat& image, void* dst);
+
+    /**
+     * Detect faces in an input built by prepareInput().
+     * @param input inputBytes() bytes
+     * @param letterbox Returned by prepareInput() for this input
+     * @param cancelled Optional flag; once set, detection returns no faces.
+     *        It is checked before and after the model runs, and between
+     *        ops only with builtin kernels: under XNNPACK the whole graph
+     *        is one delegated op, so a running Invoke() completes
+     * @return Faces sorted by descending confidence
+     */
+    std::vector<FaceResult> detect(const uint8_t* input, const Letterbox& letterbox,
+                                   const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * Bytes in one model input image.
+     */
+    size_t inputBytes() const;
+
+    bool isReady() const { return ready_; }
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+
+    Config config_;
+    std::unique_ptr<Preprocessor> preprocessor_;
+    bool ready_ = false;
+
+    std::vector<FaceResult> run(int slot, const Letterbox& letterbox,
+                                const std::atomic<bool>* cancelled);
+};
+
+}  // namespace ventus
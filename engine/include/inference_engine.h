@@ -1,42 +1,98 @@
 #pragma once
 
+#include "face_detector.h"
+#include "micro_batcher.h"
 #include "preprocessing.h"
+#include "request_deadline.h"
+#include "request_scheduler.h"
+#include "result_cache.h"
+#include "stage_metrics.h"
 #include "scene_classifier.h"
+#include "thread_topology.h"
 #include <memory>
 #include <atomic>
 #include <chrono>
+#include <mutex>
 
 namespace ventus {
 
-/**
- * Face detection result.
- */
-struct FaceResult {
-    float x, y, width, height;
-    float confidence;
-};
-
 /**
  * Complete verification result.
  */
 struct VerificationResult {
-    bool is_outdoor;
-    bool face_detected;
-    bool verification_passed;
+    bool is_outdoor = false;
+    bool face_detected = false;
+    bool verification_passed = false;
     
-    float outdoor_confidence;
-    float face_confidence;
+    float outdoor_confidence = 0.0f;
+    float face_confidence = 0.0f;
     
-    std::vector<ScenePrediction> scene_labels;
+    PredictionList scene_labels;
+    GateDecision gate_decision = GateDecision::kNone;
+    float gate_score = 0.0f;
     std::vector<FaceResult> faces;
     
-    int64_t inference_time_ms;
-    int64_t preprocessing_time_ms;
+    int64_t inference_time_ms = 0;
+    int64_t preprocessing_time_ms = 0;
+    DecodeInfo decode;
+    bool cache_hit = false;  // Served from the result cache; timings are this request's
+    StageTimings timings;
+    
+    bool success = false;
+    bool shed = false;  // Dropped unfinished: cancelled or past its deadline
+    std::string error_message;
+};
+
+/**
+ * One loaded version of the scene model and everything derived from it.
+ * Requests hold their generation until they finish, so a reload never
+ * swaps models under a running request; the last request using a
+ * replaced generation frees it.
+ */
+struct ModelGeneration {
+    int64_t id = 0;  // 1 at startup, incremented by every reload
+    std::string model_path;
+    ContentHash model_hash;  // Scene model file, combined with the gate model's
+    std::chrono::system_clock::time_point loaded_at;
+    HashKey cache_key;  // Process secret keyed by the config fingerprint and model_hash
+    std::unique_ptr<SceneClassifier> classifier;
+    std::unique_ptr<Preprocessor> preprocessor;  // Emits the classifier's input format
+    std::unique_ptr<MicroBatcher> batcher;  // Micro-batching only; references classifier
+    std::vector<DelegateBenchmark> delegate_benchmarks;  // Empty unless benchmark_delegates
+};
+
+/**
+ * Decoded and preprocessed image, handed from the preprocessing
+ * stage to the inference stage.
+ */
+struct PreparedImage {
+    std::vector<uint8_t> tensor;  // Model input bytes in the classifier's input format
+    std::vector<uint8_t> face_tensor;  // Face detector input; empty without one
+    FaceDetector::Letterbox face_letterbox;
+    int64_t preprocessing_time_us = 0;
+    DecodeInfo decode;
+    StageTimings timings;  // Decode, preprocess and face input preparation
+    std::shared_ptr<ModelGeneration> generation;  // Model the tensor was prepared for
     
-    bool success;
+    bool success = false;
+    bool shed = false;  // Dropped before decode or preprocessing
     std::string error_message;
 };
 
+/**
+ * An image arriving in chunks. Chunks are decoded as they arrive at the
+ * scale and for the model generation current when the upload began, so
+ * only the undecoded tail of the bytes is held at any time.
+ */
+struct ImageUpload {
+    explicit ImageUpload(std::shared_ptr<ModelGeneration> model)
+        : generation(std::move(model)), decoder(*generation->preprocessor) {}
+
+    std::shared_ptr<ModelGeneration> generation;
+    Preprocessor::StreamDecoder decoder;
+    std::string error;  // First decode error; later chunks are dropped
+};
+
 /**
  * High-performance inference engine combining scene classification
  * and face detection for outdoor selfie verification.
@@ -45,9 +101,22 @@ class InferenceEngine {
 public:
     struct Config {
         std::string scene_model_path;
-        std::string face_model_path;
+        std::string face_model_path;  // Empty disables face detection
+        std::string gate_model_path;  // Empty disables the scene cascade
+        float gate_low = 0.1f;   // Gate outdoor scores in (gate_low, gate_high)
+        float gate_high = 0.9f;  // escalate to the full scene model
         int num_threads = 4;
-        bool use_gpu = false;
+        int pool_size = 0;  // Scene interpreters; 0 = one per num_threads inference CPUs
+        int preprocess_threads = 0;  // CPUs reserved for preprocessing; 0 = a quarter
+        int opencv_threads = 1;  // OpenCV threads per call
+        bool pin_threads = false;  // Pin workers and model thread pools to their CPUs
+        int max_batch_size = 1;  // 1 disables micro-batching
+        int max_batch_wait_us = 2000;
+        bool parallel_models = false;  // Run face detection alongside the scene model
+        bool early_cancel = false;  // Stop face detection once the scene rules out a pass
+        size_t cache_bytes = 0;  // Result cache for repeated uploads; 0 disables
+        DelegatePolicy delegate = DelegatePolicy::kXnnpack;
+        bool benchmark_delegates = false;  // Time every policy on each model load
         float outdoor_threshold = 0.6f;
         float face_threshold = 0.5f;
         int min_outdoor_labels = 2;
@@ -57,12 +126,58 @@ public:
     ~InferenceEngine();
 
     /**
-     * Verify an image for outdoor selfie criteria.
+     * Verify an image for outdoor selfie criteria. Before decode,
+     * preprocessing and invoke the request is shed if it was cancelled or
+     * the typical time of the remaining stages would overrun its deadline.
+     * @param image_data Raw JPEG/PNG bytes
+     * @param size Size of the byte array
+     * @param deadline When the result stops being useful
+     * @return Complete verification result; `shed` if dropped
+     */
+    VerificationResult verify(const uint8_t* image_data, size_t size,
+                              const RequestDeadline& deadline = {});
+
+    /**
+     * Preprocessing stage of verify(): decode and build the input tensor.
+     * Safe to run concurrently with infer() on other images.
      * @param image_data Raw JPEG/PNG bytes
      * @param size Size of the byte array
+     * @param deadline Checked before decode and before preprocessing
+     * @return Prepared image, or a failed one carrying the decode error
+     */
+    PreparedImage prepare(const uint8_t* image_data, size_t size,
+                          const RequestDeadline& deadline = {});
+
+    /**
+     * Start a chunked upload on the current scene model.
+     */
+    ImageUpload beginUpload() const;
+
+    /**
+     * Decode as far as the chunks received so far allow. A decode error
+     * is kept in the upload and reported by prepare(); it does not throw.
+     * @return false once the upload has failed and needs no more chunks
+     */
+    bool feed(ImageUpload& upload, const uint8_t* data, size_t size) const;
+
+    /**
+     * Preprocessing stage for a completed upload: finish the decode and
+     * build the input tensors. Uploads bypass the result cache, since the
+     * full bytes to hash are never held.
+     * @param deadline Checked before the final decode and preprocessing
+     * @return Prepared image for infer(); decode time is what feed() and
+     *         the final step spent decoding, not the upload's duration
+     */
+    PreparedImage prepare(ImageUpload& upload, const RequestDeadline& deadline = {});
+
+    /**
+     * Inference stage of verify(): run the models on a prepared image.
+     * @param prepared Output of prepare()
+     * @param deadline Checked before invoke
      * @return Complete verification result
      */
-    VerificationResult verify(const uint8_t* image_data, size_t size);
+    VerificationResult infer(const PreparedImage& prepared,
+                             const RequestDeadline& deadline = {});
 
     /**
      * Get engine statistics.
@@ -75,6 +190,55 @@ public:
     };
     Stats getStats() const;
 
+    /**
+     * Per-stage latency histograms. Stages outside the engine, such as
+     * response building, are recorded here by the caller.
+     */
+    StageMetrics& stageMetrics() { return stage_metrics_; }
+    const StageMetrics& stageMetrics() const { return stage_metrics_; }
+
+    /**
+     * Result cache statistics; all zero when the cache is disabled.
+     */
+    ResultCache<VerificationResult>::Stats getCacheStats() const;
+
+    /**
+     * Tensor arena bytes allocated by each pooled scene interpreter.
+     */
+    std::vector<size_t> interpreterArenaBytes() const;
+
+    /**
+     * How the process's CPUs are split between preprocessing and
+     * inference. Schedulers feeding the engine size and pin their workers
+     * from it.
+     */
+    const ThreadTopology& threadTopology() const { return topology_; }
+
+    /**
+     * Identity of the active scene model.
+     */
+    struct ModelInfo {
+        int64_t generation = 0;
+        std::string model_path;
+        std::string model_hash;  // Hex content hash
+        std::chrono::system_clock::time_point loaded_at;
+        DelegatePolicy delegate = DelegatePolicy::kXnnpack;
+        std::vector<DelegateBenchmark> delegate_benchmarks;
+    };
+    ModelInfo modelInfo() const;
+
+    /**
+     * Load a scene model into new interpreters, warm them up, and switch
+     * new requests to it. Requests already running finish on the previous
+     * model, which is freed once the last of them completes. Concurrent
+     * reloads run one at a time.
+     * @param model_path Scene model to load; empty reloads the current path
+     * @return The model now active
+     * @throws std::runtime_error if the model cannot be loaded; the
+     *         current model stays active
+     */
+    ModelInfo reloadModel(const std::string& model_path = "");
+
     /**
      * Check if engine is ready.
      */
@@ -87,16 +251,42 @@ public:
 
 private:
     Config config_;
-    std::unique_ptr<Preprocessor> preprocessor_;
-    std::unique_ptr<SceneClassifier> scene_classifier_;
+    ThreadTopology topology_;
+    std::shared_ptr<ModelGeneration> generation_;  // Read and replaced atomically
+    std::mutex reload_mutex_;
+    std::unique_ptr<FaceDetector> face_detector_;
+    std::unique_ptr<RequestScheduler> face_workers_;  // Parallel mode only
+    std::unique_ptr<ResultCache<VerificationResult>> cache_;
+    uint64_t config_fingerprint_ = 0;  // Seeds cache keys so config changes miss
+    HashKey cache_secret_;  // Random per process, so cache keys cannot be forged
     
     // Statistics
     std::atomic<int64_t> total_requests_{0};
     std::atomic<int64_t> successful_requests_{0};
-    std::atomic<double> total_latency_ms_{0.0};
+    std::atomic<int64_t> total_latency_us_{0};
     std::chrono::system_clock::time_point start_time_;
+    StageMetrics stage_metrics_;
 
-    std::vector<FaceResult> detectFaces(const std::vector<float>& input);
+    template <typename SceneFn, typename FaceFn>
+    ClassificationResult runModels(SceneFn scene, FaceFn face, std::vector<FaceResult>& faces,
+                                   int64_t& face_us);
+    bool scenePasses(const ClassificationResult& scene_result) const;
+    std::shared_ptr<ModelGeneration> currentGeneration() const;
+    std::shared_ptr<ModelGeneration> loadGeneration(const std::string& model_path,
+                                                    int64_t id) const;
+    VerificationResult verifyUncached(std::shared_ptr<ModelGeneration> generation,
+                                      const uint8_t* image_data, size_t size,
+                                      const RequestDeadline& deadline);
+    PreparedImage prepare(std::shared_ptr<ModelGeneration> generation,
+                          const uint8_t* image_data, size_t size,
+                          const RequestDeadline& deadline);
+    void buildTensors(Preprocessor& preprocessor, const cv::Mat& image,
+                      PreparedImage& prepared, const RequestDeadline& deadline);
+    void checkDeadline(Stage stage, const RequestDeadline& deadline);
+    void applyVerdict(const ClassificationResult& scene_result,
+                      std::vector<FaceResult> faces,
+                      VerificationResult& result) const;
+    void recordStats(const VerificationResult& result);
 };
 
 }  // namespace ventus
@@ -0,0 +1,56 @@
+#pragma once
+
+namespace tflite {
+class Interpreter;
+}
+
+namespace ventus {
+
+class InterpreterPool;
+
+/**
+ * Move-only handle to an interpreter checked out of an InterpreterPool.
+ * Returns the slot to the pool when destroyed. Kept free of TFLite
+ * headers so public classes can hold one.
+ */
+class InterpreterLease {
+public:
+    InterpreterLease() = default;
+    InterpreterLease(InterpreterPool* pool, int slot) : pool_(pool), slot_(slot) {}
+    ~InterpreterLease() { reset(); }
+
+    InterpreterLease(InterpreterLease&& other) noexcept
+        : pool_(other.pool_), slot_(other.slot_) {
+        other.pool_ = nullptr;
+        other.slot_ = -1;
+    }
+    InterpreterLease& operator=(InterpreterLease&& other) noexcept {
+        if (this != &other) {
+            reset();
+            pool_ = other.pool_;
+            slot_ = other.slot_;
+            other.pool_ = nullptr;
+            other.slot_ = -1;
+        }
+        return *this;
+    }
+
+    InterpreterLease(const InterpreterLease&) = delete;
+    InterpreterLease& operator=(const InterpreterLease&) = delete;
+
+    tflite::Interpreter* get() const;
+    tflite::Interpreter* operator->() const { return get(); }
+    int slot() const { return slot_; }
+    explicit operator bool() const { return pool_ != nullptr; }
+
+    /**
+     * Return the slot to the pool now; no-op on an empty lease.
+     */
+    void reset();
+
+private:
+    InterpreterPool* pool_ = nullptr;
+    int slot_ = -1;
+};
+
+}  // namespace ventus
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * High-dynamic-range histogram of non-negative integer values such as
+ * latencies in microseconds. Buckets are log-linear, as in HdrHistogram:
+ * each power-of-two range is split into kSubBuckets / 2 equal buckets, so
+ * any recorded value is reported within 1 / (kSubBuckets / 2) of its true
+ * value regardless of magnitude, in constant memory.
+ *
+ * Not thread-safe; record into one histogram per thread and merge().
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 8;
+    static constexpr int64_t kSubBuckets = int64_t{1} << kSubBucketBits;
+
+    /**
+     * @param max_value Largest distinguishable value; larger values are
+     *        recorded as max_value
+     */
+    explicit LatencyHistogram(int64_t max_value = int64_t{3600} * 1000 * 1000);
+
+    /**
+     * Record a value. Negative values are recorded as 0.
+     * @param count Number of occurrences to add
+     */
+    void record(int64_t value, int64_t count = 1);
+
+    /**
+     * Add another histogram's counts. Both must have the same max_value.
+     */
+    void merge(const LatencyHistogram& other);
+
+    void reset();
+
+    int64_t count() const { return total_count_; }
+    int64_t min() const;
+    int64_t max() const { return max_; }
+    double mean() const;
+
+    /**
+     * Smallest recorded value such that `percentile` percent of values are
+     * less than or equal to it, to the histogram's precision.
+     * @param percentile In [0, 100]
+     * @return 0 when empty
+     */
+    int64_t percentile(double percentile) const;
+
+    /**
+     * Number of recorded values in buckets at or below the one holding
+     * `value`, for cumulative exports such as Prometheus `le` buckets.
+     */
+    int64_t countAtOrBelow(int64_t value) const;
+
+    int64_t maxValue() const { return max_value_; }
+    double sum() const { return sum_; }
+
+private:
+    friend class ShardedHistogram;
+
+    int64_t max_value_;
+    std::vector<int64_t> counts_;
+    int64_t total_count_ = 0;
+    int64_t min_ = INT64_MAX;
+    int64_t max_ = 0;
+    double sum_ = 0.0;
+
+    static size_t bucketIndex(int64_t value);
+    static int64_t bucketHighest(size_t index);
+};
+
+/**
+ * Concurrent LatencyHistogram. Each thread records into one of a fixed
+ * set of shards with relaxed atomic adds, so recording never locks and
+ * rarely shares a cache line with another thread. Readers merge the
+ * shards into a snapshot; counts recorded during the merge may or may
+ * not be included.
+ */
+class ShardedHistogram {
+public:
+    /**
+     * @param max_value Largest distinguishable value
+     * @param num_shards Shards; threads beyond this many share them
+     */
+    explicit ShardedHistogram(int64_t max_value = int64_t{60} * 1000 * 1000,
+                              int num_shards = 8);
+
+    // Prevent copying
+    ShardedHistogram(const ShardedHistogram&) = delete;
+    ShardedHistogram& operator=(const ShardedHistogram&) = delete;
+
+    void record(int64_t value);
+
+    LatencyHistogram snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<int64_t>[]> counts;
+        std::atomic<int64_t> sum{0};
+        std::atomic<int64_t> min{INT64_MAX};
+        std::atomic<int64_t> max{0};
+    };
+
+    int64_t max_value_;
+    size_t num_buckets_;
+    std::vector<Shard> shards_;
+};
+
+}  // namespace ventus
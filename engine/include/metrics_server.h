@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace ventus {
+
+/**
+ * Minimal HTTP endpoint for metrics scrapes: answers GET /metrics with
+ * whatever the render callback returns, one connection at a time, on its
+ * own thread. Binds to loopback by default so metrics stay local.
+ */
+class MetricsServer {
+public:
+    struct Config {
+        int port = 9464;  // 0 picks a free port
+        std::string bind_address = "127.0.0.1";
+    };
+
+    /**
+     * Start listening.
+     * @param config Address to bind
+     * @param render Produces the response body for each scrape
+     * @throws std::runtime_error if the address cannot be bound
+     */
+    MetricsServer(const Config& config, std::function<std::string()> render);
+    ~MetricsServer();
+
+    // Prevent copying
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * Port actually bound, useful when Config::port is 0.
+     */
+    int port() const { return port_; }
+
+private:
+    std::function<std::string()> render_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+
+    void serve();
+    void handle(int client_fd);
+};
+
+}  // namespace ventus
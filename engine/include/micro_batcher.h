@@ -0,0 +1,73 @@
+#pragma once
+
+#include "scene_classifier.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace ventus {
+
+/**
+ * Dynamic micro-batching in front of SceneClassifier.
+ * Concurrent callers are grouped into one batch until it holds
+ * max_batch_size images or max_wait_us has passed since the first one
+ * arrived; the batch then runs as a single Invoke() and each caller gets
+ * its own result back. The first caller of a batch executes it, so no
+ * extra threads are needed and several batches can run at once on
+ * different pooled interpreters.
+ */
+class MicroBatcher {
+public:
+    struct Config {
+        int max_batch_size = 8;
+        int max_wait_us = 2000;
+    };
+
+    MicroBatcher(SceneClassifier& classifier, const Config& config);
+    ~MicroBatcher();
+
+    // Prevent copying
+    MicroBatcher(const MicroBatcher&) = delete;
+    MicroBatcher& operator=(const MicroBatcher&) = delete;
+
+    /**
+     * Classify one image as part of the next batch. Blocks until the
+     * batch containing this input has run.
+     * @param input Preprocessed float tensor (1, 224, 224, 3); float models only
+     * @return Classification result for this input
+     */
+    ClassificationResult classify(const std::vector<float>& input);
+
+    /**
+     * Classify one image, given as raw tensor bytes, as part of the next batch.
+     * @param input SceneClassifier::inputBytes() bytes in its inputFormat()
+     * @return Classification result for this input
+     */
+    ClassificationResult classify(const std::vector<uint8_t>& input);
+
+    /**
+     * Batching statistics.
+     */
+    struct Stats {
+        int64_t batches;
+        int64_t images;
+    };
+    Stats getStats() const;
+
+private:
+    struct Batch;
+
+    SceneClassifier& classifier_;
+    Config config_;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<Batch> open_batch_;
+    int64_t batches_ = 0;
+    int64_t images_ = 0;
+
+    ClassificationResult enqueue(const uint8_t* input);
+    void run(Batch& batch);
+};
+
+}  // namespace ventus
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ventus {
+namespace kernels {
+
+/**
+ * Per-channel affine transform fused into the BGR -> RGB conversion:
+ * dst[3p + c] = src[3p + 2 - c] * scale[c] + bias[c]
+ * where c indexes the RGB output channels.
+ */
+struct NormalizeParams {
+    float scale[3];
+    float bias[3];
+};
+
+/**
+ * Instruction set used by a kernel implementation.
+ */
+enum class Isa {
+    kScalar,
+    kSse41,
+    kAvx2,
+    kAvx512
+};
+
+using BgrToRgbFloatFn = void (*)(const uint8_t* src, float* dst, size_t pixels,
+                                 const NormalizeParams& params);
+
+/**
+ * Reference implementation; every SIMD variant must match it.
+ */
+void bgrToRgbFloatScalar(const uint8_t* src, float* dst, size_t pixels,
+                         const NormalizeParams& params);
+
+/**
+ * Best instruction set supported by the running CPU.
+ */
+Isa detectIsa();
+
+/**
+ * Whether the running CPU can execute kernels for an instruction set.
+ */
+bool isaSupported(Isa isa);
+
+const char* isaName(Isa isa);
+
+/**
+ * Kernel for a specific instruction set, or nullptr if it was not
+ * compiled in or the CPU lacks it.
+ */
+BgrToRgbFloatFn bgrToRgbFloatFor(Isa isa);
+
+/**
+ * Fused BGR uint8 -> normalized RGB float conversion using the best
+ * kernel for this CPU (selected once on first call).
+ * @param src Interleaved BGR bytes
+ * @param dst Output, pixels * 3 floats; may be an interpreter input tensor
+ * @param pixels Number of pixels to convert
+ */
+void bgrToRgbFloat(const uint8_t* src, float* dst, size_t pixels,
+                   const NormalizeParams& params);
+
+/**
+ * Per-channel lookup from a source byte straight to a quantized model
+ * input byte, indexed by RGB output channel. Since every input is one
+ * of 256 values, normalization and quantization fold into the table and
+ * the conversion needs no float math.
+ */
+struct QuantizeTable {
+    uint8_t lut[3][256];
+};
+
+/**
+ * Build the table for q = round(normalized / scale) + zero_point,
+ * saturated to the output type.
+ * @param params Normalization applied before quantization
+ * @param scale Quantization scale of the input tensor
+ * @param zero_point Quantization zero point of the input tensor
+ * @param is_signed int8 output (stored as its bit pattern) rather than uint8
+ */
+QuantizeTable buildQuantizeTable(const NormalizeParams& params, float scale,
+                                 int zero_point, bool is_signed);
+
+/**
+ * Fused BGR uint8 -> quantized RGB conversion through a QuantizeTable.
+ * @param src Interleaved BGR bytes
+ * @param dst Output, pixels * 3 bytes; uint8 or int8 input tensor
+ * @param pixels Number of pixels to convert
+ */
+void bgrToRgbQuantized(const uint8_t* src, uint8_t* dst, size_t pixels,
+                       const QuantizeTable& table);
+
+}  // namespace kernels
+}  // namespace ventus
@@ -1,11 +1,26 @@
 #pragma once
 
+#include "preprocess_kernels.h"
+#include "tensor_format.h"
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <cstdint>
 
 namespace ventus {
 
+/**
+ * How an image was decoded, reported in the timing breakdown.
+ */
+struct DecodeInfo {
+    int source_width = 0;   // From the JPEG header; 0 for other formats
+    int source_height = 0;
+    int scale_denom = 1;    // libjpeg DCT scaling: decoded at 1/scale_denom
+    int64_t decode_time_us = 0;
+    int64_t decode_time_saved_us = 0;  // Estimated vs. a full-resolution decode
+};
+
 /**
  * Image preprocessing pipeline for scene classification.
  * Handles resizing, normalization, and format conversion
@@ -19,43 +34,150 @@ public:
         bool normalize = true;
         float mean[3] = {0.485f, 0.456f, 0.406f};  // ImageNet means
         float std[3] = {0.229f, 0.224f, 0.225f};   // ImageNet stds
+        TensorFormat input_format;  // Model input type; quantized skips floats
+        bool scaled_decode = true;  // Decode JPEGs at reduced DCT scale
+        size_t max_stream_decode_bytes = 128 << 20;  // libjpeg memory per StreamDecoder
     };
 
-    explicit Preprocessor(const Config& config = Config{});
+    Preprocessor();
+    explicit Preprocessor(const Config& config);
+
+    /**
+     * Decodes an image that arrives in pieces, doing the decode work as
+     * bytes arrive instead of after the last one. JPEGs go to libjpeg as a
+     * suspending source at the DCT scale decode() would pick, and only the
+     * compressed bytes libjpeg has not consumed yet are held.
+     *
+     * A baseline JPEG then needs a few rows of working memory. A
+     * progressive JPEG cannot produce pixels before its last scan, so
+     * libjpeg keeps the DCT coefficients of the whole image at full
+     * resolution, about 2 bytes per sample (36 MB for a 12 MP 4:2:0
+     * photo) whatever the scale, and memory grows with the image after
+     * all. libjpeg's memory is capped at Config::max_stream_decode_bytes;
+     * a progressive image whose coefficients alone exceed it is rejected
+     * as soon as its header arrives. Other formats are buffered whole and
+     * decoded by finish(). Not thread-safe; the Preprocessor must outlive
+     * it.
+     */
+    class StreamDecoder {
+    public:
+        explicit StreamDecoder(Preprocessor& preprocessor);
+        ~StreamDecoder();
+
+        StreamDecoder(StreamDecoder&&) noexcept;
+        StreamDecoder& operator=(StreamDecoder&&) noexcept;
+
+        /**
+         * Decode as far as the bytes received so far allow.
+         * @throws std::runtime_error on corrupt input
+         */
+        void feed(const uint8_t* data, size_t size);
+
+        /**
+         * Treat the input as complete and return the image. A JPEG that
+         * ends early is decoded as far as it goes, as decode() would.
+         * @param info Optional, receives the scale and the decode time
+         *        spent across feed() and finish()
+         * @throws std::runtime_error if no image could be decoded
+         */
+        cv::Mat finish(DecodeInfo* info = nullptr);
+
+        size_t bytesReceived() const;
+
+        /**
+         * Compressed bytes currently held: the unconsumed tail for JPEGs,
+         * everything for other formats.
+         */
+        size_t bytesBuffered() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> state_;
+    };
 
     /**
      * Decode image from raw bytes (JPEG/PNG).
+     * The bytes are borrowed for the duration of the call, never copied.
+     * JPEGs are decoded at the smallest libjpeg scale (1/2, 1/4, 1/8)
+     * that still covers the target size, skipping most of the IDCT work.
      * @param data Raw image bytes
      * @param size Size of the byte array
+     * @param info Optional, receives the scale and decode timing
      * @return Decoded BGR image
      */
-    cv::Mat decode(const uint8_t* data, size_t size);
+    cv::Mat decode(const uint8_t* data, size_t size, DecodeInfo* info = nullptr);
 
     /**
      * Preprocess image for model inference.
      * Applies resize, color conversion, and normalization.
+     * Only valid for float input formats.
      * @param image Input BGR image
      * @return Preprocessed float tensor (NHWC format)
      */
     std::vector<float> process(const cv::Mat& image);
 
+    /**
+     * Preprocess straight into a caller-provided buffer, such as an
+     * interpreter's input tensor. Resizes, then converts BGR bytes to
+     * normalized RGB in one fused pass: SIMD floats for float models, a
+     * table lookup to quantized bytes for uint8/int8 models.
+     * @param image Input BGR image
+     * @param dst Output, tensorBytes() bytes (NHWC, config input_format)
+     */
+    void processInto(const cv::Mat& image, void* dst);
+
     /**
      * Full pipeline: decode + preprocess.
      * @param data Raw image bytes
      * @param size Size of the byte array
+     * @param info Optional, receives the scale and decode timing
      * @return Preprocessed float tensor
      */
-    std::vector<float> decodeAndProcess(const uint8_t* data, size_t size);
+    std::vector<float> decodeAndProcess(const uint8_t* data, size_t size,
+                                        DecodeInfo* info = nullptr);
+
+    /**
+     * Read image dimensions from a JPEG's SOF header without decoding.
+     * @return false if the bytes are not a JPEG or the header is truncated
+     */
+    static bool readJpegSize(const uint8_t* data, size_t size, int* width, int* height);
+
+    /**
+     * Largest libjpeg scale denominator (8, 4, 2, else 1) whose output
+     * still covers the target in both dimensions. Assumes the image may
+     * be rotated by EXIF orientation, so checks the shorter side against
+     * the longer target side.
+     */
+    static int chooseScaleDenom(int width, int height, int target_width, int target_height);
+
+    /**
+     * Time full-resolution against scaled decodes of a synthetic photo, so
+     * decode() can report decode_time_saved_us without ever repeating a
+     * request's decode at full resolution. Takes a few hundred ms; call
+     * once before serving. Until then the saving is reported as 0.
+     */
+    void calibrateDecode();
 
     // Accessors
     int targetWidth() const { return config_.target_width; }
     int targetHeight() const { return config_.target_height; }
+    const TensorFormat& inputFormat() const { return config_.input_format; }
+
+    /**
+     * Size of one preprocessed image in the configured input format.
+     */
+    size_t tensorBytes() const;
 
 private:
     Config config_;
-    
+    kernels::NormalizeParams params_;
+    kernels::QuantizeTable quantize_table_;  // Used for quantized formats
+
+    // Calibrated full-resolution / scaled decode time ratio per scale
+    // (indexed by log2 of the denominator), 0 until calibrateDecode()
+    std::atomic<float> full_decode_ratio_[4] = {};
+
     cv::Mat resize(const cv::Mat& image);
-    cv::Mat normalize(const cv::Mat& image);
 };
 
 }  // namespace ventus
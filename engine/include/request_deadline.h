@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace ventus {
+
+/**
+ * When a request stops being worth answering: its deadline, and a probe
+ * for the client having cancelled it. The engine consults both before
+ * each expensive stage and drops the request rather than spend CPU on a
+ * response nobody will read, such as the losing copy of a hedged retry.
+ */
+class RequestDeadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * No deadline and never cancelled.
+     */
+    RequestDeadline() = default;
+
+    /**
+     * @param deadline Time after which the response is useless
+     * @param cancelled Polled before each stage, e.g. wrapping
+     *        ServerContext::IsCancelled; empty if the caller cannot cancel
+     */
+    explicit RequestDeadline(Clock::time_point deadline,
+                             std::function<bool()> cancelled = {})
+        : deadline_(deadline), cancelled_(std::move(cancelled)) {}
+
+    Clock::time_point deadline() const { return deadline_; }
+    bool hasDeadline() const { return deadline_ != Clock::time_point::max(); }
+
+    bool cancelled() const { return cancelled_ && cancelled_(); }
+
+    /**
+     * Whether `work_us` more microseconds of work still end before the
+     * deadline.
+     */
+    bool canFinish(int64_t work_us) const {
+        return !hasDeadline() ||
+               Clock::now() + std::chrono::microseconds(work_us) <= deadline_;
+    }
+
+private:
+    Clock::time_point deadline_ = Clock::time_point::max();
+    std::function<bool()> cancelled_;
+};
+
+}  // namespace ventus
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "thread_topology.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * Bounded admission queue feeding a fixed set of inference workers.
+ * Keeps network threads free of model work and rejects new requests
+ * outright once the in-flight cap is reached, so overload surfaces as
+ * fast failures instead of unbounded queueing latency. Queued tasks run
+ * earliest deadline first; tasks without one run after every task that
+ * has one, and ties run in submission order.
+ */
+class RequestScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr Clock::time_point kNoDeadline = Clock::time_point::max();
+
+    struct Config {
+        int num_workers = 4;
+        int max_in_flight = 64;  // Queued + running requests
+        std::vector<CpuSet> worker_cpus;  // Worker i pinned to entry i modulo size; empty = unpinned
+    };
+
+    explicit RequestScheduler(const Config& config);
+    ~RequestScheduler();
+
+    // Prevent copying
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+    /**
+     * Admit a task for execution on a worker thread.
+     * @param task Work to run; must not throw
+     * @param deadline Orders the queue; the task still runs once it passes
+     * @return false if the scheduler is at capacity or shutting down
+     */
+    bool trySubmit(std::function<void()> task, Clock::time_point deadline = kNoDeadline);
+
+    /**
+     * Admit a task, blocking while the scheduler is at capacity.
+     * Used where the caller should feel backpressure rather than fail.
+     * @param task Work to run; must not throw
+     * @param deadline Orders the queue; the task still runs once it passes
+     * @return false if the scheduler is shutting down
+     */
+    bool submit(std::function<void()> task, Clock::time_point deadline = kNoDeadline);
+
+    /**
+     * Claim an in-flight slot for a request that runs as a sequence of
+     * tasks, such as one per upload chunk, so the request is admitted or
+     * rejected once rather than once per task. Its tasks then go through
+     * submitReserved() until release().
+     * @return false if the scheduler is at capacity or shutting down
+     */
+    bool tryReserve();
+
+    /**
+     * Queue a task in a slot claimed by tryReserve(). Never rejected for
+     * capacity, and the slot stays claimed after the task runs.
+     * @param task Work to run; must not throw
+     * @param deadline Orders the queue; the task still runs once it passes
+     * @return false if the scheduler is shutting down
+     */
+    bool submitReserved(std::function<void()> task, Clock::time_point deadline = kNoDeadline);
+
+    /**
+     * Give back a slot claimed by tryReserve().
+     */
+    void release();
+
+    /**
+     * Stop admitting work, drain the queue and join workers.
+     */
+    void shutdown();
+
+    /**
+     * Scheduler statistics.
+     */
+    struct Stats {
+        int64_t admitted;
+        int64_t rejected;
+        int in_flight;
+        int queue_depth;
+    };
+    Stats getStats() const;
+
+    int numWorkers() const { return static_cast<int>(workers_.size()); }
+
+private:
+    Config config_;
+    std::vector<std::thread> workers_;
+
+    struct Entry {
+        Clock::time_point deadline;
+        uint64_t sequence;
+        std::function<void()> task;
+        bool reserved;  // Runs in a slot held by tryReserve()
+    };
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable capacity_available_;
+    std::vector<Entry> queue_;  // Min-heap on (deadline, sequence)
+    uint64_t next_sequence_ = 0;
+    int in_flight_ = 0;
+    bool stopping_ = false;
+
+    std::atomic<int64_t> admitted_{0};
+    std::atomic<int64_t> rejected_{0};
+
+    void workerLoop(int index);
+    void push(std::function<void()> task, Clock::time_point deadline, bool reserved = false);
+};
+
+}  // namespace ventus
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * 128-bit content hash used as a cache key.
+ */
+struct ContentHash {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool operator==(const ContentHash& other) const {
+        return hi == other.hi && lo == other.lo;
+    }
+};
+
+struct ContentHashHasher {
+    size_t operator()(const ContentHash& hash) const { return static_cast<size_t>(hash.lo); }
+};
+
+/**
+ * Fast non-cryptographic hash of a byte range, processing 8 bytes per
+ * step in two interleaved lanes. Different seeds give different keys for
+ * the same bytes, so configuration can be folded in via the seed. Not
+ * collision resistant: use keyedHash() for anything an uploader controls.
+ */
+ContentHash hashBytes(const uint8_t* data, size_t size, uint64_t seed = 0);
+
+/**
+ * Secret key for keyedHash().
+ */
+struct HashKey {
+    uint64_t k0 = 0;
+    uint64_t k1 = 0;
+
+    /**
+     * Fresh key from the OS entropy source.
+     */
+    static HashKey random();
+};
+
+/**
+ * SipHash-2-4, 128-bit output. Without the key, inputs that collide
+ * cannot be found faster than by brute force, so a match can stand in for
+ * comparing the bytes themselves. Several times slower than hashBytes().
+ */
+ContentHash keyedHash(const uint8_t* data, size_t size, const HashKey& key);
+
+/**
+ * 32 lower-case hex digits, high word first.
+ */
+std::string toHex(const ContentHash& hash);
+
+/**
+ * In-process LRU cache split into independently locked shards, bounded
+ * by the total cost of its entries. Concurrent lookups of a key that is
+ * being computed wait for that computation instead of repeating it.
+ */
+template <typename Value>
+class ResultCache {
+public:
+    struct Config {
+        size_t capacity = 64 << 20;  // Total cost across shards, in bytes
+        int num_shards = 16;
+    };
+
+    /**
+     * @param config Capacity and sharding
+     * @param cost Approximate bytes held by a value
+     */
+    ResultCache(const Config& config, std::function<size_t(const Value&)> cost)
+        : shards_(std::max(1, config.num_shards)), cost_(std::move(cost)) {
+        shard_capacity_ = config.capacity / shards_.size();
+    }
+
+    // Prevent copying
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /**
+     * Return the cached value for a key, or compute it once. Callers that
+     * arrive while the same key is being computed share that result.
+     * @param key Content hash of the request
+     * @param compute Produces the value on a miss; may throw
+     * @param cacheable Whether a computed value may be stored
+     * @param hit Optional, set to whether the value was not computed by this call
+     * @return The cached, shared or freshly computed value
+     */
+    Value getOrCompute(const ContentHash& key, const std::function<Value()>& compute,
+                       const std::function<bool(const Value&)>& cacheable,
+                       bool* hit = nullptr) {
+        Shard& shard = shardFor(key);
+        std::shared_ptr<Flight> flight;
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            auto cached = shard.index.find(key);
+            if (cached != shard.index.end()) {
+                // Refresh recency
+                shard.lru.splice(shard.lru.begin(), shard.lru, cached->second);
+                hits_++;
+                if (hit) {
+                    *hit = true;
+                }
+                return cached->second->value;
+            }
+
+            auto pending = shard.in_flight.find(key);
+            if (pending != shard.in_flight.end()) {
+                std::shared_future<Value> result = pending->second->result;
+                lock.unlock();
+                coalesced_++;
+                if (hit) {
+                    *hit = true;
+                }
+                return result.get();
+            }
+
+            flight = std::make_shared<Flight>();
+            flight->result = flight->promise.get_future().share();
+            shard.in_flight.emplace(key, flight);
+        }
+        misses_++;
+        if (hit) {
+            *hit = false;
+        }
+
+        Value value;
+        try {
+            value = compute();
+        } catch (...) {
+            finish(shard, key, nullptr);
+            flight->promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        finish(shard, key, cacheable(value) ? &value : nullptr);
+        flight->promise.set_value(value);
+        return value;
+    }
+
+    /**
+     * Cache statistics.
+     */
+    struct Stats {
+        int64_t hits;
+        int64_t misses;
+        int64_t evictions;
+        int64_t coalesced;  // Lookups that waited on an in-flight computation
+        int64_t entries;
+        int64_t bytes;
+    };
+
+    Stats getStats() const {
+        Stats stats;
+        stats.hits = hits_.load();
+        stats.misses = misses_.load();
+        stats.evictions = evictions_.load();
+        stats.coalesced = coalesced_.load();
+        stats.entries = 0;
+        stats.bytes = 0;
+        for (const Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.entries += static_cast<int64_t>(shard.lru.size());
+            stats.bytes += static_cast<int64_t>(shard.bytes);
+        }
+        return stats;
+    }
+
+private:
+    struct Entry {
+        ContentHash key;
+        Value value;
+        size_t cost;
+    };
+
+    struct Flight {
+        std::promise<Value> promise;
+        std::shared_future<Value> result;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // Most recently used first
+        std::unordered_map<ContentHash, typename std::list<Entry>::iterator,
+                           ContentHashHasher> index;
+        std::unordered_map<ContentHash, std::shared_ptr<Flight>, ContentHashHasher> in_flight;
+        size_t bytes = 0;
+    };
+
+    std::vector<Shard> shards_;
+    size_t shard_capacity_ = 0;
+    std::function<size_t(const Value&)> cost_;
+
+    std::atomic<int64_t> hits_{0};
+    std::atomic<int64_t> misses_{0};
+    std::atomic<int64_t> evictions_{0};
+    std::atomic<int64_t> coalesced_{0};
+
+    Shard& shardFor(const ContentHash& key) {
+        // Low bits pick the bucket within a shard, so shard on the high bits
+        return shards_[key.hi % shards_.size()];
+    }
+
+    // Retire the in-flight marker and store the value if it fits.
+    void finish(Shard& shard, const ContentHash& key, const Value* value) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.in_flight.erase(key);
+        if (!value || shard.index.count(key) > 0) {
+            return;
+        }
+
+        const size_t cost = sizeof(Entry) + cost_(*value);
+        if (cost > shard_capacity_) {
+            return;
+        }
+        shard.lru.push_front(Entry{key, *value, cost});
+        shard.index[key] = shard.lru.begin();
+        shard.bytes += cost;
+
+        while (shard.bytes > shard_capacity_) {
+            const Entry& oldest = shard.lru.back();
+            shard.bytes -= oldest.cost;
+            shard.index.erase(oldest.key);
+            shard.lru.pop_back();
+            evictions_++;
+        }
+    }
+};
+
+}  // namespace ventus
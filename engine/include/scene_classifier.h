@@ -1,31 +1,19 @@
 #pragma once
 
+#include "delegate_policy.h"
+#include "interpreter_lease.h"
+#include "result_cache.h"
+#include "scene_postprocessor.h"
+#include "tensor_format.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 
 namespace ventus {
 
-/**
- * Scene classification result for a single label.
- */
-struct ScenePrediction {
-    std::string label;
-    float confidence;
-    bool is_outdoor;
-};
-
-/**
- * Complete classification result.
- */
-struct ClassificationResult {
-    std::vector<ScenePrediction> predictions;
-    float outdoor_score;
-    bool is_outdoor;
-    int64_t inference_time_ms;
-};
-
 /**
  * Custom CNN-based scene classifier.
  * Trained on 40+ outdoor scene categories.
@@ -35,9 +23,40 @@ public:
     struct Config {
         std::string model_path;
         int num_threads = 4;
-        bool use_gpu = false;
+        DelegatePolicy delegate = DelegatePolicy::kXnnpack;
         float outdoor_threshold = 0.6f;
         int top_k = 5;
+        int pool_size = 1;  // Interpreters sharing the loaded model
+        int max_batch_size = 1;  // Largest batch passed to classifyBatch()
+
+        // Optional cascade: a small gate model with the same input and
+        // labels decides alone when its outdoor score is outside
+        // [gate_low, gate_high]; otherwise the full model runs
+        std::string gate_model_path;
+        float gate_low = 0.1f;
+        float gate_high = 0.9f;
+        int gate_pool_size = 0;  // 0 = same as pool_size
+    };
+
+    /**
+     * Interpreter checked out of the classifier's pool, tagged with the
+     * classifier so it cannot be passed to another one. Move-only.
+     * Returned to the pool on destruction or via checkin().
+     */
+    class Lease {
+    public:
+        Lease() = default;
+
+        int slot() const { return lease_.slot(); }
+        explicit operator bool() const { return static_cast<bool>(lease_); }
+
+    private:
+        friend class SceneClassifier;
+        Lease(const SceneClassifier* owner, InterpreterLease lease)
+            : owner_(owner), lease_(std::move(lease)) {}
+
+        const SceneClassifier* owner_ = nullptr;
+        InterpreterLease lease_;
     };
 
     explicit SceneClassifier(const Config& config);
@@ -49,11 +68,103 @@ public:
 
     /**
      * Classify preprocessed image tensor.
-     * @param input Preprocessed float tensor (1, 224, 224, 3)
+     * @param input Preprocessed float tensor (1, 224, 224, 3); float models only
      * @return Classification result with predictions
      */
     ClassificationResult classify(const std::vector<float>& input);
 
+    /**
+     * Classify using an interpreter the caller already holds.
+     * @param input Preprocessed float tensor (1, 224, 224, 3); float models only
+     * @param lease Interpreter obtained from checkout()
+     * @return Classification result with predictions
+     */
+    ClassificationResult classify(const std::vector<float>& input, Lease& lease);
+
+    /**
+     * Classify a preprocessed image given as raw tensor bytes.
+     * @param input inputBytes() bytes in inputFormat()
+     * @return Classification result with predictions
+     */
+    ClassificationResult classify(const std::vector<uint8_t>& input);
+
+    /**
+     * Classify several images with a single Invoke().
+     * Resizes the interpreter's batch dimension when it differs from the
+     * previous call on the same lease. With a gate, the whole batch goes
+     * through the gate in one Invoke() and only the images it escalates
+     * through the full model in another.
+     * @param inputs Pointers to preprocessed images, inputBytes() each in inputFormat()
+     * @param batch_size Number of entries in inputs
+     * @param lease Interpreter obtained from checkout()
+     * @return One result per input, in order
+     */
+    std::vector<ClassificationResult> classifyBatch(
+        const uint8_t* const* inputs, int batch_size, Lease& lease);
+
+    /**
+     * Float convenience overload of classifyBatch(); float models only.
+     * @param inputs Pointers to preprocessed float tensors (224, 224, 3)
+     */
+    std::vector<ClassificationResult> classifyBatch(
+        const float* const* inputs, int batch_size, Lease& lease);
+
+    /**
+     * First image slice of a leased interpreter's input tensor, so
+     * preprocessing can write into it directly.
+     * @return Buffer of inputBytes() bytes in inputFormat()
+     */
+    void* inputTensor(Lease& lease);
+
+    /**
+     * Classify the image already written to inputTensor(lease).
+     */
+    ClassificationResult classifyInPlace(Lease& lease);
+
+    /**
+     * Check out an interpreter, blocking until one is free.
+     */
+    Lease checkout();
+
+    /**
+     * Return an interpreter to the pool before the lease goes out of scope.
+     */
+    void checkin(Lease& lease);
+
+    /**
+     * Number of elements in one preprocessed input image.
+     */
+    size_t inputSize() const;
+
+    /**
+     * Bytes in one preprocessed input image: inputSize() elements of
+     * inputFormat().
+     */
+    size_t inputBytes() const;
+
+    /**
+     * Model input tensor type and quantization. Quantized models take
+     * uint8/int8 pixels directly.
+     */
+    const TensorFormat& inputFormat() const;
+
+    /**
+     * Model output tensor type and quantization. Quantized scores are
+     * dequantized before postprocessing.
+     */
+    const TensorFormat& outputFormat() const;
+
+    /**
+     * Number of interpreters in the pool.
+     */
+    int poolSize() const;
+
+    /**
+     * Tensor arena bytes allocated by each pooled interpreter at its
+     * current batch size.
+     */
+    std::vector<size_t> interpreterArenaBytes() const;
+
     /**
      * Get all class labels.
      */
@@ -64,6 +175,34 @@ public:
      */
     const std::vector<int>& getOutdoorIndices() const { return outdoor_indices_; }
 
+    /**
+     * Whether a gate model fronts the full model.
+     */
+    bool hasGate() const;
+
+    /**
+     * Content hash of the scene model file, combined with the gate
+     * model's when there is one.
+     */
+    ContentHash modelHash() const;
+
+    DelegatePolicy delegatePolicy() const { return config_.delegate; }
+
+    /**
+     * Time the scene model under every delegate policy, one fresh
+     * interpreter each. Takes a few invocations per policy, so call it
+     * at load time rather than while serving.
+     * @param runs Timed invocations per policy
+     */
+    std::vector<DelegateBenchmark> benchmarkDelegates(int runs = 10) const;
+
+    /**
+     * Run every pooled interpreter once on a blank image so the first
+     * requests don't pay for cold caches and lazily initialized kernels.
+     * Only call before the classifier is shared with other threads.
+     */
+    void warmup();
+
     /**
      * Check if model is loaded and ready.
      */
@@ -71,6 +210,7 @@ public:
 
 private:
     class Impl;
+    struct SlotShape;
     std::unique_ptr<Impl> impl_;
 
     Config config_;
@@ -80,6 +220,15 @@ private:
 
     void loadLabels();
     void initializeOutdoorMapping();
+    tflite::Interpreter* leasedInterpreter(const Lease& lease) const;
+    void ensureBatchSize(InterpreterPool& pool, int slot, SlotShape& state, int batch_size);
+    void zeroPadding(tflite::Interpreter* interpreter, SlotShape& state, int batch_size);
+    void requireFloatInput() const;
+    void loadGate();
+    std::vector<int> runGate(const uint8_t* const* inputs, int batch_size,
+                             ClassificationResult* results);
+    void invoke(tflite::Interpreter* interpreter, int slot, int batch_size,
+                ClassificationResult* results);
 };
 
 // Outdoor scene labels (40+ categories)
@@ -93,5 +242,17 @@ inline const std::vector<std::string> kOutdoorLabels = {
     "courtyard", "patio", "balcony", "rooftop", "trail", "path"
 };
 
+// Indoor labels for contrast, following the outdoor ones in model output order
+inline const std::vector<std::string> kIndoorLabels = {
+    "indoor", "room", "bedroom", "bathroom", "kitchen", "office",
+    "living_room", "hallway", "basement", "attic", "closet"
+};
+
+/**
+ * Label text for ScenePrediction::label_id.
+ * @throws std::out_of_range for unknown IDs
+ */
+const std::string& sceneLabelName(int label_id);
+
 }  // namespace ventus
 
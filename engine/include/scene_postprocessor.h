@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * Scene classification result for a single label.
+ * Label text is looked up from label_id only when building responses.
+ */
+struct ScenePrediction {
+    int label_id = -1;
+    float confidence = 0.0f;
+    bool is_outdoor = false;
+};
+
+/**
+ * Fixed-capacity list of top-k predictions, stored inline so results
+ * can be built and copied without heap allocation.
+ */
+class PredictionList {
+public:
+    static constexpr int kCapacity = 16;
+
+    void push_back(const ScenePrediction& prediction) {
+        if (size_ == kCapacity) {
+            throw std::length_error("PredictionList is full");
+        }
+        items_[size_++] = prediction;
+    }
+
+    void clear() { size_ = 0; }
+
+    size_t size() const { return static_cast<size_t>(size_); }
+    bool empty() const { return size_ == 0; }
+
+    const ScenePrediction& operator[](size_t i) const { return items_[i]; }
+    const ScenePrediction* begin() const { return items_.data(); }
+    const ScenePrediction* end() const { return items_.data() + size_; }
+
+private:
+    std::array<ScenePrediction, kCapacity> items_;
+    int size_ = 0;
+};
+
+/**
+ * Outcome of the cascade's gate model for one image.
+ */
+enum class GateDecision {
+    kNone,       // No gate model configured
+    kOutdoor,    // Gate confidently outdoor; full model skipped
+    kIndoor,     // Gate confidently indoor; full model skipped
+    kEscalated   // Gate inside its confidence band; full model ran
+};
+
+/**
+ * Complete classification result.
+ */
+struct ClassificationResult {
+    PredictionList predictions;
+    float outdoor_score = 0.0f;
+    bool is_outdoor = false;
+    int64_t inference_time_ms = 0;
+    GateDecision gate_decision = GateDecision::kNone;
+    float gate_score = 0.0f;  // Gate model's outdoor score, if it ran
+
+    // Stage breakdown in microseconds, gate and full model combined
+    int64_t tensor_copy_us = 0;
+    int64_t invoke_us = 0;
+    int64_t postprocess_us = 0;
+};
+
+/**
+ * Turns raw class scores into a ClassificationResult: outdoor score from
+ * a precomputed per-class weight vector, and top-k by partial sort into
+ * a per-thread index buffer. Does not allocate after a thread's first call.
+ */
+class ScenePostprocessor {
+public:
+    /**
+     * @param num_classes Number of scores per image
+     * @param outdoor_indices Classes that count towards the outdoor score
+     * @param top_k Predictions to keep, at most PredictionList::kCapacity
+     * @param outdoor_threshold Outdoor score at which an image is outdoor
+     */
+    ScenePostprocessor(int num_classes, const std::vector<int>& outdoor_indices,
+                       int top_k, float outdoor_threshold);
+
+    /**
+     * Postprocess one image's scores.
+     * @param scores num_classes() scores
+     * @param result Receives predictions and outdoor verdict; its
+     *        inference_time_ms is left untouched
+     */
+    void run(const float* scores, ClassificationResult& result) const;
+
+    int numClasses() const { return static_cast<int>(outdoor_weights_.size()); }
+
+private:
+    std::vector<float> outdoor_weights_;  // 1 for outdoor classes, else 0
+    int top_k_;
+    float outdoor_threshold_;
+};
+
+}  // namespace ventus
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "latency_histogram.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace ventus {
+
+/**
+ * Request processing stages with their own latency histograms.
+ */
+enum class Stage {
+    kDecode,         // Image bytes to pixels
+    kPreprocess,     // Resize, color conversion and normalization
+    kTensorCopy,     // Prepared tensor into the interpreter input
+    kInvoke,         // Scene model (and gate model) inference
+    kPostprocess,    // Dequantization, top-k and outdoor score
+    kFace,           // Face detection, including its own preprocessing
+    kResponseBuild,  // Result to protobuf response
+    kRequest,        // Whole request inside the engine
+    kCount
+};
+
+constexpr int kNumStages = static_cast<int>(Stage::kCount);
+
+/**
+ * Lower-case stage name used in metric labels.
+ */
+const char* stageName(Stage stage);
+
+/**
+ * Stage durations of one request in microseconds; -1 for stages that
+ * did not run.
+ */
+struct StageTimings {
+    std::array<int64_t, kNumStages> us;
+
+    StageTimings() { us.fill(-1); }
+
+    int64_t& operator[](Stage stage) { return us[static_cast<int>(stage)]; }
+    int64_t operator[](Stage stage) const { return us[static_cast<int>(stage)]; }
+};
+
+/**
+ * Microsecond histograms per stage, safe to record into from any thread
+ * without locking.
+ */
+class StageMetrics {
+public:
+    void record(Stage stage, int64_t us);
+
+    /**
+     * Record every stage that ran.
+     */
+    void record(const StageTimings& timings);
+
+    LatencyHistogram snapshot(Stage stage) const;
+
+    /**
+     * Recent typical duration of a stage, as an exponentially weighted
+     * average cheap enough to read on every request; 0 before any sample.
+     */
+    int64_t typicalUs(Stage stage) const {
+        return typical_us_[static_cast<int>(stage)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Count a request dropped before `stage` because it was cancelled or
+     * could no longer meet its deadline.
+     */
+    void recordShed(Stage stage) {
+        shed_[static_cast<int>(stage)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int64_t shed(Stage stage) const {
+        return shed_[static_cast<int>(stage)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Write all stages as one Prometheus histogram family,
+     * `ventus_stage_duration_seconds`, labelled by stage, followed by
+     * `ventus_requests_shed_total`.
+     */
+    void writePrometheus(std::ostream& out) const;
+
+private:
+    std::array<ShardedHistogram, kNumStages> histograms_;
+    std::array<std::atomic<int64_t>, kNumStages> typical_us_{};
+    std::array<std::atomic<int64_t>, kNumStages> shed_{};
+
+    void updateTypical(int stage, int64_t us);
+};
+
+}  // namespace ventus
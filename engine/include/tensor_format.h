@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ventus {
+
+/**
+ * Element type of a model input or output tensor.
+ */
+enum class TensorType {
+    kFloat32,
+    kUInt8,
+    kInt8
+};
+
+/**
+ * Element type and affine quantization of a model tensor:
+ * real = scale * (q - zero_point) for quantized types.
+ */
+struct TensorFormat {
+    TensorType type = TensorType::kFloat32;
+    float scale = 1.0f;
+    int zero_point = 0;
+
+    bool isQuantized() const { return type != TensorType::kFloat32; }
+
+    size_t elementSize() const { return isQuantized() ? 1 : sizeof(float); }
+};
+
+}  // namespace ventus
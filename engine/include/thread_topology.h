@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * CPU numbers, as used by sched_setaffinity.
+ */
+using CpuSet = std::vector<int>;
+
+/**
+ * Parse a kernel CPU list such as "0-3,8,10-11".
+ * @throws std::invalid_argument on malformed input
+ */
+CpuSet parseCpuList(const std::string& list);
+
+/**
+ * CPUs this process may run on, grouped by NUMA node.
+ */
+struct CpuTopology {
+    std::vector<CpuSet> nodes;  // Non-empty, ascending CPU numbers
+
+    /**
+     * Read the affinity mask and the NUMA layout from sysfs. Hosts without
+     * NUMA information report one node holding every allowed CPU.
+     */
+    static CpuTopology detect();
+
+    /**
+     * `nodes` nodes of `cpus_per_node` consecutive CPUs, for planning
+     * without a real host.
+     */
+    static CpuTopology uniform(int nodes, int cpus_per_node);
+
+    int cpuCount() const;
+};
+
+/**
+ * One thread budget for the whole process. The CPUs are split between
+ * preprocessing (decode, resize and color conversion) and inference, and
+ * the inference share is carved into one slice of num_threads CPUs per
+ * interpreter, each slice inside a single NUMA node where the node is
+ * large enough. OpenCV's own parallel_for is capped, since requests
+ * already run in parallel and nested parallelism only oversubscribes.
+ */
+class ThreadTopology {
+public:
+    struct Config {
+        int num_threads = 4;         // TFLite intra-op threads per interpreter
+        int pool_size = 0;           // Interpreters; 0 = one per inference slice
+        int preprocess_threads = 0;  // 0 = a quarter of the CPUs
+        int opencv_threads = 1;      // OpenCV threads per call
+        bool pin = false;            // Pin worker threads to their CPU sets
+    };
+
+    ThreadTopology(const CpuTopology& cpus, const Config& config);
+
+    int numThreads() const { return num_threads_; }
+    int poolSize() const { return pool_size_; }
+    int preprocessThreads() const { return static_cast<int>(preprocess_cpus_.size()); }
+    int opencvThreads() const { return config_.opencv_threads; }
+    bool pinned() const { return config_.pin; }
+    const CpuTopology& cpus() const { return cpus_; }
+
+    const CpuSet& preprocessCpus() const { return preprocess_cpus_; }
+    const CpuSet& inferenceCpus() const { return inference_cpus_; }
+
+    /**
+     * CPU set for each inference worker: the inference CPUs of the NUMA
+     * node holding that interpreter's slice. Workers check out whichever
+     * interpreter is free, so they are pinned per node rather than per
+     * slice. Worker i uses entry i modulo the size.
+     */
+    const std::vector<CpuSet>& inferenceWorkerCpus() const { return worker_cpus_; }
+
+    /**
+     * Apply the OpenCV thread cap. Process-wide.
+     */
+    void applyOpenCv() const;
+
+    /**
+     * One-line summary for startup logs.
+     */
+    std::string describe() const;
+
+private:
+    CpuTopology cpus_;
+    Config config_;
+    int num_threads_ = 1;
+    int pool_size_ = 1;
+    CpuSet preprocess_cpus_;
+    CpuSet inference_cpus_;
+    std::vector<CpuSet> worker_cpus_;
+};
+
+/**
+ * Restrict the calling thread to `cpus`; empty leaves it unchanged.
+ * Threads it creates afterwards inherit the set.
+ * @return false if the kernel rejected the set
+ */
+bool pinCurrentThread(const CpuSet& cpus);
+
+/**
+ * CPUs the calling thread may currently run on.
+ */
+CpuSet currentThreadAffinity();
+
+/**
+ * Pins the calling thread for the lifetime of the scope and restores its
+ * previous set afterwards. Used around interpreter construction so the
+ * thread pools TFLite and XNNPACK spawn inherit the inference CPUs.
+ */
+class ScopedAffinity {
+public:
+    explicit ScopedAffinity(const CpuSet& cpus);
+    ~ScopedAffinity();
+
+    // Prevent copying
+    ScopedAffinity(const ScopedAffinity&) = delete;
+    ScopedAffinity& operator=(const ScopedAffinity&) = delete;
+
+private:
+    CpuSet previous_;
+    bool active_ = false;
+};
+
+/**
+ * Scheduler counters for this process. Switches and CPU time cover its
+ * whole lifetime; run-queue wait covers only the threads alive now, so it
+ * can drop when a thread exits.
+ */
+struct SchedulerStats {
+    int64_t voluntary_switches = 0;    // Blocked, e.g. on a lock or I/O
+    int64_t involuntary_switches = 0;  // Preempted while runnable
+    int64_t cpu_time_ns = 0;           // User plus system
+    int64_t run_queue_wait_ns = 0;     // Live threads runnable but waiting for a CPU
+    int threads = 0;
+};
+
+/**
+ * Read SchedulerStats from getrusage() and each live thread's
+ * /proc/self/task/<tid>/schedstat.
+ * Fields the kernel does not expose stay zero.
+ */
+SchedulerStats readSchedulerStats();
+
+}  // namespace ventus
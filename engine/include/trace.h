@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * One completed span, as read back from a TraceRecorder.
+ */
+struct TraceEvent {
+    const char* name = "";   // Static string passed to TraceSpan
+    std::string request_id;  // Truncated to TraceRecorder::kMaxRequestIdBytes
+    int64_t start_us = 0;    // Steady clock
+    int64_t duration_us = 0;
+    uint32_t thread_id = 0;  // Small per-process thread number
+};
+
+/**
+ * Write `value` as a quoted JSON string, escaping quotes, backslashes and
+ * control characters.
+ */
+void writeJsonString(std::ostream& out, std::string_view value);
+
+/**
+ * Flight recorder for request spans: a fixed-size ring that always holds
+ * the most recent spans. Recording is lock-free and allocation-free, so it
+ * can stay on in production. A writer that finds its slot still being
+ * written by another, which takes a full lap of the ring, drops its span
+ * rather than waiting.
+ */
+class TraceRecorder {
+public:
+    static constexpr size_t kMaxRequestIdBytes = 32;
+
+    /**
+     * @param capacity Spans kept; rounded up to a power of two
+     */
+    explicit TraceRecorder(size_t capacity = 16384);
+
+    // Prevent copying
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    /**
+     * Process-wide recorder used by TraceSpan.
+     */
+    static TraceRecorder& global();
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Record a finished span.
+     * @param name Must outlive the recorder, e.g. a string literal
+     */
+    void record(const char* name, std::string_view request_id,
+                int64_t start_us, int64_t duration_us);
+
+    /**
+     * Spans currently in the ring, oldest first.
+     * @param request_id Only spans of this request; empty for all
+     * @param max_events Keep only the newest spans; 0 for all
+     */
+    std::vector<TraceEvent> snapshot(std::string_view request_id = {},
+                                     size_t max_events = 0) const;
+
+    /**
+     * Spans as Chrome trace-event JSON, loadable in chrome://tracing or
+     * Perfetto.
+     */
+    static std::string toChromeJson(const std::vector<TraceEvent>& events);
+
+    size_t capacity() const { return slots_.size(); }
+    int64_t recorded() const { return static_cast<int64_t>(head_.load(std::memory_order_relaxed)); }
+    int64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    static int64_t nowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    static constexpr size_t kRequestIdWords = kMaxRequestIdBytes / sizeof(uint64_t);
+
+    // Every field is atomic so a reader racing a writer sees a torn slot
+    // only through the sequence check, never through undefined behavior
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // Odd while being written
+        std::atomic<const char*> name{nullptr};
+        std::atomic<int64_t> start_us{0};
+        std::atomic<int64_t> duration_us{0};
+        std::atomic<uint32_t> thread_id{0};
+        std::array<std::atomic<uint64_t>, kRequestIdWords> request_id{};
+    };
+
+    std::vector<Slot> slots_;
+    size_t mask_;
+    std::atomic<uint64_t> head_{0};
+    std::atomic<int64_t> dropped_{0};
+    std::atomic<bool> enabled_{true};
+};
+
+/**
+ * Tags spans recorded on this thread with a request ID until the scope
+ * ends. Work handed to another thread needs its own scope there.
+ */
+class TraceScope {
+public:
+    explicit TraceScope(std::string_view request_id);
+    ~TraceScope();
+
+    // Prevent copying
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    /**
+     * Request ID of the innermost scope on this thread; empty outside one.
+     */
+    static std::string_view current();
+
+private:
+    std::string_view previous_;
+};
+
+/**
+ * Records the enclosing block as a span of the current request into the
+ * global recorder. Costs two clock reads when tracing is enabled and one
+ * relaxed load when it is not.
+ */
+class TraceSpan {
+public:
+    /**
+     * @param name Must outlive the recorder, e.g. a string literal
+     */
+    explicit TraceSpan(const char* name)
+        : name_(name),
+          start_us_(TraceRecorder::global().enabled() ? TraceRecorder::nowUs() : -1) {}
+
+    ~TraceSpan() {
+        if (start_us_ >= 0) {
+            TraceRecorder::global().record(name_, TraceScope::current(), start_us_,
+                                           TraceRecorder::nowUs() - start_us_);
+        }
+    }
+
+    // Prevent copying
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    int64_t start_us_;
+};
+
+}  // namespace ventus
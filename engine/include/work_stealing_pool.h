@@ -0,0 +1,101 @@
+#pragma once
+
+#include "thread_topology.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * Fixed worker pool for offline bulk work where tasks vary widely in
+ * cost (a 12 MP JPEG next to a thumbnail). Each worker owns a deque: it
+ * runs its own newest task first and, once empty, steals the oldest task
+ * of another worker, so no worker idles while others have a backlog.
+ * Submission blocks at the in-flight cap, which bounds the memory held
+ * by queued tasks such as image bytes read ahead of the workers.
+ */
+class WorkStealingPool {
+public:
+    struct Config {
+        int num_workers = 4;
+        int max_in_flight = 256;  // Queued + running tasks
+        std::vector<CpuSet> worker_cpus;  // Worker i pinned to entry i modulo size; empty = unpinned
+    };
+
+    explicit WorkStealingPool(const Config& config);
+    ~WorkStealingPool();
+
+    // Prevent copying
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Queue a task. From outside the pool, tasks are dealt to workers in
+     * turn and the call blocks while the pool is at capacity. From a
+     * worker, the task goes on that worker's own deque without blocking,
+     * so tasks may fan out into subtasks.
+     * @param task Work to run; must not throw
+     * @return false if the pool is shutting down
+     */
+    bool submit(std::function<void()> task);
+
+    /**
+     * Block until every submitted task has finished. Not callable from a
+     * worker.
+     */
+    void wait();
+
+    /**
+     * Stop admitting work, drain the queues and join workers.
+     */
+    void shutdown();
+
+    /**
+     * Index of the calling worker in [0, numWorkers()), or -1 when called
+     * from outside the pool. Lets tasks keep per-worker state.
+     */
+    static int currentWorker();
+
+    struct Stats {
+        int64_t executed;
+        int64_t stolen;  // Tasks run by a worker other than the one queued on
+        int in_flight;
+    };
+    Stats getStats() const;
+
+    int numWorkers() const { return static_cast<int>(workers_.size()); }
+
+private:
+    // Lock order: mutex_, then a worker's mutex
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    Config config_;
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::condition_variable capacity_available_;
+    int queued_ = 0;
+    int in_flight_ = 0;
+    bool stopping_ = false;
+    uint64_t next_worker_ = 0;
+
+    std::atomic<int64_t> executed_{0};
+    std::atomic<int64_t> stolen_{0};
+
+    void workerLoop(int index);
+    bool take(int index, std::function<void()>& task);
+};
+
+}  // namespace ventus
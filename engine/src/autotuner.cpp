@@ -0,0 +1,270 @@
+#include "autotuner.h"
+#include "latency_histogram.h"
+#include "mapped_file.h"
+#include "micro_batcher.h"
+#include "result_cache.h"
+#include "scene_classifier.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace ventus {
+
+namespace {
+
+int hardwareThreads() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+void appendUnique(std::vector<int>& values, int value) {
+    if (std::find(values.begin(), values.end(), value) == values.end()) {
+        values.push_back(value);
+    }
+}
+
+// Random image tensor in the model's input format; constant inputs can
+// take unrepresentative fast paths in some kernels
+std::vector<uint8_t> syntheticInput(const SceneClassifier& classifier) {
+    std::mt19937 random(42);
+    std::vector<uint8_t> input(classifier.inputBytes());
+    if (classifier.inputFormat().isQuantized()) {
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (uint8_t& value : input) {
+            value = static_cast<uint8_t>(byte(random));
+        }
+    } else {
+        std::uniform_real_distribution<float> pixel(-1.0f, 1.0f);
+        float* values = reinterpret_cast<float*>(input.data());
+        for (size_t i = 0; i < classifier.inputSize(); ++i) {
+            values[i] = pixel(random);
+        }
+    }
+    return input;
+}
+
+}  // namespace
+
+Autotuner::Autotuner(const Config& config) : config_(config) {
+    if (config_.p99_target_ms <= 0.0 || config_.seconds_per_trial <= 0.0) {
+        throw std::invalid_argument("Latency target and trial length must be positive");
+    }
+}
+
+std::vector<Autotuner::Trial> Autotuner::candidates() const {
+    const int cores = hardwareThreads();
+
+    std::vector<int> thread_counts = config_.thread_counts;
+    if (thread_counts.empty()) {
+        for (int threads = 1; threads <= cores; threads *= 2) {
+            thread_counts.push_back(threads);
+        }
+    }
+
+    std::vector<Trial> result;
+    for (int threads : thread_counts) {
+        // Fill the cores, or half of them to leave room for preprocessing
+        std::vector<int> pool_sizes = config_.pool_sizes;
+        if (pool_sizes.empty()) {
+            appendUnique(pool_sizes, std::max(1, cores / threads));
+            appendUnique(pool_sizes, std::max(1, cores / (2 * threads)));
+        }
+        for (int pool_size : pool_sizes) {
+            for (int batch_size : config_.batch_sizes) {
+                Trial trial;
+                trial.num_threads = threads;
+                trial.pool_size = pool_size;
+                trial.max_batch_size = batch_size;
+                result.push_back(trial);
+            }
+        }
+    }
+    return result;
+}
+
+Autotuner::Trial Autotuner::runTrial(const Trial& candidate) const {
+    Trial trial = candidate;
+    try {
+        SceneClassifier::Config classifier_config;
+        classifier_config.model_path = config_.scene_model_path;
+        classifier_config.num_threads = trial.num_threads;
+        classifier_config.pool_size = trial.pool_size;
+        classifier_config.max_batch_size = trial.max_batch_size;
+        classifier_config.delegate = config_.delegate;
+        SceneClassifier classifier(classifier_config);
+        classifier.warmup();
+
+        std::unique_ptr<MicroBatcher> batcher;
+        if (trial.max_batch_size > 1) {
+            MicroBatcher::Config batch_config;
+            batch_config.max_batch_size = trial.max_batch_size;
+            batch_config.max_wait_us = config_.max_batch_wait_us;
+            batcher = std::make_unique<MicroBatcher>(classifier, batch_config);
+        }
+        const std::vector<uint8_t> input = syntheticInput(classifier);
+
+        // Enough closed-loop clients to keep every interpreter's batches full
+        const int clients = trial.pool_size * trial.max_batch_size;
+        std::atomic<bool> stop{false};
+        std::mutex mutex;
+        LatencyHistogram latency_us;
+        std::string error;
+
+        std::vector<std::thread> threads;
+        const auto start = std::chrono::steady_clock::now();
+        for (int c = 0; c < clients; ++c) {
+            threads.emplace_back([&] {
+                LatencyHistogram local;
+                try {
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        auto call_start = std::chrono::steady_clock::now();
+                        if (batcher) {
+                            batcher->classify(input);
+                        } else {
+                            classifier.classify(input);
+                        }
+                        local.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - call_start).count());
+                    }
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    error = e.what();
+                    stop = true;
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                latency_us.merge(local);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(config_.seconds_per_trial));
+        stop = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const double elapsed_s = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+        trial.images_per_second = latency_us.count() / elapsed_s;
+        trial.p50_ms = latency_us.percentile(50) / 1000.0;
+        trial.p99_ms = latency_us.percentile(99) / 1000.0;
+    } catch (const std::exception& e) {
+        trial.error = e.what();
+    }
+    return trial;
+}
+
+Autotuner::Result Autotuner::run(std::ostream* log) const {
+    Result result;
+    const Trial* best_in_target = nullptr;
+    const Trial* lowest_p99 = nullptr;
+
+    std::vector<Trial> candidates = this->candidates();
+    result.trials.reserve(candidates.size());
+    for (const Trial& candidate : candidates) {
+        result.trials.push_back(runTrial(candidate));
+        const Trial& trial = result.trials.back();
+        if (log) {
+            *log << "  threads=" << trial.num_threads << " pool=" << trial.pool_size
+                 << " batch=" << trial.max_batch_size << ": ";
+            if (trial.error.empty()) {
+                *log << trial.images_per_second << " img/s, p50 " << trial.p50_ms
+                     << " ms, p99 " << trial.p99_ms << " ms" << std::endl;
+            } else {
+                *log << trial.error << std::endl;
+            }
+        }
+    }
+
+    // Pointers are taken only once the vector has stopped growing
+    for (const Trial& trial : result.trials) {
+        if (!trial.error.empty()) {
+            continue;
+        }
+        if (trial.p99_ms <= config_.p99_target_ms &&
+            (!best_in_target || trial.images_per_second > best_in_target->images_per_second)) {
+            best_in_target = &trial;
+        }
+        if (!lowest_p99 || trial.p99_ms < lowest_p99->p99_ms) {
+            lowest_p99 = &trial;
+        }
+    }
+    if (!lowest_p99) {
+        throw std::runtime_error("Autotuning failed: no candidate configuration could run");
+    }
+    result.met_target = best_in_target != nullptr;
+    result.best = result.met_target ? *best_in_target : *lowest_p99;
+    return result;
+}
+
+std::string Autotuner::fingerprint() const {
+    MappedFile model(config_.scene_model_path);
+    const ContentHash model_hash = hashBytes(reinterpret_cast<const uint8_t*>(model.data()),
+                                             model.size());
+    std::ostringstream text;
+    text << toHex(model_hash) << '-' << delegatePolicyName(config_.delegate)
+         << "-p99:" << config_.p99_target_ms << "-cpus:" << hardwareThreads();
+    return text.str();
+}
+
+void Autotuner::save(const std::string& path, const Trial& trial) const {
+    std::ofstream out(path, std::ios::trunc);
+    out << "# Written by ventus_server --autotune; delete to re-tune\n"
+        << "fingerprint=" << fingerprint() << "\n"
+        << "num_threads=" << trial.num_threads << "\n"
+        << "pool_size=" << trial.pool_size << "\n"
+        << "max_batch_size=" << trial.max_batch_size << "\n"
+        << "images_per_second=" << trial.images_per_second << "\n"
+        << "p50_ms=" << trial.p50_ms << "\n"
+        << "p99_ms=" << trial.p99_ms << "\n";
+    if (!out) {
+        throw std::runtime_error("Failed to write autotune result to " + path);
+    }
+}
+
+std::optional<Autotuner::Trial> Autotuner::load(const std::string& path) const {
+    std::ifstream in(path);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    std::map<std::string, std::string> values;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t equals = line.find('=');
+        if (line.empty() || line[0] == '#' || equals == std::string::npos) {
+            continue;
+        }
+        values[line.substr(0, equals)] = line.substr(equals + 1);
+    }
+    if (values["fingerprint"] != fingerprint()) {
+        return std::nullopt;
+    }
+
+    try {
+        Trial trial;
+        trial.num_threads = std::stoi(values.at("num_threads"));
+        trial.pool_size = std::stoi(values.at("pool_size"));
+        trial.max_batch_size = std::stoi(values.at("max_batch_size"));
+        trial.images_per_second = std::stod(values.at("images_per_second"));
+        trial.p50_ms = std::stod(values.at("p50_ms"));
+        trial.p99_ms = std::stod(values.at("p99_ms"));
+        if (trial.num_threads < 1 || trial.pool_size < 1 || trial.max_batch_size < 1) {
+            return std::nullopt;
+        }
+        return trial;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+}  // namespace ventus
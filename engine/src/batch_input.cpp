@@ -0,0 +1,214 @@
+#include "batch_input.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace ventus {
+
+namespace {
+
+constexpr uint64_t kBlock = 512;
+
+// Numeric header field: octal text, or GNU base-256 when the high bit of
+// the first byte is set
+uint64_t numericField(const char* field, size_t width) {
+    if (static_cast<unsigned char>(field[0]) & 0x80) {
+        uint64_t value = static_cast<unsigned char>(field[0]) & 0x7f;
+        for (size_t i = 1; i < width; ++i) {
+            value = (value << 8) | static_cast<unsigned char>(field[i]);
+        }
+        return value;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < width && field[i]; ++i) {
+        if (field[i] >= '0' && field[i] <= '7') {
+            value = value * 8 + static_cast<uint64_t>(field[i] - '0');
+        }
+    }
+    return value;
+}
+
+std::string textField(const char* text, size_t width) {
+    return std::string(text, strnlen(text, width));
+}
+
+// The checksum field itself counts as spaces. Some old writers summed
+// signed chars, so either sum is accepted.
+bool checksumMatches(const char* header) {
+    uint64_t unsigned_sum = 0;
+    int64_t signed_sum = 0;
+    for (size_t i = 0; i < kBlock; ++i) {
+        const char c = (i >= 148 && i < 156) ? ' ' : header[i];
+        unsigned_sum += static_cast<unsigned char>(c);
+        signed_sum += static_cast<signed char>(c);
+    }
+    const uint64_t stored = numericField(header + 148, 8);
+    return stored == unsigned_sum || static_cast<int64_t>(stored) == signed_sum;
+}
+
+bool isZeroBlock(const char* header) {
+    return std::all_of(header, header + kBlock, [](char c) { return c == '\0'; });
+}
+
+bool parseHex(const std::string& text, ContentHash* hash) {
+    if (text.size() != 32 ||
+        !std::all_of(text.begin(), text.end(), [](char c) { return std::isxdigit(c); })) {
+        return false;
+    }
+    hash->hi = std::strtoull(text.substr(0, 16).c_str(), nullptr, 16);
+    hash->lo = std::strtoull(text.substr(16).c_str(), nullptr, 16);
+    return true;
+}
+
+}  // namespace
+
+TarReader::TarReader(const std::string& path)
+    : path_(path), archive_(path, std::ios::binary | std::ios::ate) {
+    if (!archive_) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    archive_size_ = static_cast<uint64_t>(archive_.tellg());
+}
+
+void TarReader::fail(const std::string& reason) const {
+    throw std::runtime_error("Archive " + path_ + ": " + reason);
+}
+
+void TarReader::seekTo(uint64_t offset) {
+    if (offset > archive_size_) {
+        fail("truncated");
+    }
+    archive_.clear();
+    archive_.seekg(static_cast<std::streamoff>(offset));
+}
+
+bool TarReader::readHeader(char* header) {
+    // A missing end-of-archive marker is tolerated; half a header is not
+    if (next_header_ == archive_size_) {
+        return false;
+    }
+    if (next_header_ + kBlock > archive_size_) {
+        fail("truncated");
+    }
+    seekTo(next_header_);
+    if (!archive_.read(header, kBlock)) {
+        fail("truncated");
+    }
+    return true;
+}
+
+bool TarReader::next(std::string* name) {
+    member_unread_ = false;
+    std::string long_name;  // From a preceding GNU 'L' or pax 'x' member
+    char header[kBlock];
+    while (readHeader(header)) {
+        if (isZeroBlock(header)) {
+            return false;  // End-of-archive block
+        }
+        if (!checksumMatches(header)) {
+            fail("bad header checksum at offset " + std::to_string(next_header_));
+        }
+
+        const uint64_t size = numericField(header + 124, 12);
+        const uint64_t data = next_header_ + kBlock;
+        if (size > archive_size_ - data) {
+            fail("truncated");
+        }
+        next_header_ = data + (size + kBlock - 1) / kBlock * kBlock;
+        const char type = header[156];
+
+        if (type == 'L' || type == 'x') {
+            std::string text(size, '\0');
+            if (!archive_.read(&text[0], static_cast<std::streamsize>(size))) {
+                fail("truncated");
+            }
+            if (type == 'L') {
+                long_name = text.c_str();
+            } else {
+                // pax records: "<length> path=<name>\n"
+                const size_t at = text.find(" path=");
+                if (at != std::string::npos) {
+                    const size_t end = text.find('\n', at);
+                    long_name = text.substr(at + 6, end == std::string::npos ? end : end - at - 6);
+                }
+            }
+            continue;
+        }
+
+        if (type != '0' && type != '\0') {
+            long_name.clear();
+            continue;
+        }
+        if (!long_name.empty()) {
+            *name = long_name;
+        } else {
+            // Only POSIX ustar has a name prefix; GNU keeps other fields there
+            const bool ustar = std::memcmp(header + 257, "ustar", 6) == 0;
+            const std::string prefix = ustar ? textField(header + 345, 155) : std::string();
+            *name = (prefix.empty() ? "" : prefix + "/") + textField(header, 100);
+        }
+        member_size_ = size;
+        member_unread_ = true;
+        return true;
+    }
+    return false;
+}
+
+std::vector<uint8_t> TarReader::read() {
+    if (!member_unread_) {
+        throw std::logic_error("TarReader::read() without a current member");
+    }
+    member_unread_ = false;
+    std::vector<uint8_t> bytes(member_size_);
+    if (!archive_.read(reinterpret_cast<char*>(bytes.data()),
+                       static_cast<std::streamsize>(member_size_))) {
+        fail("truncated");
+    }
+    return bytes;
+}
+
+BatchCheckpoint::BatchCheckpoint(const std::string& path, const std::string& model_hash) {
+    if (path.empty()) {
+        return;
+    }
+    std::ifstream in(path);
+    const std::string header = "# ventus_batch model=" + model_hash;
+    std::string line;
+    if (in && std::getline(in, line)) {
+        if (line != header) {
+            throw std::runtime_error("Checkpoint " + path +
+                                     " was written for a different model (" + line + ")");
+        }
+        ContentHash key;
+        while (std::getline(in, line)) {
+            // A torn last line from a crash is simply redone
+            if (parseHex(line, &key)) {
+                done_.insert(key);
+            }
+        }
+        in.close();
+        out_.open(path, std::ios::app);
+    } else {
+        out_.open(path, std::ios::trunc);
+        out_ << header << "\n";
+        out_.flush();
+    }
+    if (!out_) {
+        throw std::runtime_error("Cannot write checkpoint " + path);
+    }
+}
+
+ContentHash BatchCheckpoint::key(const std::string& name) {
+    return hashBytes(reinterpret_cast<const uint8_t*>(name.data()), name.size());
+}
+
+void BatchCheckpoint::commit(const std::vector<ContentHash>& keys) {
+    for (const ContentHash& key : keys) {
+        out_ << toHex(key) << "\n";
+    }
+    out_.flush();
+}
+
+}  // namespace ventus
@@ -0,0 +1,26 @@
+#include "delegate_policy.h"
+#include <stdexcept>
+
+namespace ventus {
+
+const char* delegatePolicyName(DelegatePolicy policy) {
+    switch (policy) {
+        case DelegatePolicy::kXnnpack: return "xnnpack";
+        case DelegatePolicy::kBuiltin: return "builtin";
+        case DelegatePolicy::kMinimal: return "minimal";
+        default: return "unknown";
+    }
+}
+
+DelegatePolicy parseDelegatePolicy(const std::string& name) {
+    for (DelegatePolicy policy : {DelegatePolicy::kXnnpack, DelegatePolicy::kBuiltin,
+                                  DelegatePolicy::kMinimal}) {
+        if (name == delegatePolicyName(policy)) {
+            return policy;
+        }
+    }
+    throw std::invalid_argument("Unknown delegate policy: " + name +
+                                " (expected xnnpack, builtin or minimal)");
+}
+
+}  // namespace ventus
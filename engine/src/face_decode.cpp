@@ -0,0 +1,151 @@
+#include "face_decode.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace ventus {
+
+namespace {
+
+struct AnchorLayer {
+    int stride;
+    int anchors_per_cell;
+};
+constexpr AnchorLayer kAnchorLayers[] = {{8, 2}, {16, 6}};
+
+// Raw logits are clipped before the sigmoid, as in the reference graph
+constexpr float kScoreClip = 100.0f;
+
+float intersectionOverUnion(const FaceDetection& a, const FaceDetection& b) {
+    const float w = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
+    const float h = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
+    if (w <= 0.0f || h <= 0.0f) {
+        return 0.0f;
+    }
+    const float intersection = w * h;
+    const float area_a = (a.xmax - a.xmin) * (a.ymax - a.ymin);
+    const float area_b = (b.xmax - b.xmin) * (b.ymax - b.ymin);
+    return intersection / (area_a + area_b - intersection);
+}
+
+float clamp01(float v) {
+    return std::min(1.0f, std::max(0.0f, v));
+}
+
+}  // namespace
+
+FaceAnchors blazeFaceAnchors(int input_width, int input_height) {
+    FaceAnchors anchors;
+    anchors.x.reserve(kFaceAnchors);
+    anchors.y.reserve(kFaceAnchors);
+
+    for (const AnchorLayer& layer : kAnchorLayers) {
+        const int rows = (input_height + layer.stride - 1) / layer.stride;
+        const int cols = (input_width + layer.stride - 1) / layer.stride;
+        for (int y = 0; y < rows; ++y) {
+            for (int x = 0; x < cols; ++x) {
+                for (int a = 0; a < layer.anchors_per_cell; ++a) {
+                    anchors.x.push_back((x + 0.5f) / cols);
+                    anchors.y.push_back((y + 0.5f) / rows);
+                }
+            }
+        }
+    }
+
+    if (anchors.x.size() != kFaceAnchors) {
+        throw std::runtime_error("Face model input size does not match BlazeFace anchors");
+    }
+    return anchors;
+}
+
+std::vector<FaceDetection> decodeFaceCandidates(const float* boxes, int box_stride,
+                                                const float* scores,
+                                                const FaceAnchors& anchors,
+                                                int input_width, int input_height,
+                                                float score_threshold) {
+    const float inv_width = 1.0f / input_width;
+    const float inv_height = 1.0f / input_height;
+    const float* anchor_x = anchors.x.data();
+    const float* anchor_y = anchors.y.data();
+
+    // Branch-free decode of every anchor into model-normalized boxes
+    std::array<float, kFaceAnchors> cx;
+    std::array<float, kFaceAnchors> cy;
+    std::array<float, kFaceAnchors> half_w;
+    std::array<float, kFaceAnchors> half_h;
+    for (int i = 0; i < kFaceAnchors; ++i) {
+        const float* r = boxes + i * box_stride;
+        cx[i] = r[0] * inv_width + anchor_x[i];
+        cy[i] = r[1] * inv_height + anchor_y[i];
+        half_w[i] = 0.5f * r[2] * inv_width;
+        half_h[i] = 0.5f * r[3] * inv_height;
+    }
+
+    // Threshold in logit space so the sigmoid only runs on candidates
+    const float threshold = std::min(std::max(score_threshold, 1e-6f), 1.0f - 1e-6f);
+    const float logit_threshold = std::log(threshold / (1.0f - threshold));
+    std::vector<FaceDetection> candidates;
+    for (int i = 0; i < kFaceAnchors; ++i) {
+        if (scores[i] < logit_threshold || half_w[i] <= 0.0f || half_h[i] <= 0.0f) {
+            continue;
+        }
+        const float logit = std::min(kScoreClip, std::max(-kScoreClip, scores[i]));
+        FaceDetection d;
+        d.xmin = cx[i] - half_w[i];
+        d.ymin = cy[i] - half_h[i];
+        d.xmax = cx[i] + half_w[i];
+        d.ymax = cy[i] + half_h[i];
+        d.score = 1.0f / (1.0f + std::exp(-logit));
+        candidates.push_back(d);
+    }
+    return candidates;
+}
+
+std::vector<FaceResult> mergeFaceDetections(std::vector<FaceDetection> candidates,
+                                            const FaceLetterbox& letterbox,
+                                            float iou_threshold, int max_faces) {
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const FaceDetection& a, const FaceDetection& b) {
+                         return a.score > b.score;
+                     });
+
+    std::vector<FaceResult> faces;
+    std::vector<FaceDetection> remaining;
+    while (!candidates.empty() && static_cast<int>(faces.size()) < max_faces) {
+        const FaceDetection head = candidates.front();
+        FaceDetection merged{0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        float total_weight = 0.0f;
+        remaining.clear();
+        for (const FaceDetection& d : candidates) {
+            if (&d == &candidates.front() || intersectionOverUnion(head, d) > iou_threshold) {
+                merged.xmin += d.xmin * d.score;
+                merged.ymin += d.ymin * d.score;
+                merged.xmax += d.xmax * d.score;
+                merged.ymax += d.ymax * d.score;
+                total_weight += d.score;
+            } else {
+                remaining.push_back(d);
+            }
+        }
+        candidates.swap(remaining);
+
+        // Undo the letterbox to get coordinates in the source image
+        const float xmin = clamp01((merged.xmin / total_weight - letterbox.offset_x) * letterbox.scale_x);
+        const float ymin = clamp01((merged.ymin / total_weight - letterbox.offset_y) * letterbox.scale_y);
+        const float xmax = clamp01((merged.xmax / total_weight - letterbox.offset_x) * letterbox.scale_x);
+        const float ymax = clamp01((merged.ymax / total_weight - letterbox.offset_y) * letterbox.scale_y);
+
+        FaceResult face;
+        face.x = xmin;
+        face.y = ymin;
+        face.width = xmax - xmin;
+        face.height = ymax - ymin;
+        face.confidence = head.score;
+        faces.push_back(face);
+    }
+
+    return faces;
+}
+
+}  // namespace ventus
@@ -0,0 +1,205 @@
+#include "face_detector.h"
+#include "interpreter_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace ventus {
+
+namespace {
+
+bool isCancelled(const std::atomic<bool>* cancelled) {
+    return cancelled && cancelled->load(std::memory_order_relaxed);
+}
+
+// Polled by TFLite between ops; data is the slot's current cancel flag.
+// XNNPACK runs BlazeFace as a single delegated op, so there this never
+// interrupts a running Invoke() and only the checks around it apply.
+bool checkSlotCancelled(void* data) {
+    return isCancelled(*static_cast<const std::atomic<bool>**>(data));
+}
+
+}  // namespace
+
+class FaceDetector::Impl {
+public:
+    std::unique_ptr<InterpreterPool> pool;
+    int input_width = 0;
+    int input_height = 0;
+    TensorFormat input_format;
+    int boxes_output = 0;   // Output index of the box regressors
+    int scores_output = 1;  // Output index of the per-anchor logits
+    int box_stride = 16;    // Values per anchor in the regressor output
+    TensorFormat boxes_format;
+    TensorFormat scores_format;
+
+    FaceAnchors anchors;
+
+    // Dequantized outputs per slot, for quantized models
+    std::vector<std::vector<float>> slot_boxes;
+    std::vector<std::vector<float>> slot_scores;
+
+    // Cancel flag of the request running on each slot, read by TFLite
+    // from inside Invoke() on the same thread
+    std::vector<const std::atomic<bool>*> slot_cancel;
+};
+
+FaceDetector::FaceDetector(const Config& config)
+    : impl_(std::make_unique<Impl>()), config_(config) {
+
+    InterpreterPool::Config pool_config;
+    pool_config.model_path = config_.model_path;
+    pool_config.pool_size = config_.pool_size;
+    pool_config.num_threads = config_.num_threads;
+    pool_config.delegate = config_.delegate;
+    impl_->pool = std::make_unique<InterpreterPool>(pool_config);
+
+    tflite::Interpreter* interpreter = impl_->pool->interpreter(0);
+    const TfLiteTensor* input = interpreter->input_tensor(0);
+    if (input->dims->size != 4 || input->dims->data[3] != 3) {
+        throw std::runtime_error("Face model input must be NHWC with 3 channels");
+    }
+    impl_->input_height = input->dims->data[1];
+    impl_->input_width = input->dims->data[2];
+    impl_->input_format = tensorFormat(*input);
+
+    // Outputs are [1, 896, 16] box regressors and [1, 896, 1] logits in
+    // either order depending on the converter
+    if (interpreter->outputs().size() < 2) {
+        throw std::runtime_error("Face model must have box and score outputs");
+    }
+    const TfLiteTensor* first = interpreter->output_tensor(0);
+    const TfLiteTensor* second = interpreter->output_tensor(1);
+    const int first_width = first->dims->data[first->dims->size - 1];
+    const int second_width = second->dims->data[second->dims->size - 1];
+    if (first_width < second_width) {
+        impl_->boxes_output = 1;
+        impl_->scores_output = 0;
+    }
+    const TfLiteTensor* boxes = interpreter->output_tensor(impl_->boxes_output);
+    const TfLiteTensor* scores = interpreter->output_tensor(impl_->scores_output);
+    impl_->box_stride = std::max(first_width, second_width);
+    if (impl_->box_stride < 4 || boxes->dims->size < 2 ||
+        boxes->dims->data[boxes->dims->size - 2] != kFaceAnchors) {
+        throw std::runtime_error("Unexpected face model output shape");
+    }
+    impl_->boxes_format = tensorFormat(*boxes);
+    impl_->scores_format = tensorFormat(*scores);
+    impl_->slot_boxes.resize(impl_->pool->size());
+    impl_->slot_scores.resize(impl_->pool->size());
+    impl_->slot_cancel.assign(impl_->pool->size(), nullptr);
+    for (int slot = 0; slot < impl_->pool->size(); ++slot) {
+        impl_->pool->interpreter(slot)->SetCancellationFunction(
+            &impl_->slot_cancel[slot], checkSlotCancelled);
+    }
+
+    impl_->anchors = blazeFaceAnchors(impl_->input_width, impl_->input_height);
+
+    // BlazeFace expects RGB scaled to [-1, 1]
+    Preprocessor::Config preprocess_config;
+    preprocess_config.target_width = impl_->input_width;
+    preprocess_config.target_height = impl_->input_height;
+    preprocess_config.input_format = impl_->input_format;
+    for (int c = 0; c < 3; ++c) {
+        preprocess_config.mean[c] = 0.5f;
+        preprocess_config.std[c] = 0.5f;
+    }
+    preprocessor_ = std::make_unique<Preprocessor>(preprocess_config);
+
+    ready_ = true;
+}
+
+FaceDetector::~FaceDetector() = default;
+
+size_t FaceDetector::inputBytes() const {
+    return static_cast<size_t>(impl_->input_width) * impl_->input_height * 3 *
+           impl_->input_format.elementSize();
+}
+
+FaceDetector::Letterbox FaceDetector::prepareInput(const cv::Mat& image, void* dst) {
+    if (image.empty()) {
+        throw std::invalid_argument("Empty image");
+    }
+
+    // Fit the image inside the model input, keeping aspect ratio
+    const int width = impl_->input_width;
+    const int height = impl_->input_height;
+    const float scale = std::min(static_cast<float>(width) / image.cols,
+                                 static_cast<float>(height) / image.rows);
+    const int scaled_width = std::max(1, static_cast<int>(std::lround(image.cols * scale)));
+    const int scaled_height = std::max(1, static_cast<int>(std::lround(image.rows * scale)));
+    const int pad_x = (width - scaled_width) / 2;
+    const int pad_y = (height - scaled_height) / 2;
+
+    // Reused across calls on the same thread to avoid reallocating
+    thread_local cv::Mat canvas;
+    canvas.create(height, width, CV_8UC3);
+    canvas.setTo(cv::Scalar::all(0));
+    cv::Mat content = canvas(cv::Rect(pad_x, pad_y, scaled_width, scaled_height));
+    cv::resize(image, content, content.size(), 0, 0, cv::INTER_LINEAR);
+
+    preprocessor_->processInto(canvas, dst);
+
+    Letterbox letterbox;
+    letterbox.offset_x = static_cast<float>(pad_x) / width;
+    letterbox.offset_y = static_cast<float>(pad_y) / height;
+    letterbox.scale_x = static_cast<float>(width) / scaled_width;
+    letterbox.scale_y = static_cast<float>(height) / scaled_height;
+    return letterbox;
+}
+
+std::vector<FaceResult> FaceDetector::detect(const cv::Mat& image,
+                                             const std::atomic<bool>* cancelled) {
+    if (isCancelled(cancelled)) {
+        return {};
+    }
+    InterpreterPool::Lease lease = impl_->pool->acquire();
+    Letterbox letterbox = prepareInput(image, lease->input_tensor(0)->data.raw);
+    return run(lease.slot(), letterbox, cancelled);
+}
+
+std::vector<FaceResult> FaceDetector::detect(const uint8_t* input, const Letterbox& letterbox,
+                                             const std::atomic<bool>* cancelled) {
+    if (isCancelled(cancelled)) {
+        return {};
+    }
+    InterpreterPool::Lease lease = impl_->pool->acquire();
+    uint8_t* tensor = reinterpret_cast<uint8_t*>(lease->input_tensor(0)->data.raw);
+    std::copy(input, input + inputBytes(), tensor);
+    return run(lease.slot(), letterbox, cancelled);
+}
+
+std::vector<FaceResult> FaceDetector::run(int slot, const Letterbox& letterbox,
+                                          const std::atomic<bool>* cancelled) {
+    if (isCancelled(cancelled)) {
+        return {};
+    }
+
+    tflite::Interpreter* interpreter = impl_->pool->interpreter(slot);
+    impl_->slot_cancel[slot] = cancelled;
+    const TfLiteStatus status = interpreter->Invoke();
+    impl_->slot_cancel[slot] = nullptr;
+
+    if (isCancelled(cancelled)) {
+        return {};
+    }
+    if (status != kTfLiteOk) {
+        throw std::runtime_error("Face detection failed");
+    }
+
+    const float* boxes = floatData(*interpreter->output_tensor(impl_->boxes_output),
+                                   impl_->boxes_format,
+                                   static_cast<size_t>(kFaceAnchors) * impl_->box_stride,
+                                   impl_->slot_boxes[slot]);
+    const float* scores = floatData(*interpreter->output_tensor(impl_->scores_output),
+                                    impl_->scores_format, kFaceAnchors,
+                                    impl_->slot_scores[slot]);
+    std::vector<FaceDetection> candidates = decodeFaceCandidates(
+        boxes, impl_->box_stride, scores, impl_->anchors, impl_->input_width,
+        impl_->input_height, config_.score_threshold);
+    return mergeFaceDetections(std::move(candidates), letterbox, config_.iou_threshold,
+                               config_.max_faces);
+}
+
+}  // namespace ventus
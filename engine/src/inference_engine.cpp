@@ -1,71 +1,362 @@
 #include "inference_engine.h"
+#include "trace.h"
+#include <algorithm>
 #include <chrono>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 namespace ventus {
 
-InferenceEngine::InferenceEngine(const Config& config) : config_(config) {
+namespace {
+
+ThreadTopology::Config topologyConfig(const InferenceEngine::Config& config) {
+    ThreadTopology::Config topology;
+    topology.num_threads = config.num_threads;
+    topology.pool_size = config.pool_size;
+    topology.preprocess_threads = config.preprocess_threads;
+    topology.opencv_threads = config.opencv_threads;
+    topology.pin = config.pin_threads;
+    return topology;
+}
+
+}  // namespace
+
+InferenceEngine::InferenceEngine(const Config& config)
+    : config_(config), topology_(CpuTopology::detect(), topologyConfig(config)) {
     start_time_ = std::chrono::system_clock::now();
-    
-    // Initialize preprocessor
+    topology_.applyOpenCv();
+
+    // Anything that changes a verdict for the same bytes goes into the key;
+    // each model generation folds in its own weights
+    std::ostringstream fingerprint;
+    fingerprint << config.scene_model_path << '\n' << config.face_model_path << '\n'
+                << config.gate_model_path << '\n' << config.gate_low << ' ' << config.gate_high
+                << ' ' << config.outdoor_threshold << ' ' << config.face_threshold
+                << ' ' << config.min_outdoor_labels
+                << ' ' << delegatePolicyName(config.delegate);
+    const std::string fingerprint_text = fingerprint.str();
+    cache_secret_ = HashKey::random();
+    config_fingerprint_ = hashBytes(reinterpret_cast<const uint8_t*>(fingerprint_text.data()),
+                                    fingerprint_text.size()).lo;
+
+    // Scene classifier, preprocessor and batcher
+    generation_ = loadGeneration(config.scene_model_path, 1);
+
+    // Initialize face detector; BlazeFace is small enough that extra
+    // threads cost more than they save
+    if (!config.face_model_path.empty()) {
+        FaceDetector::Config face_config;
+        face_config.model_path = config.face_model_path;
+        face_config.num_threads = 1;
+        face_config.delegate = config.delegate;
+        face_config.pool_size = topology_.poolSize();
+        face_config.score_threshold = config.face_threshold;
+        {
+            ScopedAffinity affinity(topology_.pinned() ? topology_.inferenceCpus() : CpuSet{});
+            face_detector_ = std::make_unique<FaceDetector>(face_config);
+        }
+
+        // One worker per face interpreter; callers fall back to running
+        // face detection themselves when all are busy
+        if (config.parallel_models) {
+            RequestScheduler::Config worker_config;
+            worker_config.num_workers = face_config.pool_size;
+            worker_config.max_in_flight = face_config.pool_size;
+            if (topology_.pinned()) {
+                worker_config.worker_cpus = topology_.inferenceWorkerCpus();
+            }
+            face_workers_ = std::make_unique<RequestScheduler>(worker_config);
+        }
+    }
+
+    if (config.cache_bytes > 0) {
+        ResultCache<VerificationResult>::Config cache_config;
+        cache_config.capacity = config.cache_bytes;
+        cache_ = std::make_unique<ResultCache<VerificationResult>>(
+            cache_config, [](const VerificationResult& result) {
+                return result.faces.capacity() * sizeof(FaceResult) +
+                       result.error_message.capacity();
+            });
+    }
+}
+
+InferenceEngine::~InferenceEngine() = default;
+
+std::shared_ptr<ModelGeneration> InferenceEngine::loadGeneration(const std::string& model_path,
+                                                                 int64_t id) const {
+    auto generation = std::make_shared<ModelGeneration>();
+    generation->id = id;
+    generation->model_path = model_path;
+    generation->loaded_at = std::chrono::system_clock::now();
+
+    // Intra-op thread pools are spawned by this thread and inherit its CPUs
+    ScopedAffinity affinity(topology_.pinned() ? topology_.inferenceCpus() : CpuSet{});
+
+    SceneClassifier::Config classifier_config;
+    classifier_config.model_path = model_path;
+    classifier_config.num_threads = topology_.numThreads();
+    classifier_config.delegate = config_.delegate;
+    classifier_config.pool_size = topology_.poolSize();
+    classifier_config.max_batch_size = config_.max_batch_size;
+    classifier_config.outdoor_threshold = config_.outdoor_threshold;
+    classifier_config.gate_model_path = config_.gate_model_path;
+    classifier_config.gate_low = config_.gate_low;
+    classifier_config.gate_high = config_.gate_high;
+    generation->classifier = std::make_unique<SceneClassifier>(classifier_config);
+    generation->classifier->warmup();
+    if (config_.benchmark_delegates) {
+        generation->delegate_benchmarks = generation->classifier->benchmarkDelegates();
+    }
+
+    generation->model_hash = generation->classifier->modelHash();
+    const uint64_t seed_words[] = {config_fingerprint_, generation->model_hash.hi,
+                                   generation->model_hash.lo};
+    const ContentHash generation_key = keyedHash(reinterpret_cast<const uint8_t*>(seed_words),
+                                                 sizeof(seed_words), cache_secret_);
+    generation->cache_key = HashKey{generation_key.hi, generation_key.lo};
+
+    // Initialize preprocessor to emit the model's input type directly
     Preprocessor::Config preprocess_config;
     preprocess_config.target_width = 224;
     preprocess_config.target_height = 224;
-    preprocessor_ = std::make_unique<Preprocessor>(preprocess_config);
-    
-    // Initialize scene classifier
-    SceneClassifier::Config classifier_config;
-    classifier_config.model_path = config.scene_model_path;
-    classifier_config.num_threads = config.num_threads;
-    classifier_config.outdoor_threshold = config.outdoor_threshold;
-    scene_classifier_ = std::make_unique<SceneClassifier>(classifier_config);
+    preprocess_config.input_format = generation->classifier->inputFormat();
+    generation->preprocessor = std::make_unique<Preprocessor>(preprocess_config);
+    generation->preprocessor->calibrateDecode();
+
+    // Group concurrent requests into batched invokes
+    if (config_.max_batch_size > 1) {
+        MicroBatcher::Config batch_config;
+        batch_config.max_batch_size = config_.max_batch_size;
+        batch_config.max_wait_us = config_.max_batch_wait_us;
+        generation->batcher = std::make_unique<MicroBatcher>(*generation->classifier,
+                                                             batch_config);
+    }
+    return generation;
 }
 
-InferenceEngine::~InferenceEngine() = default;
+std::shared_ptr<ModelGeneration> InferenceEngine::currentGeneration() const {
+    return std::atomic_load(&generation_);
+}
+
+InferenceEngine::ModelInfo InferenceEngine::reloadModel(const std::string& model_path) {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    std::shared_ptr<ModelGeneration> previous = currentGeneration();
+
+    // Built and warmed while the previous generation keeps serving
+    std::shared_ptr<ModelGeneration> next = loadGeneration(
+        model_path.empty() ? previous->model_path : model_path, previous->id + 1);
+    std::atomic_store(&generation_, std::move(next));
+
+    // Requests still holding `previous` keep it alive until they finish
+    return modelInfo();
+}
+
+InferenceEngine::ModelInfo InferenceEngine::modelInfo() const {
+    std::shared_ptr<ModelGeneration> generation = currentGeneration();
+    ModelInfo info;
+    info.generation = generation->id;
+    info.model_path = generation->model_path;
+    info.model_hash = toHex(generation->model_hash);
+    info.loaded_at = generation->loaded_at;
+    info.delegate = generation->classifier->delegatePolicy();
+    info.delegate_benchmarks = generation->delegate_benchmarks;
+    return info;
+}
+
+namespace {
+
+int64_t elapsedUs(std::chrono::high_resolution_clock::time_point start,
+                  std::chrono::high_resolution_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+// Unwinds a request dropped between stages
+class RequestShed : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+}  // namespace
+
+void InferenceEngine::checkDeadline(Stage stage, const RequestDeadline& deadline) {
+    const char* reason = nullptr;
+    if (deadline.cancelled()) {
+        reason = "cancelled";
+    } else if (deadline.hasDeadline()) {
+        // Typical cost of this stage and every later one on the scene path;
+        // face detection overlaps it or is cheaper
+        int64_t remaining_us = 0;
+        for (int i = static_cast<int>(stage); i <= static_cast<int>(Stage::kPostprocess); ++i) {
+            remaining_us += stage_metrics_.typicalUs(static_cast<Stage>(i));
+        }
+        if (!deadline.canFinish(remaining_us)) {
+            reason = "deadline exceeded";
+        }
+    }
+    if (reason) {
+        stage_metrics_.recordShed(stage);
+        throw RequestShed(std::string("Shed before ") + stageName(stage) + ": " + reason);
+    }
+}
+
+template <typename SceneFn, typename FaceFn>
+ClassificationResult InferenceEngine::runModels(SceneFn scene, FaceFn face,
+                                                std::vector<FaceResult>& faces,
+                                                int64_t& face_us) {
+    if (!face_detector_) {
+        return scene();
+    }
+
+    // Cancelled once the scene result makes face detection moot. face_us
+    // is only read after the task completes.
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    std::packaged_task<std::vector<FaceResult>()> face_task(
+        [face, cancelled, &face_us, request_id = std::string(TraceScope::current())] {
+            TraceScope scope(request_id);
+            TraceSpan span("engine.face");
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<FaceResult> detected = face(cancelled.get());
+            face_us = elapsedUs(start, std::chrono::high_resolution_clock::now());
+            return detected;
+        });
+    std::future<std::vector<FaceResult>> face_result = face_task.get_future();
+
+    auto shared_task = std::make_shared<decltype(face_task)>(std::move(face_task));
+    const bool parallel = face_workers_ &&
+                          face_workers_->trySubmit([shared_task] { (*shared_task)(); });
+
+    ClassificationResult scene_result;
+    try {
+        scene_result = scene();
+    } catch (...) {
+        // The face branch may reference caller-owned inputs, so it must
+        // finish before they go out of scope
+        cancelled->store(true);
+        if (parallel) {
+            face_result.wait();
+        }
+        throw;
+    }
+
+    const bool moot = config_.early_cancel && !scenePasses(scene_result);
+    if (moot) {
+        cancelled->store(true);
+    }
+    if (!parallel) {
+        (*shared_task)();
+    }
+    faces = face_result.get();
+
+    // A parallel face model can finish before the cancel lands; its faces
+    // are dropped too, so the response does not depend on that race
+    if (moot) {
+        faces.clear();
+    }
+    return scene_result;
+}
+
+VerificationResult InferenceEngine::verify(const uint8_t* image_data, size_t size,
+                                           const RequestDeadline& deadline) {
+    TraceSpan span("engine.verify");
+    std::shared_ptr<ModelGeneration> generation = currentGeneration();
+    if (!cache_) {
+        return verifyUncached(std::move(generation), image_data, size, deadline);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool hit = false;
+    VerificationResult result = cache_->getOrCompute(
+        keyedHash(image_data, size, generation->cache_key),
+        [&] { return verifyUncached(generation, image_data, size, deadline); },
+        [](const VerificationResult& computed) { return computed.success; },
+        &hit);
+    if (!hit) {
+        return result;
+    }
+    if (result.shed) {
+        // Shared from an identical request that gave up; this one may
+        // still have time
+        return verifyUncached(std::move(generation), image_data, size, deadline);
+    }
+
+    // Report this request's own cost rather than the original computation's
+    const int64_t elapsed_us = elapsedUs(start, std::chrono::high_resolution_clock::now());
+    result.cache_hit = true;
+    result.preprocessing_time_ms = 0;
+    result.decode = DecodeInfo{};
+    result.inference_time_ms = elapsed_us / 1000;
+    result.timings = StageTimings{};
+    result.timings[Stage::kRequest] = elapsed_us;
+    recordStats(result);
+    return result;
+}
+
+VerificationResult InferenceEngine::verifyUncached(std::shared_ptr<ModelGeneration> generation,
+                                                   const uint8_t* image_data, size_t size,
+                                                   const RequestDeadline& deadline) {
+    // Batched inference copies each image into its slice of the batch tensor
+    if (generation->batcher) {
+        return infer(prepare(std::move(generation), image_data, size, deadline), deadline);
+    }
+    SceneClassifier& classifier = *generation->classifier;
+    Preprocessor& preprocessor = *generation->preprocessor;
 
-VerificationResult InferenceEngine::verify(const uint8_t* image_data, size_t size) {
     VerificationResult result;
     result.success = false;
     
     auto total_start = std::chrono::high_resolution_clock::now();
     
     try {
-        // Preprocessing
+        // Decode before checking out an interpreter so decode time
+        // doesn't hold one idle
+        checkDeadline(Stage::kDecode, deadline);
         auto preprocess_start = std::chrono::high_resolution_clock::now();
-        std::vector<float> tensor = preprocessor_->decodeAndProcess(image_data, size);
-        auto preprocess_end = std::chrono::high_resolution_clock::now();
-        
-        result.preprocessing_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            preprocess_end - preprocess_start
-        ).count();
+        cv::Mat image = preprocessor.decode(image_data, size, &result.decode);
+        auto decode_end = std::chrono::high_resolution_clock::now();
         
-        // Scene classification
-        ClassificationResult scene_result = scene_classifier_->classify(tensor);
+        // Face detection on the same decoded frame, alongside the scene
+        // model in parallel mode
+        result.timings[Stage::kDecode] = elapsedUs(preprocess_start, decode_end);
+        std::vector<FaceResult> faces;
+        ClassificationResult scene_result = runModels(
+            [&] {
+                SceneClassifier::Lease lease = classifier.checkout();
+                
+                // Preprocess straight into the interpreter's input tensor,
+                // unless waiting for the interpreter used up the budget
+                checkDeadline(Stage::kPreprocess, deadline);
+                auto process_start = std::chrono::high_resolution_clock::now();
+                void* input = classifier.inputTensor(lease);
+                preprocessor.processInto(image, input);
+                auto preprocess_end = std::chrono::high_resolution_clock::now();
+                
+                result.preprocessing_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    (decode_end - preprocess_start) + (preprocess_end - process_start)
+                ).count();
+                result.timings[Stage::kPreprocess] = elapsedUs(process_start, preprocess_end);
+                
+                // Scene classification
+                checkDeadline(Stage::kInvoke, deadline);
+                return classifier.classifyInPlace(lease);
+            },
+            [this, image](const std::atomic<bool>* cancelled) {
+                return face_detector_->detect(image, cancelled);
+            },
+            faces, result.timings[Stage::kFace]);
         
-        result.is_outdoor = scene_result.is_outdoor;
-        result.outdoor_confidence = scene_result.outdoor_score;
-        result.scene_labels = scene_result.scene_labels;
+        applyVerdict(scene_result, std::move(faces), result);
         
-        // Face detection
-        std::vector<FaceResult> faces = detectFaces(tensor);
-        result.faces = faces;
-        result.face_detected = !faces.empty();
-        result.face_confidence = faces.empty() ? 0.0f : faces[0].confidence;
-        
-        // Determine overall verification
-        int outdoor_label_count = 0;
-        for (const auto& pred : scene_result.predictions) {
-            if (pred.is_outdoor && pred.confidence >= config_.outdoor_threshold) {
-                outdoor_label_count++;
-            }
+        // Preprocessing wrote the interpreter input directly; only a gate
+        // model copies it
+        if (scene_result.gate_decision == GateDecision::kNone) {
+            result.timings[Stage::kTensorCopy] = -1;
         }
         
-        result.verification_passed = 
-            result.is_outdoor && 
-            result.face_detected &&
-            outdoor_label_count >= config_.min_outdoor_labels;
-        
-        result.success = true;
-        
+    } catch (const RequestShed& e) {
+        result.error_message = e.what();
+        result.shed = true;
     } catch (const std::exception& e) {
         result.error_message = e.what();
         result.success = false;
@@ -75,26 +366,225 @@ VerificationResult InferenceEngine::verify(const uint8_t* image_data, size_t siz
     result.inference_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         total_end - total_start
     ).count();
+    result.timings[Stage::kRequest] = elapsedUs(total_start, total_end);
     
-    // Update stats
-    total_requests_++;
-    if (result.success) {
-        successful_requests_++;
+    recordStats(result);
+    return result;
+}
+
+PreparedImage InferenceEngine::prepare(const uint8_t* image_data, size_t size,
+                                       const RequestDeadline& deadline) {
+    return prepare(currentGeneration(), image_data, size, deadline);
+}
+
+PreparedImage InferenceEngine::prepare(std::shared_ptr<ModelGeneration> generation,
+                                       const uint8_t* image_data, size_t size,
+                                       const RequestDeadline& deadline) {
+    TraceSpan span("engine.prepare");
+    PreparedImage prepared;
+    prepared.generation = std::move(generation);
+    Preprocessor& preprocessor = *prepared.generation->preprocessor;
+    
+    auto preprocess_start = std::chrono::high_resolution_clock::now();
+    
+    try {
+        checkDeadline(Stage::kDecode, deadline);
+        cv::Mat image = preprocessor.decode(image_data, size, &prepared.decode);
+        prepared.timings[Stage::kDecode] = elapsedUs(
+            preprocess_start, std::chrono::high_resolution_clock::now());
+        buildTensors(preprocessor, image, prepared, deadline);
+    } catch (const RequestShed& e) {
+        prepared.error_message = e.what();
+        prepared.shed = true;
+    } catch (const std::exception& e) {
+        prepared.error_message = e.what();
+        prepared.success = false;
+    }
+    
+    auto preprocess_end = std::chrono::high_resolution_clock::now();
+    prepared.preprocessing_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        preprocess_end - preprocess_start
+    ).count();
+    
+    return prepared;
+}
+
+ImageUpload InferenceEngine::beginUpload() const {
+    return ImageUpload(currentGeneration());
+}
+
+bool InferenceEngine::feed(ImageUpload& upload, const uint8_t* data, size_t size) const {
+    if (!upload.error.empty()) {
+        return false;
+    }
+    try {
+        upload.decoder.feed(data, size);
+    } catch (const std::exception& e) {
+        upload.error = e.what();
+        return false;
+    }
+    return true;
+}
+
+PreparedImage InferenceEngine::prepare(ImageUpload& upload, const RequestDeadline& deadline) {
+    TraceSpan span("engine.prepare_upload");
+    PreparedImage prepared;
+    prepared.generation = upload.generation;
+    Preprocessor& preprocessor = *prepared.generation->preprocessor;
+    
+    // Most of the decode ran while chunks were arriving, so count decode
+    // work rather than time since the first chunk
+    auto decode_end = std::chrono::high_resolution_clock::now();
+    
+    try {
+        if (!upload.error.empty()) {
+            throw std::runtime_error(upload.error);
+        }
+        checkDeadline(Stage::kDecode, deadline);
+        cv::Mat image = upload.decoder.finish(&prepared.decode);
+        decode_end = std::chrono::high_resolution_clock::now();
+        prepared.timings[Stage::kDecode] = prepared.decode.decode_time_us;
+        buildTensors(preprocessor, image, prepared, deadline);
+    } catch (const RequestShed& e) {
+        prepared.error_message = e.what();
+        prepared.shed = true;
+    } catch (const std::exception& e) {
+        prepared.error_message = e.what();
+        prepared.success = false;
+    }
+    
+    prepared.preprocessing_time_us = prepared.decode.decode_time_us +
+        elapsedUs(decode_end, std::chrono::high_resolution_clock::now());
+    
+    return prepared;
+}
+
+void InferenceEngine::buildTensors(Preprocessor& preprocessor, const cv::Mat& image,
+                                   PreparedImage& prepared, const RequestDeadline& deadline) {
+    checkDeadline(Stage::kPreprocess, deadline);
+    auto process_start = std::chrono::high_resolution_clock::now();
+    prepared.tensor.resize(preprocessor.tensorBytes());
+    preprocessor.processInto(image, prepared.tensor.data());
+    auto process_end = std::chrono::high_resolution_clock::now();
+    prepared.timings[Stage::kPreprocess] = elapsedUs(process_start, process_end);
+    if (face_detector_) {
+        prepared.face_tensor.resize(face_detector_->inputBytes());
+        prepared.face_letterbox = face_detector_->prepareInput(
+            image, prepared.face_tensor.data());
+        prepared.timings[Stage::kFace] = elapsedUs(
+            process_end, std::chrono::high_resolution_clock::now());
     }
-    total_latency_ms_ = total_latency_ms_.load() + result.inference_time_ms;
+    prepared.success = true;
+}
+
+VerificationResult InferenceEngine::infer(const PreparedImage& prepared,
+                                          const RequestDeadline& deadline) {
+    TraceSpan span("engine.infer");
+    VerificationResult result;
+    result.success = false;
+    result.preprocessing_time_ms = prepared.preprocessing_time_us / 1000;
+    result.decode = prepared.decode;
+    result.timings = prepared.timings;
+    
+    auto infer_start = std::chrono::high_resolution_clock::now();
     
+    try {
+        if (!prepared.success) {
+            result.shed = prepared.shed;
+            throw std::runtime_error(prepared.error_message);
+        }
+        checkDeadline(Stage::kInvoke, deadline);
+        const std::vector<uint8_t>& tensor = prepared.tensor;
+        
+        // The tensor only fits the model it was prepared for, even if a
+        // reload has happened since
+        std::shared_ptr<ModelGeneration> generation = prepared.generation
+            ? prepared.generation
+            : currentGeneration();
+        
+        // Scene classification, with face detection alongside in parallel mode
+        std::vector<FaceResult> faces;
+        int64_t face_us = -1;
+        ClassificationResult scene_result = runModels(
+            [&] {
+                if (generation->batcher) {
+                    // Includes the wait for the batch to fill
+                    TraceSpan batch_span("engine.batch");
+                    return generation->batcher->classify(tensor);
+                }
+                return generation->classifier->classify(tensor);
+            },
+            [this, &prepared](const std::atomic<bool>* cancelled) {
+                return face_detector_->detect(prepared.face_tensor.data(),
+                                              prepared.face_letterbox, cancelled);
+            },
+            faces, face_us);
+        
+        applyVerdict(scene_result, std::move(faces), result);
+        if (face_us >= 0) {
+            // Input preparation already ran in the preprocessing stage
+            result.timings[Stage::kFace] = std::max<int64_t>(0, result.timings[Stage::kFace]) +
+                                           face_us;
+        }
+        
+    } catch (const RequestShed& e) {
+        result.error_message = e.what();
+        result.shed = true;
+    } catch (const std::exception& e) {
+        result.error_message = e.what();
+        result.success = false;
+    }
+    
+    // Total time covers both stages, excluding any wait between them
+    auto infer_end = std::chrono::high_resolution_clock::now();
+    result.timings[Stage::kRequest] = prepared.preprocessing_time_us +
+                                      elapsedUs(infer_start, infer_end);
+    result.inference_time_ms = result.timings[Stage::kRequest] / 1000;
+    
+    recordStats(result);
     return result;
 }
 
-std::vector<FaceResult> InferenceEngine::detectFaces(const std::vector<float>& input) {
-    // Face detection using OpenCV's DNN or separate TFLite model
-    // Placeholder implementation - actual would use face detection model
-    std::vector<FaceResult> faces;
+void InferenceEngine::applyVerdict(const ClassificationResult& scene_result,
+                                   std::vector<FaceResult> faces,
+                                   VerificationResult& result) const {
+    result.is_outdoor = scene_result.is_outdoor;
+    result.outdoor_confidence = scene_result.outdoor_score;
+    result.scene_labels = scene_result.predictions;
+    result.gate_decision = scene_result.gate_decision;
+    result.gate_score = scene_result.gate_score;
+    result.timings[Stage::kTensorCopy] = scene_result.tensor_copy_us;
+    result.timings[Stage::kInvoke] = scene_result.invoke_us;
+    result.timings[Stage::kPostprocess] = scene_result.postprocess_us;
+    
+    result.face_detected = !faces.empty();
+    result.face_confidence = faces.empty() ? 0.0f : faces[0].confidence;
+    result.faces = std::move(faces);
     
-    // TODO: Implement face detection with BlazeFace or similar
-    // For now, return empty - will be implemented with face model
+    // Determine overall verification
+    result.verification_passed = result.face_detected && scenePasses(scene_result);
     
-    return faces;
+    result.success = true;
+}
+
+bool InferenceEngine::scenePasses(const ClassificationResult& scene_result) const {
+    int outdoor_label_count = 0;
+    for (const auto& pred : scene_result.predictions) {
+        if (pred.is_outdoor && pred.confidence >= config_.outdoor_threshold) {
+            outdoor_label_count++;
+        }
+    }
+    return scene_result.is_outdoor && outdoor_label_count >= config_.min_outdoor_labels;
+}
+
+void InferenceEngine::recordStats(const VerificationResult& result) {
+    total_requests_++;
+    if (result.success) {
+        successful_requests_++;
+    }
+    total_latency_us_.fetch_add(std::max<int64_t>(0, result.timings[Stage::kRequest]),
+                                std::memory_order_relaxed);
+    stage_metrics_.record(result.timings);
 }
 
 InferenceEngine::Stats InferenceEngine::getStats() const {
@@ -104,7 +594,7 @@ InferenceEngine::Stats InferenceEngine::getStats() const {
     stats.start_time = start_time_;
     
     if (stats.total_requests > 0) {
-        stats.avg_latency_ms = total_latency_ms_.load() / stats.total_requests;
+        stats.avg_latency_ms = total_latency_us_.load() / 1000.0 / stats.total_requests;
     } else {
         stats.avg_latency_ms = 0.0;
     }
@@ -112,8 +602,21 @@ InferenceEngine::Stats InferenceEngine::getStats() const {
     return stats;
 }
 
+ResultCache<VerificationResult>::Stats InferenceEngine::getCacheStats() const {
+    if (!cache_) {
+        return ResultCache<VerificationResult>::Stats{};
+    }
+    return cache_->getStats();
+}
+
+std::vector<size_t> InferenceEngine::interpreterArenaBytes() const {
+    return currentGeneration()->classifier->interpreterArenaBytes();
+}
+
 bool InferenceEngine::isReady() const {
-    return scene_classifier_ && scene_classifier_->isReady();
+    std::shared_ptr<ModelGeneration> generation = currentGeneration();
+    return generation && generation->classifier->isReady() &&
+           (!face_detector_ || face_detector_->isReady());
 }
 
 }  // namespace ventus
@@ -0,0 +1,226 @@
+#include "interpreter_pool.h"
+#include <tensorflow/lite/kernels/builtin_op_kernels.h>
+#include <tensorflow/lite/kernels/register.h>
+#include <tensorflow/lite/schema/schema_generated.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace ventus {
+
+namespace {
+
+// Bytes the arena planner actually reserved, which reuses memory between
+// tensors whose lifetimes do not overlap, so is not their summed size
+size_t measureArena(tflite::Interpreter& interpreter) {
+    tflite::SubgraphAllocInfo info{};
+    interpreter.primary_subgraph().GetMemoryAllocInfo(&info);
+    return info.arena_size + info.arena_persist_size;
+}
+
+// Ops used by the MobileNetV3 scene models, BlazeFace and the synthetic
+// test models, at every version their kernels implement
+std::unique_ptr<tflite::MutableOpResolver> minimalResolver() {
+    using namespace tflite::ops::builtin;
+    auto resolver = std::make_unique<tflite::MutableOpResolver>();
+    resolver->AddBuiltin(tflite::BuiltinOperator_CONV_2D, Register_CONV_2D(), 1, 8);
+    resolver->AddBuiltin(tflite::BuiltinOperator_DEPTHWISE_CONV_2D,
+                         Register_DEPTHWISE_CONV_2D(), 1, 7);
+    resolver->AddBuiltin(tflite::BuiltinOperator_FULLY_CONNECTED,
+                         Register_FULLY_CONNECTED(), 1, 12);
+    resolver->AddBuiltin(tflite::BuiltinOperator_ADD, Register_ADD(), 1, 5);
+    resolver->AddBuiltin(tflite::BuiltinOperator_MUL, Register_MUL(), 1, 7);
+    resolver->AddBuiltin(tflite::BuiltinOperator_HARD_SWISH, Register_HARD_SWISH(), 1, 1);
+    resolver->AddBuiltin(tflite::BuiltinOperator_RELU, Register_RELU(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_RELU6, Register_RELU6(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_LOGISTIC, Register_LOGISTIC(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_AVERAGE_POOL_2D,
+                         Register_AVERAGE_POOL_2D(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_MAX_POOL_2D, Register_MAX_POOL_2D(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_MEAN, Register_MEAN(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_PAD, Register_PAD(), 1, 4);
+    resolver->AddBuiltin(tflite::BuiltinOperator_RESHAPE, Register_RESHAPE(), 1, 1);
+    resolver->AddBuiltin(tflite::BuiltinOperator_CONCATENATION,
+                         Register_CONCATENATION(), 1, 4);
+    resolver->AddBuiltin(tflite::BuiltinOperator_SOFTMAX, Register_SOFTMAX(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_QUANTIZE, Register_QUANTIZE(), 1, 3);
+    resolver->AddBuiltin(tflite::BuiltinOperator_DEQUANTIZE, Register_DEQUANTIZE(), 1, 5);
+    return resolver;
+}
+
+}  // namespace
+
+InterpreterPool::InterpreterPool(const Config& config) : config_(config) {
+    file_ = std::make_unique<MappedFile>(config_.model_path);
+    model_hash_ = hashBytes(reinterpret_cast<const uint8_t*>(file_->data()), file_->size());
+
+    // Verified because reloads may pick up a half-written or foreign file
+    model_ = tflite::FlatBufferModel::VerifyAndBuildFromBuffer(file_->data(), file_->size());
+    if (!model_) {
+        throw std::runtime_error("Failed to load model: " + config_.model_path);
+    }
+
+    // Delegation is explicit, so the builtin resolver must not add
+    // XNNPACK on its own
+    if (config_.delegate == DelegatePolicy::kMinimal) {
+        resolver_ = minimalResolver();
+    } else {
+        resolver_ = std::make_unique<
+            tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates>();
+    }
+    if (config_.delegate == DelegatePolicy::kXnnpack) {
+        weights_cache_.reset(TfLiteXNNPackDelegateWeightsCacheCreate());
+        if (!weights_cache_) {
+            throw std::runtime_error("Failed to create XNNPACK weights cache");
+        }
+    }
+
+    const int pool_size = std::max(1, config_.pool_size);
+    interpreters_.reserve(pool_size);
+    arena_bytes_ = std::vector<std::atomic<size_t>>(pool_size);
+    free_slots_.reserve(pool_size);
+
+    for (int slot = 0; slot < pool_size; ++slot) {
+        std::unique_ptr<tflite::Interpreter> interpreter;
+        tflite::InterpreterBuilder builder(*model_, *resolver_);
+        if (weights_cache_) {
+            // One delegate per interpreter, all packing weights into the
+            // shared cache so the pool holds a single packed copy
+            TfLiteXNNPackDelegateOptions options = TfLiteXNNPackDelegateOptionsDefault();
+            options.num_threads = config_.num_threads;
+            options.weights_cache = weights_cache_.get();
+            delegates_.emplace_back(TfLiteXNNPackDelegateCreate(&options),
+                                    TfLiteXNNPackDelegateDelete);
+            if (!delegates_.back()) {
+                throw std::runtime_error("Failed to create XNNPACK delegate");
+            }
+            builder.AddDelegate(delegates_.back().get());
+        }
+        builder(&interpreter);
+
+        if (!interpreter) {
+            throw std::runtime_error(
+                config_.delegate == DelegatePolicy::kMinimal
+                    ? "Failed to create interpreter; the model may use ops outside the "
+                      "minimal resolver"
+                    : "Failed to create interpreter");
+        }
+
+        interpreter->SetNumThreads(config_.num_threads);
+
+        if (interpreter->AllocateTensors() != kTfLiteOk) {
+            throw std::runtime_error("Failed to allocate tensors");
+        }
+
+        arena_bytes_[slot] = measureArena(*interpreter);
+        interpreters_.push_back(std::move(interpreter));
+        free_slots_.push_back(slot);
+    }
+
+    // Soft rather than hard, so batch resizes can still pack new weights
+    if (weights_cache_ && !TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(weights_cache_.get())) {
+        throw std::runtime_error("Failed to finalize XNNPACK weights cache");
+    }
+}
+
+DelegateBenchmark InterpreterPool::benchmark(const Config& config, int runs) {
+    DelegateBenchmark result;
+    result.policy = config.delegate;
+    try {
+        Config single = config;
+        single.pool_size = 1;
+        InterpreterPool pool(single);
+        tflite::Interpreter* interpreter = pool.interpreter(0);
+        TfLiteTensor* input = interpreter->input_tensor(0);
+        std::fill(input->data.raw, input->data.raw + input->bytes, 0);
+
+        // The first invoke pays for lazy kernel setup
+        if (interpreter->Invoke() != kTfLiteOk) {
+            throw std::runtime_error("Inference failed");
+        }
+        runs = std::max(1, runs);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; ++i) {
+            if (interpreter->Invoke() != kTfLiteOk) {
+                throw std::runtime_error("Inference failed");
+            }
+        }
+        result.invoke_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() / runs;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
+
+InterpreterPool::~InterpreterPool() = default;
+
+int InterpreterPool::acquireSlot() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [this] { return !free_slots_.empty(); });
+
+    int slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+}
+
+void InterpreterPool::measureArenaBytes(int slot) {
+    arena_bytes_[slot] = measureArena(*interpreters_[slot]);
+}
+
+void InterpreterPool::releaseSlot(int slot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_slots_.push_back(slot);
+    }
+    available_.notify_one();
+}
+
+tflite::Interpreter* InterpreterLease::get() const {
+    return pool_->interpreter(slot_);
+}
+
+void InterpreterLease::reset() {
+    if (pool_) {
+        pool_->releaseSlot(slot_);
+        pool_ = nullptr;
+        slot_ = -1;
+    }
+}
+
+TensorFormat tensorFormat(const TfLiteTensor& tensor) {
+    TensorFormat format;
+    switch (tensor.type) {
+        case kTfLiteFloat32:
+            return format;
+        case kTfLiteUInt8:
+            format.type = TensorType::kUInt8;
+            break;
+        case kTfLiteInt8:
+            format.type = TensorType::kInt8;
+            break;
+        default:
+            throw std::runtime_error(
+                "Unsupported tensor type for " + std::string(tensor.name ? tensor.name : "tensor"));
+    }
+    format.scale = tensor.params.scale;
+    format.zero_point = tensor.params.zero_point;
+    return format;
+}
+
+const float* floatData(const TfLiteTensor& tensor, const TensorFormat& format,
+                       size_t count, std::vector<float>& buffer) {
+    if (!format.isQuantized()) {
+        return tensor.data.f;
+    }
+    buffer.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const int q = format.type == TensorType::kInt8
+            ? static_cast<int>(tensor.data.int8[i])
+            : static_cast<int>(tensor.data.uint8[i]);
+        buffer[i] = format.scale * static_cast<float>(q - format.zero_point);
+    }
+    return buffer.data();
+}
+
+}  // namespace ventus
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
+#include <tensorflow/lite/interpreter.h>
+#include <tensorflow/lite/model.h>
+#include <tensorflow/lite/mutable_op_resolver.h>
+
+#include "delegate_policy.h"
+#include "interpreter_lease.h"
+#include "mapped_file.h"
+#include "result_cache.h"
+#include "tensor_format.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ventus {
+
+/**
+ * Fixed-size pool of TFLite interpreters built from one shared
+ * FlatBufferModel, which reads its weights straight from a memory-mapped
+ * model file. An interpreter must only be used by one thread at a time,
+ * so callers check a slot out for the duration of an inference.
+ */
+class InterpreterPool {
+public:
+    struct Config {
+        std::string model_path;
+        int pool_size = 1;
+        int num_threads = 1;
+        DelegatePolicy delegate = DelegatePolicy::kXnnpack;
+    };
+
+    using Lease = InterpreterLease;
+
+    explicit InterpreterPool(const Config& config);
+    ~InterpreterPool();
+
+    InterpreterPool(const InterpreterPool&) = delete;
+    InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+    /**
+     * Check out an interpreter, blocking until one is free.
+     */
+    Lease acquire() { return Lease(this, acquireSlot()); }
+
+    tflite::Interpreter* interpreter(int slot) const { return interpreters_[slot].get(); }
+
+    /**
+     * Shared model backing every interpreter in the pool.
+     */
+    const tflite::FlatBufferModel& model() const { return *model_; }
+
+    /**
+     * Content hash of the model file.
+     */
+    const ContentHash& modelHash() const { return model_hash_; }
+
+    int size() const { return static_cast<int>(interpreters_.size()); }
+
+    /**
+     * Bytes of tensor arena allocated by the interpreter in a slot, as of
+     * its last measureArenaBytes(). Safe to read while the slot is leased.
+     */
+    size_t arenaBytes(int slot) const { return arena_bytes_[slot]; }
+
+    /**
+     * Re-measure a slot's arena after its tensors were reallocated, e.g.
+     * for a new batch size. Only the slot's current holder may call it.
+     */
+    void measureArenaBytes(int slot);
+
+    DelegatePolicy delegatePolicy() const { return config_.delegate; }
+
+    /**
+     * Build a single interpreter under `config.delegate` and time
+     * Invoke() on a blank input after one warmup run.
+     * @param runs Timed invocations to average
+     */
+    static DelegateBenchmark benchmark(const Config& config, int runs);
+
+private:
+    friend class InterpreterLease;
+
+    using DelegatePtr = std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)>;
+    using WeightsCachePtr = std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                                            void (*)(TfLiteXNNPackDelegateWeightsCache*)>;
+
+    // Declared in dependency order: interpreters are destroyed before the
+    // delegates they run on, which go before the weights they share
+    Config config_;
+    std::unique_ptr<MappedFile> file_;  // Backs model_; declared first so it outlives it
+    ContentHash model_hash_;
+    std::unique_ptr<tflite::FlatBufferModel> model_;
+    std::unique_ptr<tflite::MutableOpResolver> resolver_;
+    WeightsCachePtr weights_cache_{nullptr, TfLiteXNNPackDelegateWeightsCacheDelete};
+    std::vector<DelegatePtr> delegates_;
+    std::vector<std::unique_ptr<tflite::Interpreter>> interpreters_;
+    std::vector<std::atomic<size_t>> arena_bytes_;
+
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<int> free_slots_;
+
+    int acquireSlot();
+    void releaseSlot(int slot);
+};
+
+/**
+ * Element type and quantization of a model tensor.
+ * @throws std::runtime_error for types other than float32, uint8 and int8
+ */
+TensorFormat tensorFormat(const TfLiteTensor& tensor);
+
+/**
+ * Tensor contents as floats: the tensor's own data for float tensors,
+ * otherwise its first `count` values dequantized into `buffer`.
+ */
+const float* floatData(const TfLiteTensor& tensor, const TensorFormat& format,
+                       size_t count, std::vector<float>& buffer);
+
+}  // namespace ventus
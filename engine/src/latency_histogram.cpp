@@ -0,0 +1,175 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ventus {
+
+namespace {
+
+constexpr int64_t kHalf = LatencyHistogram::kSubBuckets / 2;
+
+int floorLog2(uint64_t value) {
+    int log = 0;
+    while (value >>= 1) {
+        ++log;
+    }
+    return log;
+}
+
+// Small per-thread index, so the first kShards threads never share a shard
+size_t threadShardIndex() {
+    static std::atomic<size_t> next_thread{0};
+    thread_local const size_t index = next_thread.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+void storeMin(std::atomic<int64_t>& target, int64_t value) {
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value < current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void storeMax(std::atomic<int64_t>& target, int64_t value) {
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram(int64_t max_value) : max_value_(max_value) {
+    if (max_value < kSubBuckets) {
+        throw std::invalid_argument("Histogram range is smaller than one bucket row");
+    }
+    counts_.assign(bucketIndex(max_value) + 1, 0);
+}
+
+// Values below kSubBuckets get a bucket each. Above that, the bucket row
+// for [2^k, 2^(k+1)) holds kHalf buckets of width 2^(k - kSubBucketBits + 1).
+size_t LatencyHistogram::bucketIndex(int64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    const int shift = floorLog2(static_cast<uint64_t>(value)) - kSubBucketBits + 1;
+    return static_cast<size_t>(kSubBuckets + (shift - 1) * kHalf + ((value >> shift) - kHalf));
+}
+
+int64_t LatencyHistogram::bucketHighest(size_t index) {
+    const int64_t i = static_cast<int64_t>(index);
+    if (i < kSubBuckets) {
+        return i;
+    }
+    const int shift = static_cast<int>((i - kSubBuckets) / kHalf) + 1;
+    const int64_t sub = (i - kSubBuckets) % kHalf + kHalf;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t value, int64_t count) {
+    value = std::min(std::max<int64_t>(value, 0), max_value_);
+    counts_[bucketIndex(value)] += count;
+    total_count_ += count;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    sum_ += static_cast<double>(value) * count;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.max_value_ != max_value_) {
+        throw std::invalid_argument("Cannot merge histograms with different ranges");
+    }
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    total_count_ += other.total_count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_count_ = 0;
+    min_ = INT64_MAX;
+    max_ = 0;
+    sum_ = 0.0;
+}
+
+int64_t LatencyHistogram::min() const {
+    return total_count_ > 0 ? min_ : 0;
+}
+
+double LatencyHistogram::mean() const {
+    return total_count_ > 0 ? sum_ / total_count_ : 0.0;
+}
+
+int64_t LatencyHistogram::percentile(double percentile) const {
+    if (total_count_ == 0) {
+        return 0;
+    }
+    const double clamped = std::min(100.0, std::max(0.0, percentile));
+    // Rounded rather than ceiled, so 99.9% of 1000 is 999 despite
+    // floating-point error
+    const int64_t target = std::max<int64_t>(
+        1, std::llround(clamped / 100.0 * total_count_));
+
+    int64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            // Report the bucket's upper edge, but never beyond what was seen
+            return std::min(bucketHighest(i), max_);
+        }
+    }
+    return max_;
+}
+
+int64_t LatencyHistogram::countAtOrBelow(int64_t value) const {
+    const size_t last = std::min(bucketIndex(std::min(std::max<int64_t>(value, 0), max_value_)),
+                                 counts_.size() - 1);
+    int64_t total = 0;
+    for (size_t i = 0; i <= last; ++i) {
+        total += counts_[i];
+    }
+    return total;
+}
+
+ShardedHistogram::ShardedHistogram(int64_t max_value, int num_shards)
+    : max_value_(max_value),
+      num_buckets_(LatencyHistogram(max_value).counts_.size()),
+      shards_(std::max(1, num_shards)) {
+    for (Shard& shard : shards_) {
+        shard.counts = std::make_unique<std::atomic<int64_t>[]>(num_buckets_);
+        for (size_t i = 0; i < num_buckets_; ++i) {
+            shard.counts[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ShardedHistogram::record(int64_t value) {
+    value = std::min(std::max<int64_t>(value, 0), max_value_);
+    Shard& shard = shards_[threadShardIndex() % shards_.size()];
+    shard.counts[LatencyHistogram::bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    storeMin(shard.min, value);
+    storeMax(shard.max, value);
+}
+
+LatencyHistogram ShardedHistogram::snapshot() const {
+    LatencyHistogram merged(max_value_);
+    for (const Shard& shard : shards_) {
+        for (size_t i = 0; i < num_buckets_; ++i) {
+            const int64_t count = shard.counts[i].load(std::memory_order_relaxed);
+            merged.counts_[i] += count;
+            merged.total_count_ += count;
+        }
+        merged.sum_ += static_cast<double>(shard.sum.load(std::memory_order_relaxed));
+        merged.min_ = std::min(merged.min_, shard.min.load(std::memory_order_relaxed));
+        merged.max_ = std::max(merged.max_, shard.max.load(std::memory_order_relaxed));
+    }
+    return merged;
+}
+
+}  // namespace ventus
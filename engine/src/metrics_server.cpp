@@ -0,0 +1,123 @@
+#include "metrics_server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace ventus {
+
+namespace {
+
+// How often the accept loop checks for shutdown
+constexpr int kPollIntervalMs = 200;
+
+void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string httpResponse(const char* status, const std::string& content_type,
+                         const std::string& body) {
+    return std::string("HTTP/1.1 ") + status + "\r\n" +
+           "Content-Type: " + content_type + "\r\n" +
+           "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+           "Connection: close\r\n\r\n" + body;
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(const Config& config, std::function<std::string()> render)
+    : render_(std::move(render)) {
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("Failed to create metrics socket");
+    }
+    const int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(config.port));
+    if (::inet_pton(AF_INET, config.bind_address.c_str(), &address.sin_addr) != 1 ||
+        ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd_, 16) != 0) {
+        ::close(listen_fd_);
+        throw std::runtime_error("Failed to bind metrics endpoint to " + config.bind_address +
+                                 ":" + std::to_string(config.port));
+    }
+
+    socklen_t length = sizeof(address);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    thread_ = std::thread([this] { serve(); });
+}
+
+MetricsServer::~MetricsServer() {
+    stopping_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    ::close(listen_fd_);
+}
+
+void MetricsServer::serve() {
+    pollfd listener{listen_fd_, POLLIN, 0};
+    while (!stopping_) {
+        if (::poll(&listener, 1, kPollIntervalMs) <= 0) {
+            continue;
+        }
+        const int client_fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+        handle(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsServer::handle(int client_fd) {
+    // A stalled client must not hold up the next scrape for long
+    timeval timeout{1, 0};
+    ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters; headers and body are ignored
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+        const ssize_t n = ::recv(client_fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    const std::string line = request.substr(0, request.find("\r\n"));
+    if (line.rfind("GET /metrics ", 0) == 0 || line.rfind("GET /metrics?", 0) == 0) {
+        std::string body;
+        try {
+            body = render_();
+        } catch (const std::exception& e) {
+            sendAll(client_fd, httpResponse("500 Internal Server Error", "text/plain",
+                                            std::string(e.what()) + "\n"));
+            return;
+        }
+        sendAll(client_fd, httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8",
+                                        body));
+    } else {
+        sendAll(client_fd, httpResponse("404 Not Found", "text/plain", "Not found\n"));
+    }
+}
+
+}  // namespace ventus
@@ -0,0 +1,114 @@
+#include "micro_batcher.h"
+#include <exception>
+#include <stdexcept>
+
+namespace ventus {
+
+struct MicroBatcher::Batch {
+    std::vector<const uint8_t*> inputs;
+    std::vector<ClassificationResult> results;
+    std::exception_ptr error;
+    bool closed = false;
+    bool done = false;
+    std::condition_variable cv;
+};
+
+MicroBatcher::MicroBatcher(SceneClassifier& classifier, const Config& config)
+    : classifier_(classifier), config_(config) {
+    if (config_.max_batch_size < 1) {
+        throw std::invalid_argument("max_batch_size must be at least 1");
+    }
+}
+
+MicroBatcher::~MicroBatcher() = default;
+
+ClassificationResult MicroBatcher::classify(const std::vector<float>& input) {
+    if (config_.max_batch_size == 1) {
+        return classifier_.classify(input);
+    }
+    if (classifier_.inputFormat().isQuantized()) {
+        throw std::invalid_argument("Model input is quantized; pass input bytes");
+    }
+    if (input.size() != classifier_.inputSize()) {
+        throw std::invalid_argument("Input tensor size does not match model input");
+    }
+    return enqueue(reinterpret_cast<const uint8_t*>(input.data()));
+}
+
+ClassificationResult MicroBatcher::classify(const std::vector<uint8_t>& input) {
+    if (config_.max_batch_size == 1) {
+        return classifier_.classify(input);
+    }
+    if (input.size() != classifier_.inputBytes()) {
+        throw std::invalid_argument("Input tensor size does not match model input");
+    }
+    return enqueue(input.data());
+}
+
+ClassificationResult MicroBatcher::enqueue(const uint8_t* input) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Join the open batch, or open a new one and lead it
+    bool leader = false;
+    if (!open_batch_) {
+        open_batch_ = std::make_shared<Batch>();
+        open_batch_->inputs.reserve(config_.max_batch_size);
+        leader = true;
+    }
+    std::shared_ptr<Batch> batch = open_batch_;
+    size_t index = batch->inputs.size();
+    batch->inputs.push_back(input);
+
+    if (static_cast<int>(batch->inputs.size()) >= config_.max_batch_size) {
+        batch->closed = true;
+        open_batch_.reset();
+        batch->cv.notify_all();
+    }
+
+    if (leader) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(config_.max_wait_us);
+        batch->cv.wait_until(lock, deadline, [&batch] { return batch->closed; });
+
+        if (!batch->closed) {
+            batch->closed = true;
+            open_batch_.reset();
+        }
+        batches_++;
+        images_ += static_cast<int64_t>(batch->inputs.size());
+
+        lock.unlock();
+        run(*batch);
+        lock.lock();
+
+        batch->done = true;
+        batch->cv.notify_all();
+    } else {
+        batch->cv.wait(lock, [&batch] { return batch->done; });
+    }
+
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+    return std::move(batch->results[index]);
+}
+
+void MicroBatcher::run(Batch& batch) {
+    try {
+        SceneClassifier::Lease lease = classifier_.checkout();
+        batch.results = classifier_.classifyBatch(
+            batch.inputs.data(), static_cast<int>(batch.inputs.size()), lease);
+    } catch (...) {
+        batch.error = std::current_exception();
+    }
+}
+
+MicroBatcher::Stats MicroBatcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.batches = batches_;
+    stats.images = images_;
+    return stats;
+}
+
+}  // namespace ventus
@@ -0,0 +1,268 @@
+#include "preprocess_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define VENTUS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace ventus {
+namespace kernels {
+
+namespace {
+
+// Interleaved source byte that feeds output element k (BGR -> RGB swap).
+constexpr int sourceIndex(int k) {
+    return 3 * (k / 3) + 2 - (k % 3);
+}
+
+}  // namespace
+
+void bgrToRgbFloatScalar(const uint8_t* src, float* dst, size_t pixels,
+                         const NormalizeParams& params) {
+    for (size_t p = 0; p < pixels; ++p) {
+        const uint8_t* in = src + 3 * p;
+        float* out = dst + 3 * p;
+        out[0] = in[2] * params.scale[0] + params.bias[0];
+        out[1] = in[1] * params.scale[1] + params.bias[1];
+        out[2] = in[0] * params.scale[2] + params.bias[2];
+    }
+}
+
+#ifdef VENTUS_X86_KERNELS
+
+namespace {
+
+// Shuffle mask gathering `count` outputs starting at k0 from a 16-byte load
+// at source offset `load`; unused lanes are zeroed.
+void buildMask(int8_t* mask, int k0, int load, int count) {
+    for (int t = 0; t < 16; ++t) {
+        mask[t] = t < count ? static_cast<int8_t>(sourceIndex(k0 + t) - load)
+                            : static_cast<int8_t>(-128);
+    }
+}
+
+// Per-lane scale/bias for `lanes` outputs starting at k0.
+void buildCoefficients(float* scale, float* bias, int k0, int lanes,
+                       const NormalizeParams& params) {
+    for (int t = 0; t < lanes; ++t) {
+        scale[t] = params.scale[(k0 + t) % 3];
+        bias[t] = params.bias[(k0 + t) % 3];
+    }
+}
+
+// Pixel-aligned source offset for the group of outputs starting at k0.
+constexpr int loadOffset(int k0) {
+    return 3 * (k0 / 3);
+}
+
+__attribute__((target("sse4.1")))
+void bgrToRgbFloatSse41(const uint8_t* src, float* dst, size_t pixels,
+                        const NormalizeParams& params) {
+    // 4 pixels (12 outputs) per iteration as three 4-lane chunks of one load
+    constexpr size_t kStep = 4;
+    constexpr size_t kPixelsRead = 6;  // 16-byte load
+
+    __m128i shuffle[3];
+    __m128 scale[3];
+    __m128 bias[3];
+    for (int j = 0; j < 3; ++j) {
+        alignas(16) int8_t mask[16];
+        alignas(16) float s[4];
+        alignas(16) float b[4];
+        buildMask(mask, 4 * j, 0, 4);
+        buildCoefficients(s, b, 4 * j, 4, params);
+        shuffle[j] = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+        scale[j] = _mm_load_ps(s);
+        bias[j] = _mm_load_ps(b);
+    }
+
+    size_t p = 0;
+    for (; p + kPixelsRead <= pixels; p += kStep) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * p));
+        float* out = dst + 3 * p;
+        for (int j = 0; j < 3; ++j) {
+            __m128i ints = _mm_cvtepu8_epi32(_mm_shuffle_epi8(bytes, shuffle[j]));
+            __m128 values = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(ints), scale[j]), bias[j]);
+            _mm_storeu_ps(out + 4 * j, values);
+        }
+    }
+
+    bgrToRgbFloatScalar(src + 3 * p, dst + 3 * p, pixels - p, params);
+}
+
+__attribute__((target("avx2,fma")))
+void bgrToRgbFloatAvx2(const uint8_t* src, float* dst, size_t pixels,
+                       const NormalizeParams& params) {
+    // 8 pixels (24 outputs) per iteration as three 8-lane chunks
+    constexpr size_t kStep = 8;
+    constexpr size_t kPixelsRead = 11;  // Last load ends at byte 31
+
+    int offset[3];
+    __m128i shuffle[3];
+    __m256 scale[3];
+    __m256 bias[3];
+    for (int j = 0; j < 3; ++j) {
+        alignas(16) int8_t mask[16];
+        alignas(32) float s[8];
+        alignas(32) float b[8];
+        offset[j] = loadOffset(8 * j);
+        buildMask(mask, 8 * j, offset[j], 8);
+        buildCoefficients(s, b, 8 * j, 8, params);
+        shuffle[j] = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+        scale[j] = _mm256_load_ps(s);
+        bias[j] = _mm256_load_ps(b);
+    }
+
+    size_t p = 0;
+    for (; p + kPixelsRead <= pixels; p += kStep) {
+        const uint8_t* in = src + 3 * p;
+        float* out = dst + 3 * p;
+        for (int j = 0; j < 3; ++j) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + offset[j]));
+            __m256i ints = _mm256_cvtepu8_epi32(_mm_shuffle_epi8(bytes, shuffle[j]));
+            __m256 values = _mm256_fmadd_ps(_mm256_cvtepi32_ps(ints), scale[j], bias[j]);
+            _mm256_storeu_ps(out + 8 * j, values);
+        }
+    }
+
+    bgrToRgbFloatScalar(src + 3 * p, dst + 3 * p, pixels - p, params);
+}
+
+__attribute__((target("avx512f")))
+void bgrToRgbFloatAvx512(const uint8_t* src, float* dst, size_t pixels,
+                         const NormalizeParams& params) {
+    // 16 pixels (48 outputs) per iteration as three 16-lane chunks, each
+    // assembled from two 8-byte shuffles since its source spans 18 bytes
+    constexpr size_t kStep = 16;
+    constexpr size_t kPixelsRead = 19;  // Last load ends at byte 55
+
+    int offset[6];
+    __m128i shuffle[6];
+    __m512 scale[3];
+    __m512 bias[3];
+    for (int h = 0; h < 6; ++h) {
+        alignas(16) int8_t mask[16];
+        offset[h] = loadOffset(8 * h);
+        buildMask(mask, 8 * h, offset[h], 8);
+        shuffle[h] = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+    }
+    for (int j = 0; j < 3; ++j) {
+        alignas(64) float s[16];
+        alignas(64) float b[16];
+        buildCoefficients(s, b, 16 * j, 16, params);
+        scale[j] = _mm512_load_ps(s);
+        bias[j] = _mm512_load_ps(b);
+    }
+
+    size_t p = 0;
+    for (; p + kPixelsRead <= pixels; p += kStep) {
+        const uint8_t* in = src + 3 * p;
+        float* out = dst + 3 * p;
+        for (int j = 0; j < 3; ++j) {
+            __m128i lo = _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + offset[2 * j])),
+                shuffle[2 * j]);
+            __m128i hi = _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + offset[2 * j + 1])),
+                shuffle[2 * j + 1]);
+            __m512i ints = _mm512_cvtepu8_epi32(_mm_unpacklo_epi64(lo, hi));
+            __m512 values = _mm512_fmadd_ps(_mm512_cvtepi32_ps(ints), scale[j], bias[j]);
+            _mm512_storeu_ps(out + 16 * j, values);
+        }
+    }
+
+    bgrToRgbFloatScalar(src + 3 * p, dst + 3 * p, pixels - p, params);
+}
+
+}  // namespace
+
+#endif  // VENTUS_X86_KERNELS
+
+bool isaSupported(Isa isa) {
+    switch (isa) {
+        case Isa::kScalar:
+            return true;
+#ifdef VENTUS_X86_KERNELS
+        case Isa::kSse41:
+            return __builtin_cpu_supports("sse4.1");
+        case Isa::kAvx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case Isa::kAvx512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+Isa detectIsa() {
+    for (Isa isa : {Isa::kAvx512, Isa::kAvx2, Isa::kSse41}) {
+        if (isaSupported(isa)) {
+            return isa;
+        }
+    }
+    return Isa::kScalar;
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::kSse41: return "sse4.1";
+        case Isa::kAvx2: return "avx2";
+        case Isa::kAvx512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+BgrToRgbFloatFn bgrToRgbFloatFor(Isa isa) {
+    if (!isaSupported(isa)) {
+        return nullptr;
+    }
+    switch (isa) {
+#ifdef VENTUS_X86_KERNELS
+        case Isa::kSse41: return bgrToRgbFloatSse41;
+        case Isa::kAvx2: return bgrToRgbFloatAvx2;
+        case Isa::kAvx512: return bgrToRgbFloatAvx512;
+#endif
+        case Isa::kScalar: return bgrToRgbFloatScalar;
+        default: return nullptr;
+    }
+}
+
+void bgrToRgbFloat(const uint8_t* src, float* dst, size_t pixels,
+                   const NormalizeParams& params) {
+    static const BgrToRgbFloatFn kernel = bgrToRgbFloatFor(detectIsa());
+    kernel(src, dst, pixels, params);
+}
+
+QuantizeTable buildQuantizeTable(const NormalizeParams& params, float scale,
+                                 int zero_point, bool is_signed) {
+    const int lo = is_signed ? -128 : 0;
+    const int hi = is_signed ? 127 : 255;
+
+    QuantizeTable table;
+    for (int c = 0; c < 3; ++c) {
+        for (int v = 0; v < 256; ++v) {
+            const float normalized = v * params.scale[c] + params.bias[c];
+            const int q = static_cast<int>(std::lround(normalized / scale)) + zero_point;
+            table.lut[c][v] = static_cast<uint8_t>(std::clamp(q, lo, hi));
+        }
+    }
+    return table;
+}
+
+void bgrToRgbQuantized(const uint8_t* src, uint8_t* dst, size_t pixels,
+                       const QuantizeTable& table) {
+    for (size_t p = 0; p < pixels; ++p) {
+        const uint8_t* in = src + 3 * p;
+        uint8_t* out = dst + 3 * p;
+        out[0] = table.lut[0][in[2]];
+        out[1] = table.lut[1][in[1]];
+        out[2] = table.lut[2][in[0]];
+    }
+}
+
+}  // namespace kernels
+}  // namespace ventus
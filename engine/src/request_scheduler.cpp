@@ -0,0 +1,164 @@
+#include "request_scheduler.h"
+#include <algorithm>
+
+namespace ventus {
+
+namespace {
+
+// Heap order: the earliest deadline, then the oldest task, on top
+struct RunsLater {
+    template <typename Entry>
+    bool operator()(const Entry& a, const Entry& b) const {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+    }
+};
+
+}  // namespace
+
+RequestScheduler::RequestScheduler(const Config& config) : config_(config) {
+    const int num_workers = std::max(1, config_.num_workers);
+    workers_.reserve(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        workers_.emplace_back(&RequestScheduler::workerLoop, this, i);
+    }
+}
+
+RequestScheduler::~RequestScheduler() {
+    shutdown();
+}
+
+bool RequestScheduler::trySubmit(std::function<void()> task, Clock::time_point deadline) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || in_flight_ >= config_.max_in_flight) {
+            rejected_++;
+            return false;
+        }
+        in_flight_++;
+        push(std::move(task), deadline);
+    }
+    admitted_++;
+    work_available_.notify_one();
+    return true;
+}
+
+bool RequestScheduler::submit(std::function<void()> task, Clock::time_point deadline) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        capacity_available_.wait(lock, [this] {
+            return stopping_ || in_flight_ < config_.max_in_flight;
+        });
+        if (stopping_) {
+            return false;
+        }
+        in_flight_++;
+        push(std::move(task), deadline);
+    }
+    admitted_++;
+    work_available_.notify_one();
+    return true;
+}
+
+bool RequestScheduler::tryReserve() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || in_flight_ >= config_.max_in_flight) {
+        rejected_++;
+        return false;
+    }
+    in_flight_++;
+    admitted_++;
+    return true;
+}
+
+bool RequestScheduler::submitReserved(std::function<void()> task, Clock::time_point deadline) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return false;
+        }
+        push(std::move(task), deadline, true);
+    }
+    work_available_.notify_one();
+    return true;
+}
+
+void RequestScheduler::release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_--;
+    }
+    capacity_available_.notify_one();
+}
+
+void RequestScheduler::push(std::function<void()> task, Clock::time_point deadline,
+                            bool reserved) {
+    queue_.push_back(Entry{deadline, next_sequence_++, std::move(task), reserved});
+    std::push_heap(queue_.begin(), queue_.end(), RunsLater());
+}
+
+void RequestScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    capacity_available_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void RequestScheduler::workerLoop(int index) {
+    if (!config_.worker_cpus.empty()) {
+        pinCurrentThread(config_.worker_cpus[index % config_.worker_cpus.size()]);
+    }
+
+    while (true) {
+        std::function<void()> task;
+        bool reserved = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+
+            // Drain remaining work before exiting so admitted requests complete
+            if (queue_.empty()) {
+                return;
+            }
+            std::pop_heap(queue_.begin(), queue_.end(), RunsLater());
+            task = std::move(queue_.back().task);
+            reserved = queue_.back().reserved;
+            queue_.pop_back();
+        }
+
+        task();
+
+        // A reserved slot is given back by release(), not per task
+        if (reserved) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_--;
+        }
+        capacity_available_.notify_one();
+    }
+}
+
+RequestScheduler::Stats RequestScheduler::getStats() const {
+    Stats stats;
+    stats.admitted = admitted_.load();
+    stats.rejected = rejected_.load();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.in_flight = in_flight_;
+    stats.queue_depth = static_cast<int>(queue_.size());
+    return stats;
+}
+
+}  // namespace ventus
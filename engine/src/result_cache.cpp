@@ -0,0 +1,120 @@
+#include "result_cache.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace ventus {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+
+uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// Final avalanche so every input bit affects every output bit.
+uint64_t fmix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+}  // namespace
+
+ContentHash hashBytes(const uint8_t* data, size_t size, uint64_t seed) {
+    uint64_t h1 = seed ^ kPrime1;
+    uint64_t h2 = rotl(seed, 32) ^ kPrime2;
+
+    // Two lanes mix each word with different constants; neither depends
+    // on the other's result, so their multiplies overlap
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        h1 = rotl(h1 ^ (word * kPrime2), 31) * kPrime1;
+        h2 = rotl(h2 ^ (word * kPrime3), 27) * kPrime2;
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    h1 ^= tail * kPrime3;
+    h2 ^= rotl(tail, 17) * kPrime1;
+
+    ContentHash hash;
+    hash.hi = fmix(h1 ^ size) ^ fmix(h2);
+    hash.lo = fmix(h2 + size) ^ rotl(fmix(h1), 21);
+    return hash;
+}
+
+HashKey HashKey::random() {
+    std::random_device device;
+    auto word = [&device] {
+        return (static_cast<uint64_t>(device()) << 32) | device();
+    };
+    HashKey key;
+    key.k0 = word();
+    key.k1 = word();
+    return key;
+}
+
+ContentHash keyedHash(const uint8_t* data, size_t size, const HashKey& key) {
+    // SipHash-2-4 with the 128-bit output variant
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key.k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key.k1 ^ 0xee;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key.k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ key.k1;
+
+    auto round = [&] {
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    };
+    auto absorb = [&](uint64_t word) {
+        v3 ^= word;
+        round();
+        round();
+        v0 ^= word;
+    };
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        absorb(word);
+    }
+    uint64_t last = static_cast<uint64_t>(size) << 56;
+    for (size_t j = 0; j < size - i; ++j) {
+        last |= static_cast<uint64_t>(data[i + j]) << (8 * j);
+    }
+    absorb(last);
+
+    ContentHash hash;
+    v2 ^= 0xee;
+    for (int r = 0; r < 4; ++r) {
+        round();
+    }
+    hash.lo = v0 ^ v1 ^ v2 ^ v3;
+    v1 ^= 0xdd;
+    for (int r = 0; r < 4; ++r) {
+        round();
+    }
+    hash.hi = v0 ^ v1 ^ v2 ^ v3;
+    return hash;
+}
+
+std::string toHex(const ContentHash& hash) {
+    char text[33];
+    std::snprintf(text, sizeof(text), "%016llx%016llx",
+                  static_cast<unsigned long long>(hash.hi),
+                  static_cast<unsigned long long>(hash.lo));
+    return text;
+}
+
+}  // namespace ventus
@@ -1,62 +1,215 @@
 #include "scene_classifier.h"
-#include <tensorflow/lite/interpreter.h>
-#include <tensorflow/lite/kernels/register.h>
-#include <tensorflow/lite/model.h>
+#include "interpreter_pool.h"
+#include "trace.h"
 #include <algorithm>
 #include <chrono>
+#include <stdexcept>
 #include <unordered_set>
 
 namespace ventus {
 
+namespace {
+
+// Consecutive batches that would fit a smaller shape before a slot shrinks
+constexpr int kShrinkAfter = 64;
+
+// Batches run padded to a power of two, capped at the largest batch
+int batchShape(int batch_size, int max_batch_size) {
+    int shape = 1;
+    while (shape < batch_size) {
+        shape *= 2;
+    }
+    return std::max(batch_size, std::min(shape, max_batch_size));
+}
+
+int64_t elapsedUs(std::chrono::high_resolution_clock::time_point start,
+                  std::chrono::high_resolution_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+}  // namespace
+
+// Batch dimension bookkeeping for one pooled interpreter
+struct SceneClassifier::SlotShape {
+    int batch_size;        // Current batch dimension
+    int smaller_runs = 0;  // Batches in a row that fit a smaller shape
+    int dirty_rows;        // Leading input rows that may hold image data
+};
+
 class SceneClassifier::Impl {
 public:
-    std::unique_ptr<tflite::FlatBufferModel> model;
-    std::unique_ptr<tflite::Interpreter> interpreter;
-    tflite::ops::builtin::BuiltinOpResolver resolver;
+    std::unique_ptr<InterpreterPool> pool;
+    std::vector<int> input_dims;        // Model input shape, batch first
+    size_t image_size = 0;              // Elements per image
+    TensorFormat input_format;
+    TensorFormat output_format;
+    std::vector<SlotShape> slot_shapes;
+    std::vector<bool> slot_in_place;    // Input written via inputTensor()
+    std::vector<std::vector<float>> slot_scores;  // Dequantized outputs per slot
+    std::unique_ptr<ScenePostprocessor> postprocessor;
+
+    // Cascade gate, sharing input format and labels with the full model
+    std::unique_ptr<InterpreterPool> gate_pool;
+    TensorFormat gate_output_format;
+    std::vector<SlotShape> gate_slot_shapes;
+    std::vector<std::vector<float>> gate_slot_scores;
 };
 
+const std::string& sceneLabelName(int label_id) {
+    static const std::vector<std::string> labels = [] {
+        std::vector<std::string> all(kOutdoorLabels.begin(), kOutdoorLabels.end());
+        all.insert(all.end(), kIndoorLabels.begin(), kIndoorLabels.end());
+        return all;
+    }();
+    return labels.at(label_id);
+}
+
 SceneClassifier::SceneClassifier(const Config& config) 
     : config_(config), impl_(std::make_unique<Impl>()) {
     
-    // Load TFLite model
-    impl_->model = tflite::FlatBufferModel::BuildFromFile(config_.model_path.c_str());
-    if (!impl_->model) {
-        throw std::runtime_error("Failed to load model: " + config_.model_path);
-    }
+    // Load TFLite model and build one interpreter per pool slot
+    InterpreterPool::Config pool_config;
+    pool_config.model_path = config_.model_path;
+    pool_config.pool_size = config_.pool_size;
+    pool_config.num_threads = config_.num_threads;
+    pool_config.delegate = config_.delegate;
+    impl_->pool = std::make_unique<InterpreterPool>(pool_config);
 
-    // Build interpreter
-    tflite::InterpreterBuilder builder(*impl_->model, impl_->resolver);
-    builder(&impl_->interpreter);
-    
-    if (!impl_->interpreter) {
-        throw std::runtime_error("Failed to create interpreter");
+    const TfLiteTensor* input = impl_->pool->interpreter(0)->input_tensor(0);
+    impl_->image_size = 1;
+    for (int d = 0; d < input->dims->size; ++d) {
+        impl_->input_dims.push_back(input->dims->data[d]);
+        if (d > 0) {
+            impl_->image_size *= input->dims->data[d];
+        }
     }
+    impl_->slot_shapes.assign(impl_->pool->size(),
+                              SlotShape{impl_->input_dims[0], 0, impl_->input_dims[0]});
+    impl_->slot_in_place.assign(impl_->pool->size(), false);
 
-    // Configure threads
-    impl_->interpreter->SetNumThreads(config_.num_threads);
-
-    // Allocate tensors
-    if (impl_->interpreter->AllocateTensors() != kTfLiteOk) {
-        throw std::runtime_error("Failed to allocate tensors");
-    }
+    // Quantized models take quantized pixels and produce quantized scores
+    impl_->input_format = tensorFormat(*input);
+    impl_->output_format = tensorFormat(*impl_->pool->interpreter(0)->output_tensor(0));
+    impl_->slot_scores.resize(impl_->pool->size());
 
     loadLabels();
     initializeOutdoorMapping();
+    impl_->postprocessor = std::make_unique<ScenePostprocessor>(
+        static_cast<int>(labels_.size()), outdoor_indices_,
+        config_.top_k, config_.outdoor_threshold);
+    if (!config_.gate_model_path.empty()) {
+        loadGate();
+    }
     ready_ = true;
 }
 
 SceneClassifier::~SceneClassifier() = default;
 
+void SceneClassifier::loadGate() {
+    if (!(config_.gate_low < config_.gate_high)) {
+        throw std::invalid_argument("gate_low must be below gate_high");
+    }
+
+    InterpreterPool::Config gate_config;
+    gate_config.model_path = config_.gate_model_path;
+    gate_config.pool_size = config_.gate_pool_size > 0 ? config_.gate_pool_size
+                                                       : config_.pool_size;
+    gate_config.num_threads = 1;  // Small enough that threading costs more than it saves
+    gate_config.delegate = config_.delegate;
+    impl_->gate_pool = std::make_unique<InterpreterPool>(gate_config);
+
+    // The gate reads the same preprocessed tensor as the full model
+    tflite::Interpreter* gate = impl_->gate_pool->interpreter(0);
+    const TfLiteTensor* input = gate->input_tensor(0);
+    TensorFormat input_format = tensorFormat(*input);
+    bool same_shape = input->dims->size == static_cast<int>(impl_->input_dims.size());
+    for (int d = 1; same_shape && d < input->dims->size; ++d) {
+        same_shape = input->dims->data[d] == impl_->input_dims[d];
+    }
+    if (!same_shape || input_format.type != impl_->input_format.type ||
+        input_format.scale != impl_->input_format.scale ||
+        input_format.zero_point != impl_->input_format.zero_point) {
+        throw std::runtime_error("Gate model input must match the scene model input");
+    }
+
+    const TfLiteTensor* output = gate->output_tensor(0);
+    if (output->dims->data[output->dims->size - 1] != static_cast<int>(labels_.size())) {
+        throw std::runtime_error("Gate model must output one score per scene label");
+    }
+    impl_->gate_output_format = tensorFormat(*output);
+    impl_->gate_slot_shapes.assign(impl_->gate_pool->size(),
+                                   SlotShape{input->dims->data[0], 0, input->dims->data[0]});
+    impl_->gate_slot_scores.resize(impl_->gate_pool->size());
+}
+
+bool SceneClassifier::hasGate() const {
+    return impl_->gate_pool != nullptr;
+}
+
+std::vector<int> SceneClassifier::runGate(const uint8_t* const* inputs, int batch_size,
+                                          ClassificationResult* results) {
+    TraceSpan span("classifier.gate");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // The whole batch goes through the gate in one Invoke(), padded to the
+    // same shapes as the full model
+    InterpreterPool::Lease gate = impl_->gate_pool->acquire();
+    SlotShape& shape = impl_->gate_slot_shapes[gate.slot()];
+    ensureBatchSize(*impl_->gate_pool, gate.slot(), shape, batch_size);
+    uint8_t* gate_input = reinterpret_cast<uint8_t*>(gate->input_tensor(0)->data.raw);
+    const size_t image_bytes = inputBytes();
+    for (int b = 0; b < batch_size; ++b) {
+        auto copy_start = std::chrono::high_resolution_clock::now();
+        std::copy(inputs[b], inputs[b] + image_bytes, gate_input + b * image_bytes);
+        results[b].tensor_copy_us += elapsedUs(copy_start,
+                                               std::chrono::high_resolution_clock::now());
+    }
+    zeroPadding(gate.get(), shape, batch_size);
+
+    auto invoke_start = std::chrono::high_resolution_clock::now();
+    if (gate->Invoke() != kTfLiteOk) {
+        throw std::runtime_error("Gate inference failed");
+    }
+    auto invoke_end = std::chrono::high_resolution_clock::now();
+
+    const size_t output_size = labels_.size();
+    const float* scores = floatData(*gate->output_tensor(0), impl_->gate_output_format,
+                                    output_size * batch_size,
+                                    impl_->gate_slot_scores[gate.slot()]);
+    std::vector<int> escalated;
+    for (int b = 0; b < batch_size; ++b) {
+        auto postprocess_start = std::chrono::high_resolution_clock::now();
+        ClassificationResult& result = results[b];
+        impl_->postprocessor->run(scores + b * output_size, result);
+        result.gate_score = result.outdoor_score;
+        if (result.gate_score >= config_.gate_high) {
+            result.gate_decision = GateDecision::kOutdoor;
+        } else if (result.gate_score <= config_.gate_low) {
+            result.gate_decision = GateDecision::kIndoor;
+        } else {
+            result.gate_decision = GateDecision::kEscalated;
+            escalated.push_back(b);
+        }
+        result.invoke_us += elapsedUs(invoke_start, invoke_end);
+        result.postprocess_us += elapsedUs(postprocess_start,
+                                           std::chrono::high_resolution_clock::now());
+    }
+
+    const int64_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start
+    ).count();
+    for (int b = 0; b < batch_size; ++b) {
+        results[b].inference_time_ms = elapsed_ms;
+    }
+    return escalated;
+}
+
 void SceneClassifier::loadLabels() {
     // Initialize with outdoor scene labels
     labels_ = std::vector<std::string>(kOutdoorLabels.begin(), kOutdoorLabels.end());
     
     // Add indoor labels for contrast
-    std::vector<std::string> indoor_labels = {
-        "indoor", "room", "bedroom", "bathroom", "kitchen", "office",
-        "living_room", "hallway", "basement", "attic", "closet"
-    };
-    labels_.insert(labels_.end(), indoor_labels.begin(), indoor_labels.end());
+    labels_.insert(labels_.end(), kIndoorLabels.begin(), kIndoorLabels.end());
 }
 
 void SceneClassifier::initializeOutdoorMapping() {
@@ -71,70 +224,309 @@ void SceneClassifier::initializeOutdoorMapping() {
     }
 }
 
+ContentHash SceneClassifier::modelHash() const {
+    ContentHash hash = impl_->pool->modelHash();
+    if (hasGate()) {
+        const ContentHash& gate = impl_->gate_pool->modelHash();
+        const uint64_t words[] = {hash.hi, hash.lo, gate.hi, gate.lo};
+        hash = hashBytes(reinterpret_cast<const uint8_t*>(words), sizeof(words));
+    }
+    return hash;
+}
+
+std::vector<DelegateBenchmark> SceneClassifier::benchmarkDelegates(int runs) const {
+    InterpreterPool::Config pool_config;
+    pool_config.model_path = config_.model_path;
+    pool_config.num_threads = config_.num_threads;
+
+    std::vector<DelegateBenchmark> results;
+    for (DelegatePolicy policy : {DelegatePolicy::kXnnpack, DelegatePolicy::kBuiltin,
+                                  DelegatePolicy::kMinimal}) {
+        pool_config.delegate = policy;
+        results.push_back(InterpreterPool::benchmark(pool_config, runs));
+    }
+    return results;
+}
+
+void SceneClassifier::warmup() {
+    std::vector<InterpreterPool*> pools = {impl_->pool.get()};
+    if (hasGate()) {
+        pools.push_back(impl_->gate_pool.get());
+    }
+    for (InterpreterPool* pool : pools) {
+        for (int slot = 0; slot < pool->size(); ++slot) {
+            tflite::Interpreter* interpreter = pool->interpreter(slot);
+            TfLiteTensor* input = interpreter->input_tensor(0);
+            std::fill(input->data.raw, input->data.raw + input->bytes, 0);
+            if (interpreter->Invoke() != kTfLiteOk) {
+                throw std::runtime_error("Warmup inference failed");
+            }
+        }
+    }
+}
+
+SceneClassifier::Lease SceneClassifier::checkout() {
+    // Covers the wait for a free interpreter
+    TraceSpan span("classifier.checkout");
+    return Lease(this, impl_->pool->acquire());
+}
+
+void SceneClassifier::checkin(Lease& lease) {
+    if (lease.owner_ != this) {
+        return;
+    }
+    lease.lease_.reset();
+}
+
+size_t SceneClassifier::inputSize() const {
+    return impl_->image_size;
+}
+
+size_t SceneClassifier::inputBytes() const {
+    return impl_->image_size * impl_->input_format.elementSize();
+}
+
+const TensorFormat& SceneClassifier::inputFormat() const {
+    return impl_->input_format;
+}
+
+const TensorFormat& SceneClassifier::outputFormat() const {
+    return impl_->output_format;
+}
+
+void SceneClassifier::requireFloatInput() const {
+    if (impl_->input_format.isQuantized()) {
+        throw std::invalid_argument("Model input is quantized; pass input bytes");
+    }
+}
+
+int SceneClassifier::poolSize() const {
+    return impl_->pool->size();
+}
+
+std::vector<size_t> SceneClassifier::interpreterArenaBytes() const {
+    std::vector<size_t> bytes;
+    for (int slot = 0; slot < impl_->pool->size(); ++slot) {
+        bytes.push_back(impl_->pool->arenaBytes(slot));
+    }
+    return bytes;
+}
+
 ClassificationResult SceneClassifier::classify(const std::vector<float>& input) {
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    ClassificationResult result;
-    
+    Lease lease = checkout();
+    return classify(input, lease);
+}
+
+ClassificationResult SceneClassifier::classify(const std::vector<float>& input, Lease& lease) {
+    requireFloatInput();
+    if (input.size() != inputSize()) {
+        throw std::invalid_argument("Input tensor size does not match model input");
+    }
+    const float* inputs[] = {input.data()};
+    return std::move(classifyBatch(inputs, 1, lease).front());
+}
+
+ClassificationResult SceneClassifier::classify(const std::vector<uint8_t>& input) {
+    if (input.size() != inputBytes()) {
+        throw std::invalid_argument("Input tensor size does not match model input");
+    }
+    Lease lease = checkout();
+    const uint8_t* inputs[] = {input.data()};
+    return std::move(classifyBatch(inputs, 1, lease).front());
+}
+
+std::vector<ClassificationResult> SceneClassifier::classifyBatch(
+    const float* const* inputs, int batch_size, Lease& lease) {
+
+    requireFloatInput();
+    std::vector<const uint8_t*> bytes(batch_size);
+    for (int b = 0; b < batch_size; ++b) {
+        bytes[b] = reinterpret_cast<const uint8_t*>(inputs[b]);
+    }
+    return classifyBatch(bytes.data(), batch_size, lease);
+}
+
+std::vector<ClassificationResult> SceneClassifier::classifyBatch(
+    const uint8_t* const* inputs, int batch_size, Lease& lease) {
+
     if (!ready_) {
+        ClassificationResult result;
         result.is_outdoor = false;
         result.outdoor_score = 0.0f;
-        return result;
+        return std::vector<ClassificationResult>(batch_size, result);
     }
 
-    // Get input tensor and copy data
-    float* input_tensor = impl_->interpreter->typed_input_tensor<float>(0);
-    std::copy(input.begin(), input.end(), input_tensor);
+    std::vector<ClassificationResult> results(batch_size);
 
-    // Run inference
-    if (impl_->interpreter->Invoke() != kTfLiteOk) {
-        throw std::runtime_error("Inference failed");
+    // Only images the gate is unsure about go through the full model
+    std::vector<const uint8_t*> escalated_inputs;
+    std::vector<int> escalated;
+    if (hasGate()) {
+        escalated = runGate(inputs, batch_size, results.data());
+        if (escalated.empty()) {
+            return results;
+        }
+        for (int b : escalated) {
+            escalated_inputs.push_back(inputs[b]);
+        }
+        inputs = escalated_inputs.data();
+        batch_size = static_cast<int>(escalated.size());
     }
 
-    // Get output
-    float* output = impl_->interpreter->typed_output_tensor<float>(0);
-    int output_size = static_cast<int>(labels_.size());
+    tflite::Interpreter* interpreter = leasedInterpreter(lease);
+    SlotShape& shape = impl_->slot_shapes[lease.slot()];
+    ensureBatchSize(*impl_->pool, lease.slot(), shape, batch_size);
+    impl_->slot_in_place[lease.slot()] = false;
+
+    // Copy each image into its slice of the batched input tensor
+    std::vector<ClassificationResult> full(escalated.empty() ? 0 : batch_size);
+    ClassificationResult* batch_results = escalated.empty() ? results.data() : full.data();
+    uint8_t* input_tensor = reinterpret_cast<uint8_t*>(interpreter->input_tensor(0)->data.raw);
+    const size_t image_bytes = inputBytes();
+    for (int b = 0; b < batch_size; ++b) {
+        auto copy_start = std::chrono::high_resolution_clock::now();
+        std::copy(inputs[b], inputs[b] + image_bytes, input_tensor + b * image_bytes);
+        batch_results[b].tensor_copy_us = elapsedUs(copy_start,
+                                                    std::chrono::high_resolution_clock::now());
+    }
+    zeroPadding(interpreter, shape, batch_size);
 
-    // Collect predictions
-    std::vector<std::pair<float, int>> scores;
-    for (int i = 0; i < output_size; ++i) {
-        scores.emplace_back(output[i], i);
+    invoke(interpreter, lease.slot(), batch_size, batch_results);
+    for (size_t i = 0; i < escalated.size(); ++i) {
+        ClassificationResult& result = results[escalated[i]];
+        const ClassificationResult gate = result;
+        result = full[i];
+        result.gate_decision = GateDecision::kEscalated;
+        result.gate_score = gate.gate_score;
+        result.inference_time_ms += gate.inference_time_ms;
+        result.tensor_copy_us += gate.tensor_copy_us;
+        result.invoke_us += gate.invoke_us;
+        result.postprocess_us += gate.postprocess_us;
     }
+    return results;
+}
 
-    // Sort by confidence
-    std::sort(scores.begin(), scores.end(), std::greater<>());
+void* SceneClassifier::inputTensor(Lease& lease) {
+    tflite::Interpreter* interpreter = leasedInterpreter(lease);
+    ensureBatchSize(*impl_->pool, lease.slot(), impl_->slot_shapes[lease.slot()], 1);
+    impl_->slot_in_place[lease.slot()] = true;
+    return interpreter->input_tensor(0)->data.raw;
+}
 
-    // Calculate outdoor score
-    float outdoor_total = 0.0f;
-    std::unordered_set<int> outdoor_idx_set(
-        outdoor_indices_.begin(), outdoor_indices_.end()
-    );
+ClassificationResult SceneClassifier::classifyInPlace(Lease& lease) {
+    if (!ready_) {
+        ClassificationResult result;
+        result.is_outdoor = false;
+        result.outdoor_score = 0.0f;
+        return result;
+    }
 
-    for (const auto& [score, idx] : scores) {
-        if (outdoor_idx_set.count(idx) > 0) {
-            outdoor_total += score;
+    tflite::Interpreter* interpreter = leasedInterpreter(lease);
+    if (!impl_->slot_in_place[lease.slot()]) {
+        throw std::logic_error("Input tensor was not filled via inputTensor()");
+    }
+    impl_->slot_in_place[lease.slot()] = false;
+    zeroPadding(interpreter, impl_->slot_shapes[lease.slot()], 1);
+    ClassificationResult result;
+    if (hasGate()) {
+        const uint8_t* input = reinterpret_cast<const uint8_t*>(
+            interpreter->input_tensor(0)->data.raw);
+        if (runGate(&input, 1, &result).empty()) {
+            return result;
         }
     }
 
-    // Build top-k predictions
-    for (int i = 0; i < std::min(config_.top_k, static_cast<int>(scores.size())); ++i) {
-        ScenePrediction pred;
-        pred.label = labels_[scores[i].second];
-        pred.confidence = scores[i].first;
-        pred.is_outdoor = outdoor_idx_set.count(scores[i].second) > 0;
-        result.predictions.push_back(pred);
+    // Postprocessing leaves the gate fields in place
+    const int64_t gate_ms = result.inference_time_ms;
+    invoke(interpreter, lease.slot(), 1, &result);
+    result.inference_time_ms += gate_ms;
+    return result;
+}
+
+tflite::Interpreter* SceneClassifier::leasedInterpreter(const Lease& lease) const {
+    if (!lease || lease.owner_ != this) {
+        throw std::invalid_argument("Lease does not belong to this classifier");
     }
+    return lease.lease_.get();
+}
 
-    result.outdoor_score = outdoor_total;
-    result.is_outdoor = outdoor_total >= config_.outdoor_threshold;
+void SceneClassifier::invoke(tflite::Interpreter* interpreter, int slot, int batch_size,
+                             ClassificationResult* results) {
+    TraceSpan span("classifier.invoke");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Run inference
+    if (interpreter->Invoke() != kTfLiteOk) {
+        throw std::runtime_error("Inference failed");
+    }
+
+    auto invoke_end = std::chrono::high_resolution_clock::now();
+
+    // Get output, dequantizing only the scores
+    const size_t output_size = labels_.size();
+    const float* output = floatData(*interpreter->output_tensor(0), impl_->output_format,
+                                    output_size * batch_size, impl_->slot_scores[slot]);
 
     auto end = std::chrono::high_resolution_clock::now();
-    result.inference_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+    int64_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         end - start
     ).count();
 
-    return result;
+    // Every image in the batch waited for the whole invoke
+    const int64_t invoke_us = elapsedUs(start, invoke_end);
+    const int64_t dequantize_us = elapsedUs(invoke_end, end);
+    for (int b = 0; b < batch_size; ++b) {
+        auto postprocess_start = std::chrono::high_resolution_clock::now();
+        impl_->postprocessor->run(output + b * output_size, results[b]);
+        results[b].inference_time_ms = elapsed_ms;
+        results[b].invoke_us += invoke_us;
+        results[b].postprocess_us += dequantize_us + elapsedUs(
+            postprocess_start, std::chrono::high_resolution_clock::now());
+    }
 }
 
-}  // namespace ventus
+void SceneClassifier::ensureBatchSize(InterpreterPool& pool, int slot, SlotShape& state,
+                                      int batch_size) {
+    // Every new shape reallocates the arena and makes XNNPACK re-prepare
+    // the graph, so batches are padded to a few fixed shapes. A slot grows
+    // at once but only shrinks after a run of smaller batches, so bursty
+    // traffic settles on one shape.
+    int& current = state.batch_size;
+    int& smaller_runs = state.smaller_runs;
+    const int shape = batchShape(batch_size, config_.max_batch_size);
+    if (shape == current) {
+        smaller_runs = 0;
+        return;
+    }
+    if (shape < current && ++smaller_runs < kShrinkAfter) {
+        return;
+    }
+
+    tflite::Interpreter* interpreter = pool.interpreter(slot);
+    std::vector<int> dims = impl_->input_dims;
+    dims[0] = shape;
+    if (interpreter->ResizeInputTensor(interpreter->inputs()[0], dims) != kTfLiteOk ||
+        interpreter->AllocateTensors() != kTfLiteOk) {
+        throw std::runtime_error(
+            "Failed to resize input tensor to batch " + std::to_string(shape));
+    }
+    pool.measureArenaBytes(slot);
+    current = shape;
+    smaller_runs = 0;
+    state.dirty_rows = shape;  // A new arena starts undefined
+}
 
+void SceneClassifier::zeroPadding(tflite::Interpreter* interpreter, SlotShape& state,
+                                  int batch_size) {
+    // Padding rows are computed and ignored; zero only those an earlier,
+    // larger batch wrote, so they never carry another request's pixels
+    int& dirty_rows = state.dirty_rows;
+    if (dirty_rows > batch_size) {
+        uint8_t* input = reinterpret_cast<uint8_t*>(interpreter->input_tensor(0)->data.raw);
+        const size_t image_bytes = inputBytes();
+        std::fill(input + batch_size * image_bytes, input + dirty_rows * image_bytes, 0);
+    }
+    dirty_rows = batch_size;
+}
+
+}  // namespace ventus
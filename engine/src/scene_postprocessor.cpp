@@ -0,0 +1,56 @@
+#include "scene_postprocessor.h"
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+namespace ventus {
+
+ScenePostprocessor::ScenePostprocessor(int num_classes, const std::vector<int>& outdoor_indices,
+                                       int top_k, float outdoor_threshold)
+    : outdoor_weights_(num_classes, 0.0f),
+      top_k_(std::min(top_k, num_classes)),
+      outdoor_threshold_(outdoor_threshold) {
+    if (top_k < 0 || top_k > PredictionList::kCapacity) {
+        throw std::invalid_argument("top_k must be between 0 and " +
+                                    std::to_string(PredictionList::kCapacity));
+    }
+    for (int idx : outdoor_indices) {
+        if (idx < 0 || idx >= num_classes) {
+            throw std::invalid_argument("Outdoor class index out of range");
+        }
+        outdoor_weights_[idx] = 1.0f;
+    }
+}
+
+void ScenePostprocessor::run(const float* scores, ClassificationResult& result) const {
+    const int num_classes = numClasses();
+
+    // Branch-free weighted sum over all classes
+    float outdoor_total = 0.0f;
+    for (int i = 0; i < num_classes; ++i) {
+        outdoor_total += scores[i] * outdoor_weights_[i];
+    }
+
+    // Reused across calls on the same thread to avoid reallocating
+    thread_local std::vector<int> order;
+    order.resize(num_classes);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + top_k_, order.end(),
+                      [scores](int a, int b) {
+                          return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+                      });
+
+    result.predictions.clear();
+    for (int i = 0; i < top_k_; ++i) {
+        ScenePrediction pred;
+        pred.label_id = order[i];
+        pred.confidence = scores[order[i]];
+        pred.is_outdoor = outdoor_weights_[order[i]] > 0.0f;
+        result.predictions.push_back(pred);
+    }
+
+    result.outdoor_score = outdoor_total;
+    result.is_outdoor = outdoor_total >= outdoor_threshold_;
+}
+
+}  // namespace ventus
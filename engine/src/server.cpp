@@ -1,92 +1,565 @@
+#include "autotuner.h"
 #include "inference_engine.h"
+#include "metrics_server.h"
+#include "request_scheduler.h"
+#include "trace.h"
 #include "verification.grpc.pb.h"
 
+#include <google/protobuf/arena.h>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
+#include <grpcpp/support/message_allocator.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <chrono>
+#include <thread>
 
+using grpc::CallbackServerContext;
 using grpc::Server;
+using grpc::ServerBidiReactor;
 using grpc::ServerBuilder;
+using grpc::ServerReadReactor;
+using grpc::ServerReader;
 using grpc::ServerContext;
+using grpc::ServerUnaryReactor;
 using grpc::Status;
+using grpc::StatusCode;
 using grpc::ServerReaderWriter;
 
 namespace ventus {
 namespace cv {
 
-class VerificationServiceImpl final : public VerificationService::Service {
+/**
+ * Server mode and admission settings.
+ */
+struct ServerOptions {
+    bool async_mode = false;
+    int inference_workers = 0;  // 0 = one per pooled interpreter
+    int max_in_flight = 64;
+    int stream_window = 8;       // In-flight requests per VerifyImageStream
+    int metrics_port = 0;        // Prometheus endpoint; 0 = disabled
+    bool tracing = true;         // Record request spans for DumpTrace
+
+    // Startup autotuning of threads, pool size and batch size
+    bool autotune = false;
+    std::string autotune_file;   // Reused when tuned for the same model and host
+    double p99_target_ms = 50.0;
+    double autotune_seconds = 2.0;  // Per candidate
+};
+
+// Shared request handling for both server modes
+
+GateDecision ToProto(ventus::GateDecision decision) {
+    switch (decision) {
+        case ventus::GateDecision::kOutdoor: return GATE_OUTDOOR;
+        case ventus::GateDecision::kIndoor: return GATE_INDOOR;
+        case ventus::GateDecision::kEscalated: return GATE_ESCALATED;
+        default: return GATE_NONE;
+    }
+}
+
+void PopulateResponse(const VerificationResult& result, VerifyImageResponse* response,
+                      StageMetrics& metrics) {
+    TraceSpan span("rpc.response");
+    auto build_start = std::chrono::high_resolution_clock::now();
+
+    // Populate response
+    response->set_is_outdoor(result.is_outdoor);
+    response->set_face_detected(result.face_detected);
+    response->set_verification_passed(result.verification_passed);
+    response->set_outdoor_confidence(result.outdoor_confidence);
+    response->set_face_confidence(result.face_confidence);
+    response->set_inference_time_ms(result.inference_time_ms);
+    response->set_preprocessing_time_ms(result.preprocessing_time_ms);
+    response->set_decode_time_us(result.decode.decode_time_us);
+    response->set_decode_scale_denom(result.decode.scale_denom);
+    response->set_decode_time_saved_us(result.decode.decode_time_saved_us);
+    response->set_gate_decision(ToProto(result.gate_decision));
+    response->set_gate_score(result.gate_score);
+    response->set_cache_hit(result.cache_hit);
+    response->set_success(result.success);
+    response->set_error_message(result.error_message);
+
+    // Add scene labels, resolving label text only here
+    for (const auto& label : result.scene_labels) {
+        auto* scene_label = response->add_scene_labels();
+        scene_label->set_label(sceneLabelName(label.label_id));
+        scene_label->set_confidence(label.confidence);
+    }
+
+    // Add face detections
+    for (const auto& face : result.faces) {
+        auto* face_detection = response->add_faces();
+        face_detection->set_x(face.x);
+        face_detection->set_y(face.y);
+        face_detection->set_width(face.width);
+        face_detection->set_height(face.height);
+        face_detection->set_confidence(face.confidence);
+    }
+
+    metrics.record(Stage::kResponseBuild, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - build_start).count());
+}
+
+/**
+ * Record the time a request spent queued before a worker picked it up.
+ * @param enqueued_us TraceRecorder::nowUs() at submission
+ */
+void TraceQueueWait(const char* name, const std::string& request_id, int64_t enqueued_us) {
+    TraceRecorder& recorder = TraceRecorder::global();
+    if (recorder.enabled()) {
+        recorder.record(name, request_id, enqueued_us, TraceRecorder::nowUs() - enqueued_us);
+    }
+}
+
+/**
+ * The RPC's deadline and cancellation, for the engine to shed on.
+ * @param context Must outlive every use of the result
+ */
+RequestDeadline DeadlineOf(const grpc::ServerContextBase* context) {
+    auto deadline = RequestDeadline::Clock::time_point::max();
+    const auto rpc_deadline = context->deadline();
+    if (rpc_deadline != std::chrono::system_clock::time_point::max()) {
+        deadline = RequestDeadline::Clock::now() +
+                   std::chrono::duration_cast<RequestDeadline::Clock::duration>(
+                       rpc_deadline - std::chrono::system_clock::now());
+    }
+    return RequestDeadline(deadline, [context] { return context->IsCancelled(); });
+}
+
+/**
+ * Status for a request the engine shed; the client has either given up
+ * or is about to.
+ */
+Status ShedStatus(const VerificationResult& result, const RequestDeadline& deadline) {
+    return Status(deadline.cancelled() ? StatusCode::CANCELLED : StatusCode::DEADLINE_EXCEEDED,
+                  result.error_message);
+}
+
+Status HandleVerify(InferenceEngine& engine, const VerifyImageRequest& request,
+                    VerifyImageResponse* response, const RequestDeadline& deadline) {
+    TraceScope scope(request.request_id());
+    TraceSpan span("rpc.verify");
+    response->set_request_id(request.request_id());
+
+    if (!engine.isReady()) {
+        response->set_success(false);
+        response->set_error_message("Engine not ready");
+        return Status::OK;
+    }
+
+    const auto& image_data = request.image_data();
+    auto result = engine.verify(
+        reinterpret_cast<const uint8_t*>(image_data.data()),
+        image_data.size(),
+        deadline
+    );
+    if (result.shed) {
+        return ShedStatus(result, deadline);
+    }
+    PopulateResponse(result, response, engine.stageMetrics());
+    return Status::OK;
+}
+
+/**
+ * Response for an upload whose last chunk has been fed: finish the
+ * decode, then preprocess and run the models on the calling thread.
+ */
+Status FinishUpload(InferenceEngine& engine, ImageUpload& upload, const std::string& request_id,
+                    VerifyImageResponse* response, const RequestDeadline& deadline) {
+    TraceScope scope(request_id);
+    TraceSpan span("rpc.verify_upload");
+    response->set_request_id(request_id);
+
+    auto result = engine.infer(engine.prepare(upload, deadline), deadline);
+    if (result.shed) {
+        return ShedStatus(result, deadline);
+    }
+    PopulateResponse(result, response, engine.stageMetrics());
+    return Status::OK;
+}
+
+void FillHealth(const InferenceEngine& engine, HealthResponse* response) {
+    auto stats = engine.getStats();
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now() - stats.start_time
+    );
+
+    response->set_healthy(engine.isReady());
+    response->set_version(InferenceEngine::version());
+    response->set_uptime_seconds(uptime.count());
+    response->set_requests_processed(static_cast<int32_t>(stats.total_requests));
+
+    auto cache = engine.getCacheStats();
+    response->set_cache_hits(cache.hits);
+    response->set_cache_misses(cache.misses);
+    response->set_cache_evictions(cache.evictions);
+    response->set_cache_coalesced(cache.coalesced);
+    response->set_cache_entries(cache.entries);
+
+    response->set_requests_succeeded(stats.successful_requests);
+    response->set_avg_latency_ms(stats.avg_latency_ms);
+    for (int i = 0; i < kNumStages; ++i) {
+        const Stage stage = static_cast<Stage>(i);
+        const LatencyHistogram histogram = engine.stageMetrics().snapshot(stage);
+        auto* latency = response->add_stage_latencies();
+        latency->set_stage(stageName(stage));
+        latency->set_count(histogram.count());
+        latency->set_p50_us(histogram.percentile(50));
+        latency->set_p90_us(histogram.percentile(90));
+        latency->set_p99_us(histogram.percentile(99));
+        latency->set_p999_us(histogram.percentile(99.9));
+        latency->set_max_us(histogram.max());
+        latency->set_mean_us(histogram.mean());
+        latency->set_shed(engine.stageMetrics().shed(stage));
+    }
+}
+
+/**
+ * Prometheus text exposition of the engine's counters and stage histograms.
+ */
+std::string RenderMetrics(const InferenceEngine& engine) {
+    auto stats = engine.getStats();
+    auto cache = engine.getCacheStats();
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now() - stats.start_time
+    );
+
+    std::ostringstream out;
+    auto metric = [&out](const char* name, const char* type, const char* help, auto value) {
+        out << "# HELP " << name << " " << help << "\n"
+            << "# TYPE " << name << " " << type << "\n"
+            << name << " " << value << "\n";
+    };
+    metric("ventus_up", "gauge", "Whether the engine is ready to serve.", engine.isReady() ? 1 : 0);
+    metric("ventus_uptime_seconds", "gauge", "Seconds since the engine started.", uptime.count());
+    metric("ventus_requests_total", "counter", "Requests processed.", stats.total_requests);
+    metric("ventus_requests_succeeded_total", "counter", "Requests processed without error.",
+           stats.successful_requests);
+    metric("ventus_cache_hits_total", "counter", "Result cache hits.", cache.hits);
+    metric("ventus_cache_misses_total", "counter", "Result cache misses.", cache.misses);
+    metric("ventus_cache_evictions_total", "counter", "Result cache evictions.", cache.evictions);
+    metric("ventus_cache_coalesced_total", "counter",
+           "Requests that waited on an identical in-flight request.", cache.coalesced);
+    metric("ventus_cache_entries", "gauge", "Results currently cached.", cache.entries);
+
+    // Oversubscription shows up as involuntary switches and run-queue wait
+    auto sched = readSchedulerStats();
+    out << "# HELP ventus_context_switches_total Context switches of all threads.\n"
+        << "# TYPE ventus_context_switches_total counter\n"
+        << "ventus_context_switches_total{kind=\"voluntary\"} " << sched.voluntary_switches << "\n"
+        << "ventus_context_switches_total{kind=\"involuntary\"} " << sched.involuntary_switches
+        << "\n";
+    metric("ventus_cpu_seconds_total", "counter", "User and system CPU time of the process.",
+           sched.cpu_time_ns / 1e9);
+    // Not a counter: it drops when a thread exits
+    metric("ventus_run_queue_wait_seconds", "gauge",
+           "Time the live threads have spent runnable but waiting for a CPU.",
+           sched.run_queue_wait_ns / 1e9);
+    metric("ventus_threads", "gauge", "Threads in the process.", sched.threads);
+    engine.stageMetrics().writePrometheus(out);
+    return out.str();
+}
+
+void FillModelInfo(const InferenceEngine& engine, ModelInfoResponse* response) {
+    response->set_model_name("ventus-scene-classifier");
+    response->set_model_version("1.0.0");
+    response->set_num_classes(static_cast<int32_t>(kOutdoorLabels.size()));
+    response->set_input_width(224);
+    response->set_input_height(224);
+
+    for (const auto& label : kOutdoorLabels) {
+        response->add_class_labels(label);
+    }
+
+    for (size_t bytes : engine.interpreterArenaBytes()) {
+        response->add_interpreter_arena_bytes(static_cast<int64_t>(bytes));
+    }
+
+    auto model = engine.modelInfo();
+    response->set_model_generation(model.generation);
+    response->set_model_path(model.model_path);
+    response->set_model_hash(model.model_hash);
+    response->set_model_loaded_unix_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
+        model.loaded_at.time_since_epoch()).count());
+    response->set_delegate(delegatePolicyName(model.delegate));
+    for (const DelegateBenchmark& benchmark : model.delegate_benchmarks) {
+        auto* timing = response->add_delegate_timings();
+        timing->set_delegate(delegatePolicyName(benchmark.policy));
+        timing->set_invoke_ms(benchmark.invoke_ms);
+        timing->set_error(benchmark.error);
+    }
+}
+
+/**
+ * Hot-swap the scene model. Blocks while the new interpreters load and
+ * warm up; requests keep being served by the current model meanwhile.
+ */
+Status HandleReload(InferenceEngine& engine, const ReloadModelRequest& request,
+                    ModelInfoResponse* response) {
+    try {
+        auto model = engine.reloadModel(request.scene_model_path());
+        std::cout << "Reloaded scene model " << model.model_path << " (generation "
+                  << model.generation << ", hash " << model.model_hash << ")" << std::endl;
+    } catch (const std::exception& e) {
+        return Status(StatusCode::FAILED_PRECONDITION,
+                      std::string("Model reload failed: ") + e.what());
+    }
+    FillModelInfo(engine, response);
+    return Status::OK;
+}
+
+void FillTrace(const DumpTraceRequest& request, DumpTraceResponse* response) {
+    const TraceRecorder& recorder = TraceRecorder::global();
+    const std::vector<TraceEvent> events = recorder.snapshot(
+        request.request_id(), static_cast<size_t>(std::max(0, request.max_events())));
+    response->set_trace_json(TraceRecorder::toChromeJson(events));
+    response->set_events(static_cast<int64_t>(events.size()));
+    response->set_recorded(recorder.recorded());
+    response->set_dropped(recorder.dropped());
+}
+
+const Status kOverloaded(StatusCode::RESOURCE_EXHAUSTED, "Server overloaded, retry later");
+
+/**
+ * Allocates each RPC's request and response on one protobuf arena seeded
+ * with an inline block, so per-call message allocation is a single heap
+ * allocation freed in one shot. The image payload is parsed once into the
+ * arena-owned request and only borrowed from there until the RPC ends.
+ */
+template <typename Request, typename Response>
+class ArenaMessageAllocator final : public grpc::MessageAllocator<Request, Response> {
 public:
-    explicit VerificationServiceImpl(const InferenceEngine::Config& config)
-        : engine_(config) {}
+    grpc::MessageHolder<Request, Response>* AllocateMessages() override {
+        return new Holder();
+    }
 
-    Status VerifyImage(
-        ServerContext* context,
-        const VerifyImageRequest* request,
-        VerifyImageResponse* response
-    ) override {
-        
+private:
+    class Holder final : public grpc::MessageHolder<Request, Response> {
+    public:
+        Holder() : arena_(arenaOptions()) {
+            this->set_request(google::protobuf::Arena::CreateMessage<Request>(&arena_));
+            this->set_response(google::protobuf::Arena::CreateMessage<Response>(&arena_));
+        }
+
+        void Release() override { delete this; }
+
+    private:
+        alignas(8) char initial_block_[4096];
+        google::protobuf::Arena arena_;
+
+        google::protobuf::ArenaOptions arenaOptions() {
+            google::protobuf::ArenaOptions options;
+            options.initial_block = initial_block_;
+            options.initial_block_size = sizeof(initial_block_);
+            return options;
+        }
+    };
+};
+
+/**
+ * Arena-backed request for streamed reads; the arena lives exactly as
+ * long as the last stage still borrowing the image bytes.
+ */
+std::shared_ptr<VerifyImageRequest> NewArenaRequest() {
+    auto arena = std::make_shared<google::protobuf::Arena>();
+    auto* request = google::protobuf::Arena::CreateMessage<VerifyImageRequest>(arena.get());
+    return std::shared_ptr<VerifyImageRequest>(std::move(arena), request);
+}
+
+/**
+ * Worker pools for the two overlapping stages of VerifyImageStream:
+ * decode/preprocess on one, model inference on the other. Each stream
+ * keeps at most `window` requests between read and response write.
+ */
+struct StreamStages {
+    StreamStages(InferenceEngine& engine, const RequestScheduler::Config& preprocess_config,
+                 const RequestScheduler::Config& inference_config, int window)
+        : engine(engine), preprocess(preprocess_config),
+          inference(inference_config), window(window) {}
+
+    InferenceEngine& engine;
+    RequestScheduler preprocess;
+    RequestScheduler inference;
+    int window;
+};
+
+using StreamCompletion = std::function<void(std::unique_ptr<VerifyImageResponse>)>;
+
+/**
+ * Run one streamed request through both stages; `done` is called on an
+ * inference worker with the response once it is ready. Both stage queues
+ * run earliest deadline first, and a request that is shed gets a failed
+ * response naming the stage.
+ * @param may_block Wait for preprocessing capacity instead of failing
+ * @param deadline The stream's deadline and cancellation
+ * @return false if the preprocessing stage did not admit the request
+ */
+bool SubmitPipelined(StreamStages& stages, std::shared_ptr<const VerifyImageRequest> request,
+                     StreamCompletion done, bool may_block, const RequestDeadline& deadline) {
+    auto prepare_stage = [&stages, request, done, deadline,
+                          enqueued_us = TraceRecorder::nowUs()] {
+        TraceScope scope(request->request_id());
+        TraceQueueWait("stream.preprocess_queue", request->request_id(), enqueued_us);
+        auto response = std::make_unique<VerifyImageResponse>();
         response->set_request_id(request->request_id());
-        
-        if (!engine_.isReady()) {
+
+        if (!stages.engine.isReady()) {
             response->set_success(false);
             response->set_error_message("Engine not ready");
-            return Status::OK;
+            done(std::move(response));
+            return;
         }
 
         const auto& image_data = request->image_data();
-        auto result = engine_.verify(
+        auto prepared = std::make_shared<PreparedImage>(stages.engine.prepare(
             reinterpret_cast<const uint8_t*>(image_data.data()),
-            image_data.size()
-        );
-
-        // Populate response
-        response->set_is_outdoor(result.is_outdoor);
-        response->set_face_detected(result.face_detected);
-        response->set_verification_passed(result.verification_passed);
-        response->set_outdoor_confidence(result.outdoor_confidence);
-        response->set_face_confidence(result.face_confidence);
-        response->set_inference_time_ms(result.inference_time_ms);
-        response->set_preprocessing_time_ms(result.preprocessing_time_ms);
-        response->set_success(result.success);
-        response->set_error_message(result.error_message);
-
-        // Add scene labels
-        for (const auto& label : result.scene_labels) {
-            auto* scene_label = response->add_scene_labels();
-            scene_label->set_label(label.label);
-            scene_label->set_confidence(label.confidence);
-        }
-
-        // Add face detections
-        for (const auto& face : result.faces) {
-            auto* face_detection = response->add_faces();
-            face_detection->set_x(face.x);
-            face_detection->set_y(face.y);
-            face_detection->set_width(face.width);
-            face_detection->set_height(face.height);
-            face_detection->set_confidence(face.confidence);
+            image_data.size(),
+            deadline
+        ));
+
+        // Blocking here pushes backpressure onto preprocessing when inference lags
+        auto shared_response = std::make_shared<std::unique_ptr<VerifyImageResponse>>(
+            std::move(response));
+        bool admitted = stages.inference.submit([&stages, prepared, shared_response, done,
+                                                 deadline, enqueued_us = TraceRecorder::nowUs()] {
+            const std::string& request_id = (*shared_response)->request_id();
+            TraceScope scope(request_id);
+            TraceQueueWait("stream.inference_queue", request_id, enqueued_us);
+            PopulateResponse(stages.engine.infer(*prepared, deadline), shared_response->get(),
+                             stages.engine.stageMetrics());
+            done(std::move(*shared_response));
+        }, deadline.deadline());
+
+        if (!admitted) {
+            (*shared_response)->set_success(false);
+            (*shared_response)->set_error_message("Server shutting down");
+            done(std::move(*shared_response));
         }
+    };
 
-        return Status::OK;
+    return may_block ? stages.preprocess.submit(prepare_stage, deadline.deadline())
+                     : stages.preprocess.trySubmit(prepare_stage, deadline.deadline());
+}
+
+/**
+ * Synchronous service: gRPC's thread pool runs inference directly.
+ */
+class VerificationServiceImpl final : public VerificationService::Service {
+public:
+    VerificationServiceImpl(InferenceEngine& engine, StreamStages& stages)
+        : engine_(engine), stages_(stages) {}
+
+    Status VerifyImage(
+        ServerContext* context,
+        const VerifyImageRequest* request,
+        VerifyImageResponse* response
+    ) override {
+        return HandleVerify(engine_, *request, response, DeadlineOf(context));
     }
 
     Status VerifyImageStream(
         ServerContext* context,
         ServerReaderWriter<VerifyImageResponse, VerifyImageRequest>* stream
     ) override {
-        
-        VerifyImageRequest request;
-        while (stream->Read(&request)) {
-            VerifyImageResponse response;
-            VerifyImage(context, &request, &response);
-            stream->Write(response);
-        }
-        
-        return Status::OK;
+
+        const RequestDeadline deadline = DeadlineOf(context);
+        std::mutex mutex;
+        std::condition_variable slot_freed;
+        int in_flight = 0;
+
+        // One writer at a time; Read() may proceed concurrently with Write()
+        std::mutex write_mutex;
+        std::atomic<bool> write_failed{false};
+
+        StreamCompletion complete = [&](std::unique_ptr<VerifyImageResponse> response) {
+            {
+                std::lock_guard<std::mutex> write_lock(write_mutex);
+                if (!write_failed && !stream->Write(*response)) {
+                    write_failed = true;
+                }
+            }
+            // Notify under the lock: the handler frame may unwind as soon as
+            // the last response is accounted for
+            std::lock_guard<std::mutex> lock(mutex);
+            in_flight--;
+            slot_freed.notify_all();
+        };
+
+        while (!write_failed) {
+            // Stop reading while the window is full so HTTP/2 flow control
+            // pushes back on the client
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slot_freed.wait(lock, [&] { return in_flight < stages_.window; });
+            }
+
+            auto request = NewArenaRequest();
+            if (!stream->Read(request.get())) {
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                in_flight++;
+            }
+            if (!SubmitPipelined(stages_, std::move(request), complete, true, deadline)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                in_flight--;
+                break;
+            }
+        }
+
+        // Responses reference this frame, so wait for every one to be written
+        std::unique_lock<std::mutex> lock(mutex);
+        slot_freed.wait(lock, [&] { return in_flight == 0; });
+
+        return write_failed ? Status(StatusCode::CANCELLED, "Stream write failed")
+                            : Status::OK;
+    }
+
+    Status VerifyImageUpload(
+        ServerContext* context,
+        ServerReader<ImageChunk>* reader,
+        VerifyImageResponse* response
+    ) override {
+
+        if (!engine_.isReady()) {
+            response->set_success(false);
+            response->set_error_message("Engine not ready");
+            return Status::OK;
+        }
+
+        const RequestDeadline deadline = DeadlineOf(context);
+        ImageUpload upload = engine_.beginUpload();
+        std::string request_id;
+        bool first = true;
+
+        // One chunk buffer reused for the whole upload
+        ImageChunk chunk;
+        while (reader->Read(&chunk)) {
+            if (first) {
+                request_id = chunk.request_id();
+                first = false;
+            }
+            TraceScope scope(request_id);
+            const std::string& data = chunk.data();
+            if (!engine_.feed(upload, reinterpret_cast<const uint8_t*>(data.data()),
+                              data.size())) {
+                break;  // Undecodable; the rest cannot change that
+            }
+        }
+
+        return FinishUpload(engine_, upload, request_id, response, deadline);
     }
 
     Status CheckHealth(
@@ -94,17 +567,7 @@ public:
         const HealthRequest* request,
         HealthResponse* response
     ) override {
-        
-        auto stats = engine_.getStats();
-        auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::system_clock::now() - stats.start_time
-        );
-
-        response->set_healthy(engine_.isReady());
-        response->set_version(InferenceEngine::version());
-        response->set_uptime_seconds(uptime.count());
-        response->set_requests_processed(static_cast<int32_t>(stats.total_requests));
-
+        FillHealth(engine_, response);
         return Status::OK;
     }
 
@@ -113,40 +576,544 @@ public:
         const ModelInfoRequest* request,
         ModelInfoResponse* response
     ) override {
-        
-        response->set_model_name("ventus-scene-classifier");
-        response->set_model_version("1.0.0");
-        response->set_num_classes(static_cast<int32_t>(kOutdoorLabels.size()));
-        response->set_input_width(224);
-        response->set_input_height(224);
+        FillModelInfo(engine_, response);
+        return Status::OK;
+    }
+
+    Status DumpTrace(
+        ServerContext* context,
+        const DumpTraceRequest* request,
+        DumpTraceResponse* response
+    ) override {
+        FillTrace(*request, response);
+        return Status::OK;
+    }
+
+    Status ReloadModel(
+        ServerContext* context,
+        const ReloadModelRequest* request,
+        ModelInfoResponse* response
+    ) override {
+        return HandleReload(engine_, *request, response);
+    }
+
+private:
+    InferenceEngine& engine_;
+    StreamStages& stages_;
+};
+
+/**
+ * Callback service: network threads only admit requests; inference runs
+ * on the scheduler's workers and overload is rejected immediately.
+ */
+class AsyncVerificationServiceImpl final : public VerificationService::CallbackService {
+public:
+    AsyncVerificationServiceImpl(InferenceEngine& engine, RequestScheduler& scheduler,
+                                 StreamStages& stages)
+        : engine_(engine), scheduler_(scheduler), stages_(stages) {}
+
+    ServerUnaryReactor* VerifyImage(
+        CallbackServerContext* context,
+        const VerifyImageRequest* request,
+        VerifyImageResponse* response
+    ) override {
 
-        for (const auto& label : kOutdoorLabels) {
-            response->add_class_labels(label);
+        ServerUnaryReactor* reactor = context->DefaultReactor();
+
+        RequestDeadline deadline = DeadlineOf(context);
+        const auto queue_deadline = deadline.deadline();
+        bool admitted = scheduler_.trySubmit([this, request, response, reactor,
+                                              deadline = std::move(deadline),
+                                              enqueued_us = TraceRecorder::nowUs()] {
+            TraceQueueWait("rpc.queue", request->request_id(), enqueued_us);
+            reactor->Finish(HandleVerify(engine_, *request, response, deadline));
+        }, queue_deadline);
+
+        if (!admitted) {
+            reactor->Finish(kOverloaded);
         }
+        return reactor;
+    }
 
-        return Status::OK;
+    ServerBidiReactor<VerifyImageRequest, VerifyImageResponse>* VerifyImageStream(
+        CallbackServerContext* context
+    ) override {
+        return new StreamReactor(stages_, DeadlineOf(context));
+    }
+
+    ServerReadReactor<ImageChunk>* VerifyImageUpload(
+        CallbackServerContext* context,
+        VerifyImageResponse* response
+    ) override {
+        return new UploadReactor(stages_, response, DeadlineOf(context));
+    }
+
+    ServerUnaryReactor* CheckHealth(
+        CallbackServerContext* context,
+        const HealthRequest* request,
+        HealthResponse* response
+    ) override {
+        FillHealth(engine_, response);
+        ServerUnaryReactor* reactor = context->DefaultReactor();
+        reactor->Finish(Status::OK);
+        return reactor;
+    }
+
+    ServerUnaryReactor* GetModelInfo(
+        CallbackServerContext* context,
+        const ModelInfoRequest* request,
+        ModelInfoResponse* response
+    ) override {
+        FillModelInfo(engine_, response);
+        ServerUnaryReactor* reactor = context->DefaultReactor();
+        reactor->Finish(Status::OK);
+        return reactor;
+    }
+
+    ServerUnaryReactor* DumpTrace(
+        CallbackServerContext* context,
+        const DumpTraceRequest* request,
+        DumpTraceResponse* response
+    ) override {
+        FillTrace(*request, response);
+        ServerUnaryReactor* reactor = context->DefaultReactor();
+        reactor->Finish(Status::OK);
+        return reactor;
+    }
+
+    ServerUnaryReactor* ReloadModel(
+        CallbackServerContext* context,
+        const ReloadModelRequest* request,
+        ModelInfoResponse* response
+    ) override {
+        // Loading takes seconds, so keep it off the callback threads
+        ServerUnaryReactor* reactor = context->DefaultReactor();
+        bool admitted = scheduler_.trySubmit([this, request, response, reactor] {
+            reactor->Finish(HandleReload(engine_, *request, response));
+        });
+        if (!admitted) {
+            reactor->Finish(kOverloaded);
+        }
+        return reactor;
     }
 
 private:
-    InferenceEngine engine_;
+    /**
+     * Pipelined stream: keeps up to `window` requests in the stages and
+     * writes each response as soon as it completes, so responses may be
+     * out of order and are matched by request_id. Reading pauses while
+     * the window is full. If preprocessing cannot admit a request the
+     * stream drains and ends with RESOURCE_EXHAUSTED.
+     */
+    class StreamReactor final
+        : public ServerBidiReactor<VerifyImageRequest, VerifyImageResponse> {
+    public:
+        StreamReactor(StreamStages& stages, RequestDeadline deadline)
+            : stages_(stages), deadline_(std::move(deadline)) {
+            startRead();
+        }
+
+        void OnReadDone(bool ok) override {
+            bool read_next = false;
+            bool accept = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                reading_ = false;
+                if (!ok) {
+                    reads_done_ = true;
+                }
+                // After a failed write or rejected admission, drop late reads
+                accept = ok && !reads_done_;
+            }
+
+            if (accept) {
+                std::shared_ptr<const VerifyImageRequest> request = std::move(read_buffer_);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    in_flight_++;
+                }
+
+                bool admitted = SubmitPipelined(stages_, std::move(request),
+                    [this](std::unique_ptr<VerifyImageResponse> response) {
+                        onResponse(std::move(response));
+                    }, false, deadline_);
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!admitted) {
+                    in_flight_--;
+                    reads_done_ = true;
+                    status_ = kOverloaded;
+                } else if (in_flight_ < stages_.window) {
+                    reading_ = true;
+                    read_next = true;
+                }
+            }
+
+            if (read_next) {
+                startRead();
+            } else {
+                maybeFinish();
+            }
+        }
+
+        void OnWriteDone(bool ok) override {
+            VerifyImageResponse* next_write = nullptr;
+            bool read_next = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                write_queue_.pop_front();
+                in_flight_--;
+
+                if (!ok && !write_failed_) {
+                    write_failed_ = true;
+                    reads_done_ = true;
+                    status_ = Status(StatusCode::CANCELLED, "Stream write failed");
+                }
+                if (write_failed_) {
+                    // Drop completed responses; in-flight work still has to drain
+                    in_flight_ -= static_cast<int>(write_queue_.size());
+                    write_queue_.clear();
+                }
+
+                if (!write_queue_.empty()) {
+                    next_write = write_queue_.front().get();
+                } else {
+                    writing_ = false;
+                }
+                if (!reads_done_ && !reading_ && in_flight_ < stages_.window) {
+                    reading_ = true;
+                    read_next = true;
+                }
+            }
+
+            if (next_write) {
+                StartWrite(next_write);
+            }
+            if (read_next) {
+                startRead();
+            }
+            maybeFinish();
+        }
+
+        void OnDone() override { delete this; }
+
+    private:
+        StreamStages& stages_;
+        const RequestDeadline deadline_;  // The stream's, shared by every message
+        std::shared_ptr<VerifyImageRequest> read_buffer_;
+
+        std::mutex mutex_;
+        std::deque<std::unique_ptr<VerifyImageResponse>> write_queue_;
+        int in_flight_ = 0;  // Read but not yet written
+        bool reading_ = false;
+        bool writing_ = false;
+        bool reads_done_ = false;
+        bool write_failed_ = false;
+        bool finished_ = false;
+        Status status_ = Status::OK;
+
+        void startRead() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                reading_ = true;
+            }
+            read_buffer_ = NewArenaRequest();
+            StartRead(read_buffer_.get());
+        }
+
+        void onResponse(std::unique_ptr<VerifyImageResponse> response) {
+            VerifyImageResponse* to_write = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (write_failed_) {
+                    in_flight_--;
+                } else {
+                    write_queue_.push_back(std::move(response));
+                    if (!writing_) {
+                        writing_ = true;
+                        to_write = write_queue_.front().get();
+                    }
+                }
+            }
+
+            if (to_write) {
+                StartWrite(to_write);
+            } else {
+                maybeFinish();
+            }
+        }
+
+        void maybeFinish() {
+            Status status;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (finished_ || !reads_done_ || reading_ || writing_ || in_flight_ > 0) {
+                    return;
+                }
+                finished_ = true;
+                status = status_;
+            }
+            Finish(status);
+        }
+    };
+
+    /**
+     * Chunked upload: each chunk is decoded on a preprocessing worker and
+     * the next read starts once it has been consumed, so one chunk is in
+     * memory at a time and HTTP/2 flow control paces the client to the
+     * decoder. After the last chunk the image is preprocessed there and
+     * inferred on an inference worker.
+     */
+    class UploadReactor final : public ServerReadReactor<ImageChunk> {
+    public:
+        UploadReactor(StreamStages& stages, VerifyImageResponse* response,
+                      RequestDeadline deadline)
+            : stages_(stages), response_(response), deadline_(std::move(deadline)) {
+            if (!stages_.engine.isReady()) {
+                response_->set_success(false);
+                response_->set_error_message("Engine not ready");
+                Finish(Status::OK);
+                return;
+            }
+            // Admitted once for the whole upload: a half-received image is
+            // never dropped for a momentarily full queue, and HTTP/2 flow
+            // control paces the client while its chunks wait
+            if (!stages_.preprocess.tryReserve()) {
+                Finish(kOverloaded);
+                return;
+            }
+            upload_.emplace(stages_.engine.beginUpload());
+            StartRead(&chunk_);
+        }
+
+        void OnReadDone(bool ok) override {
+            bool queued = stages_.preprocess.submitReserved([this, ok] {
+                if (ok && feedChunk()) {
+                    StartRead(&chunk_);
+                } else {
+                    finishUpload();
+                }
+            }, deadline_.deadline());
+
+            if (!queued) {
+                stages_.preprocess.release();
+                Finish(Status(StatusCode::UNAVAILABLE, "Server shutting down"));
+            }
+        }
+
+        void OnDone() override { delete this; }
+
+    private:
+        StreamStages& stages_;
+        VerifyImageResponse* response_;
+        const RequestDeadline deadline_;
+        std::optional<ImageUpload> upload_;
+        ImageChunk chunk_;  // Reused for every read
+        std::string request_id_;
+        bool first_ = true;
+
+        /**
+         * @return false once the upload is undecodable
+         */
+        bool feedChunk() {
+            if (first_) {
+                request_id_ = chunk_.request_id();
+                first_ = false;
+            }
+            TraceScope scope(request_id_);
+            const std::string& data = chunk_.data();
+            return stages_.engine.feed(*upload_, reinterpret_cast<const uint8_t*>(data.data()),
+                                       data.size());
+        }
+
+        void finishUpload() {
+            auto prepared = std::make_shared<PreparedImage>();
+            {
+                TraceScope scope(request_id_);
+                *prepared = stages_.engine.prepare(*upload_, deadline_);
+            }
+            upload_.reset();  // Drop the decoder's buffers before inference
+            stages_.preprocess.release();
+
+            bool admitted = stages_.inference.submit([this, prepared,
+                                                      enqueued_us = TraceRecorder::nowUs()] {
+                TraceScope scope(request_id_);
+                TraceQueueWait("upload.inference_queue", request_id_, enqueued_us);
+                response_->set_request_id(request_id_);
+                auto result = stages_.engine.infer(*prepared, deadline_);
+                if (result.shed) {
+                    Finish(ShedStatus(result, deadline_));
+                    return;
+                }
+                PopulateResponse(result, response_, stages_.engine.stageMetrics());
+                Finish(Status::OK);
+            }, deadline_.deadline());
+
+            if (!admitted) {
+                Finish(Status(StatusCode::UNAVAILABLE, "Server shutting down"));
+            }
+        }
+    };
+
+    InferenceEngine& engine_;
+    RequestScheduler& scheduler_;
+    StreamStages& stages_;
 };
 
-void RunServer(const std::string& address, const InferenceEngine::Config& config) {
-    VerificationServiceImpl service(config);
+/**
+ * Choose num_threads, pool_size and max_batch_size by load-testing the
+ * scene model, or reuse a previous choice saved for the same model,
+ * delegate, latency target and host.
+ */
+void Autotune(InferenceEngine::Config& config, ServerOptions& options) {
+    Autotuner::Config tuner_config;
+    tuner_config.scene_model_path = config.scene_model_path;
+    tuner_config.delegate = config.delegate;
+    tuner_config.p99_target_ms = options.p99_target_ms;
+    tuner_config.seconds_per_trial = options.autotune_seconds;
+    tuner_config.max_batch_wait_us = config.max_batch_wait_us;
+    Autotuner tuner(tuner_config);
+
+    std::optional<Autotuner::Trial> choice;
+    if (!options.autotune_file.empty()) {
+        choice = tuner.load(options.autotune_file);
+        if (choice) {
+            std::cout << "Autotune: reusing " << options.autotune_file << std::endl;
+        }
+    }
+    if (!choice) {
+        std::cout << "Autotune: sweeping for p99 <= " << options.p99_target_ms << " ms"
+                  << std::endl;
+        Autotuner::Result result = tuner.run(&std::cout);
+        if (!result.met_target) {
+            std::cout << "Autotune: no candidate met the target, using the lowest p99"
+                      << std::endl;
+        }
+        choice = result.best;
+        if (!options.autotune_file.empty()) {
+            tuner.save(options.autotune_file, *choice);
+        }
+    }
+
+    config.num_threads = choice->num_threads;
+    config.pool_size = choice->pool_size;
+    config.max_batch_size = choice->max_batch_size;
+    // Batches only fill with enough requests in flight per interpreter
+    if (choice->max_batch_size > 1 && options.inference_workers == 0) {
+        options.inference_workers = choice->pool_size * choice->max_batch_size;
+    }
+    std::cout << "Autotune: threads=" << choice->num_threads << " pool="
+              << choice->pool_size << " batch=" << choice->max_batch_size << " ("
+              << choice->images_per_second << " img/s, p99 " << choice->p99_ms << " ms)"
+              << std::endl;
+}
+
+void RunServer(const std::string& address, const InferenceEngine::Config& config,
+               const ServerOptions& options) {
+    TraceRecorder::global().setEnabled(options.tracing);
+    InferenceEngine engine(config);
+
+    auto arena_bytes = engine.interpreterArenaBytes();
+    std::cout << "Scene interpreter pool: " << arena_bytes.size() << " interpreters";
+    for (size_t i = 0; i < arena_bytes.size(); ++i) {
+        std::cout << (i == 0 ? " (arena KB: " : ", ") << arena_bytes[i] / 1024;
+    }
+    std::cout << (arena_bytes.empty() ? "" : ")") << ", delegate "
+              << delegatePolicyName(config.delegate) << std::endl;
+    std::cout << "Threads: " << engine.threadTopology().describe() << std::endl;
+    for (const DelegateBenchmark& benchmark : engine.modelInfo().delegate_benchmarks) {
+        std::cout << "  " << delegatePolicyName(benchmark.policy) << ": ";
+        if (benchmark.error.empty()) {
+            std::cout << benchmark.invoke_ms << " ms/invoke" << std::endl;
+        } else {
+            std::cout << benchmark.error << std::endl;
+        }
+    }
 
     grpc::EnableDefaultHealthCheckService(true);
 
     ServerBuilder builder;
     builder.AddListeningPort(address, grpc::InsecureServerCredentials());
-    builder.RegisterService(&service);
 
     // Performance tuning
     builder.SetMaxReceiveMessageSize(10 * 1024 * 1024);  // 10MB for images
     builder.SetMaxSendMessageSize(1 * 1024 * 1024);      // 1MB responses
 
-    std::unique_ptr<Server> server(builder.BuildAndStart());
+    const int inference_workers = options.inference_workers > 0
+        ? options.inference_workers
+        : static_cast<int>(arena_bytes.size());
+
+    // Stage pools for pipelined streams, shared by every stream
+    const ThreadTopology& topology = engine.threadTopology();
+    std::vector<CpuSet> inference_cpus;
+    if (topology.pinned()) {
+        inference_cpus = topology.inferenceWorkerCpus();
+    }
+    RequestScheduler::Config preprocess_config;
+    preprocess_config.num_workers = topology.preprocessThreads();
+    preprocess_config.max_in_flight = options.max_in_flight;
+    if (topology.pinned()) {
+        preprocess_config.worker_cpus = {topology.preprocessCpus()};
+    }
+    RequestScheduler::Config inference_config;
+    inference_config.num_workers = inference_workers;
+    inference_config.max_in_flight = options.max_in_flight;
+    inference_config.worker_cpus = inference_cpus;
+    StreamStages stages(engine, preprocess_config, inference_config,
+                        std::max(1, options.stream_window));
+
+    std::unique_ptr<RequestScheduler> scheduler;
+    std::unique_ptr<grpc::Service> service;
+    ArenaMessageAllocator<VerifyImageRequest, VerifyImageResponse> verify_allocator;
+
+    if (options.async_mode) {
+        RequestScheduler::Config scheduler_config;
+        scheduler_config.num_workers = inference_workers;
+        scheduler_config.max_in_flight = options.max_in_flight;
+        scheduler_config.worker_cpus = inference_cpus;
+        scheduler = std::make_unique<RequestScheduler>(scheduler_config);
+        auto async_service = std::make_unique<AsyncVerificationServiceImpl>(
+            engine, *scheduler, stages);
+        async_service->SetMessageAllocatorFor_VerifyImage(&verify_allocator);
+        service = std::move(async_service);
+
+        std::cout << "Async mode: " << scheduler->numWorkers() << " inference workers, "
+                  << scheduler_config.max_in_flight << " max in-flight" << std::endl;
+    } else {
+        service = std::make_unique<VerificationServiceImpl>(engine, stages);
+
+        // Sync handlers run on gRPC's own threads, one per call. Beyond the
+        // interpreter count they only block on checkout, so cap them at the
+        // in-flight limit (plus a polling thread) rather than letting bursts
+        // spawn threads without bound; excess calls get RESOURCE_EXHAUSTED
+        // as they would from the async scheduler
+        grpc::ResourceQuota quota("ventus-sync");
+        quota.SetMaxThreads(std::max(inference_workers, options.max_in_flight) + 1);
+        builder.SetResourceQuota(quota);
+    }
+    builder.RegisterService(service.get());
+
+    // gRPC's threads inherit the CPUs of the thread that starts them; in
+    // sync mode those threads do the inference
+    std::unique_ptr<Server> server;
+    {
+        ScopedAffinity affinity(topology.pinned() && !options.async_mode
+                                    ? topology.inferenceCpus()
+                                    : CpuSet{});
+        server = builder.BuildAndStart();
+    }
     std::cout << "Ventus CV Engine listening on " << address << std::endl;
-    
+
+    std::unique_ptr<MetricsServer> metrics;
+    if (options.metrics_port > 0) {
+        MetricsServer::Config metrics_config;
+        metrics_config.port = options.metrics_port;
+        metrics = std::make_unique<MetricsServer>(
+            metrics_config, [&engine] { return RenderMetrics(engine); });
+        std::cout << "Metrics on http://" << metrics_config.bind_address << ":"
+                  << metrics->port() << "/metrics" << std::endl;
+    }
+
     server->Wait();
 }
 
@@ -155,13 +1122,16 @@ void RunServer(const std::string& address, const InferenceEngine::Config& config
 
 int main(int argc, char** argv) {
     std::string address = "0.0.0.0:50051";
-    
+
     ventus::InferenceEngine::Config config;
     config.scene_model_path = "models/scene_classifier.tflite";
+    config.face_model_path = "models/face_detector.tflite";
     config.num_threads = 4;
     config.outdoor_threshold = 0.6f;
     config.min_outdoor_labels = 2;
 
+    ventus::cv::ServerOptions options;
+
     // Parse command line args
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -169,13 +1139,66 @@ int main(int argc, char** argv) {
             address = "0.0.0.0:" + std::string(argv[++i]);
         } else if (arg == "--model" && i + 1 < argc) {
             config.scene_model_path = argv[++i];
+        } else if (arg == "--gate-model" && i + 1 < argc) {
+            config.gate_model_path = argv[++i];
+        } else if (arg == "--gate-band" && i + 2 < argc) {
+            config.gate_low = std::stof(argv[++i]);
+            config.gate_high = std::stof(argv[++i]);
+        } else if (arg == "--face-model" && i + 1 < argc) {
+            config.face_model_path = argv[++i];
         } else if (arg == "--threads" && i + 1 < argc) {
             config.num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--pool-size" && i + 1 < argc) {
+            config.pool_size = std::stoi(argv[++i]);
+        } else if (arg == "--max-batch" && i + 1 < argc) {
+            config.max_batch_size = std::stoi(argv[++i]);
+        } else if (arg == "--batch-wait-us" && i + 1 < argc) {
+            config.max_batch_wait_us = std::stoi(argv[++i]);
+        } else if (arg == "--cache-mb" && i + 1 < argc) {
+            config.cache_bytes = static_cast<size_t>(std::stoul(argv[++i])) << 20;
+        } else if (arg == "--delegate" && i + 1 < argc) {
+            config.delegate = ventus::parseDelegatePolicy(argv[++i]);
+        } else if (arg == "--benchmark-delegates") {
+            config.benchmark_delegates = true;
+        } else if (arg == "--parallel-models") {
+            config.parallel_models = true;
+        } else if (arg == "--early-cancel") {
+            config.early_cancel = true;
+        } else if (arg == "--stream-window" && i + 1 < argc) {
+            options.stream_window = std::stoi(argv[++i]);
+        } else if (arg == "--preprocess-workers" && i + 1 < argc) {
+            config.preprocess_threads = std::stoi(argv[++i]);
+        } else if (arg == "--opencv-threads" && i + 1 < argc) {
+            config.opencv_threads = std::stoi(argv[++i]);
+        } else if (arg == "--pin-threads") {
+            config.pin_threads = true;
+        } else if (arg == "--async") {
+            options.async_mode = true;
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.inference_workers = std::stoi(argv[++i]);
+        } else if (arg == "--max-inflight" && i + 1 < argc) {
+            options.max_in_flight = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            options.metrics_port = std::stoi(argv[++i]);
+        } else if (arg == "--no-trace") {
+            options.tracing = false;
+        } else if (arg == "--autotune") {
+            options.autotune = true;
+        } else if (arg == "--autotune-file" && i + 1 < argc) {
+            options.autotune = true;
+            options.autotune_file = argv[++i];
+        } else if (arg == "--p99-target-ms" && i + 1 < argc) {
+            options.p99_target_ms = std::stod(argv[++i]);
+        } else if (arg == "--autotune-seconds" && i + 1 < argc) {
+            options.autotune_seconds = std::stod(argv[++i]);
         }
     }
 
-    ventus::cv::RunServer(address, config);
-    
+    if (options.autotune) {
+        ventus::cv::Autotune(config, options);
+    }
+
+    ventus::cv::RunServer(address, config, options);
+
     return 0;
 }
-
@@ -0,0 +1,84 @@
+#include "stage_metrics.h"
+
+namespace ventus {
+
+namespace {
+
+// Prometheus bucket bounds in microseconds, from fast kernels to requests
+// that blew their budget
+constexpr int64_t kBucketBoundsUs[] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000,
+    25000, 50000, 100000, 250000, 500000, 1000000, 2500000
+};
+
+}  // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::kDecode: return "decode";
+        case Stage::kPreprocess: return "preprocess";
+        case Stage::kTensorCopy: return "tensor_copy";
+        case Stage::kInvoke: return "invoke";
+        case Stage::kPostprocess: return "postprocess";
+        case Stage::kFace: return "face";
+        case Stage::kResponseBuild: return "response_build";
+        case Stage::kRequest: return "request";
+        default: return "unknown";
+    }
+}
+
+void StageMetrics::record(Stage stage, int64_t us) {
+    histograms_[static_cast<int>(stage)].record(us);
+    updateTypical(static_cast<int>(stage), us);
+}
+
+void StageMetrics::record(const StageTimings& timings) {
+    for (int i = 0; i < kNumStages; ++i) {
+        if (timings.us[i] >= 0) {
+            histograms_[i].record(timings.us[i]);
+            updateTypical(i, timings.us[i]);
+        }
+    }
+}
+
+void StageMetrics::updateTypical(int stage, int64_t us) {
+    // Weight 1/16; racing updates may lose a sample, which an average
+    // does not notice
+    std::atomic<int64_t>& typical = typical_us_[stage];
+    const int64_t previous = typical.load(std::memory_order_relaxed);
+    typical.store(previous == 0 ? us : previous + (us - previous) / 16,
+                  std::memory_order_relaxed);
+}
+
+LatencyHistogram StageMetrics::snapshot(Stage stage) const {
+    return histograms_[static_cast<int>(stage)].snapshot();
+}
+
+void StageMetrics::writePrometheus(std::ostream& out) const {
+    out << "# HELP ventus_stage_duration_seconds Time spent in each request stage.\n"
+        << "# TYPE ventus_stage_duration_seconds histogram\n";
+    for (int i = 0; i < kNumStages; ++i) {
+        const char* name = stageName(static_cast<Stage>(i));
+        const LatencyHistogram histogram = histograms_[i].snapshot();
+        for (int64_t bound : kBucketBoundsUs) {
+            out << "ventus_stage_duration_seconds_bucket{stage=\"" << name << "\",le=\""
+                << bound / 1e6 << "\"} " << histogram.countAtOrBelow(bound) << "\n";
+        }
+        out << "ventus_stage_duration_seconds_bucket{stage=\"" << name << "\",le=\"+Inf\"} "
+            << histogram.count() << "\n"
+            << "ventus_stage_duration_seconds_sum{stage=\"" << name << "\"} "
+            << histogram.sum() / 1e6 << "\n"
+            << "ventus_stage_duration_seconds_count{stage=\"" << name << "\"} "
+            << histogram.count() << "\n";
+    }
+
+    out << "# HELP ventus_requests_shed_total Requests dropped before a stage because they "
+           "were cancelled or could not meet their deadline.\n"
+        << "# TYPE ventus_requests_shed_total counter\n";
+    for (int i = 0; i < kNumStages; ++i) {
+        out << "ventus_requests_shed_total{stage=\"" << stageName(static_cast<Stage>(i))
+            << "\"} " << shed_[i].load(std::memory_order_relaxed) << "\n";
+    }
+}
+
+}  // namespace ventus
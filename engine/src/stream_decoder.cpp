@@ -0,0 +1,429 @@
+#include "preprocessing.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <jpeglib.h>
+#include <jerror.h>
+
+namespace ventus {
+
+namespace {
+
+int scaleIndex(int scale_denom) {
+    return scale_denom == 8 ? 3 : scale_denom == 4 ? 2 : scale_denom == 2 ? 1 : 0;
+}
+
+// libjpeg reports fatal errors through error_exit, which must not return
+struct ErrorManager {
+    jpeg_error_mgr pub;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+void errorExit(j_common_ptr cinfo) {
+    ErrorManager* errors = reinterpret_cast<ErrorManager*>(cinfo->err);
+    (*cinfo->err->format_message)(cinfo, errors->message);
+    std::longjmp(errors->jump, 1);
+}
+
+void silenceMessage(j_common_ptr) {}
+
+/**
+ * Suspending source over the decoder's pending bytes. When libjpeg runs
+ * out it suspends and resumes from the same point once more bytes are
+ * fed; after the input is complete it gets a fake EOI instead, so a
+ * truncated image decodes as far as it goes.
+ */
+struct Source {
+    jpeg_source_mgr pub;
+    size_t skip = 0;   // Bytes libjpeg skipped past the end of the input so far
+    bool eof = false;  // No more bytes will arrive
+};
+
+const JOCTET kFakeEoi[] = {0xFF, JPEG_EOI};
+
+void initSource(j_decompress_ptr) {}
+
+boolean fillInputBuffer(j_decompress_ptr cinfo) {
+    Source* source = reinterpret_cast<Source*>(cinfo->src);
+    if (!source->eof) {
+        return FALSE;  // Suspend until feed()
+    }
+    WARNMS(cinfo, JWRN_JPEG_EOF);
+    source->pub.next_input_byte = kFakeEoi;
+    source->pub.bytes_in_buffer = sizeof(kFakeEoi);
+    return TRUE;
+}
+
+void skipInputData(j_decompress_ptr cinfo, long num_bytes) {
+    Source* source = reinterpret_cast<Source*>(cinfo->src);
+    if (num_bytes <= 0) {
+        return;
+    }
+    const size_t bytes = static_cast<size_t>(num_bytes);
+    if (bytes <= source->pub.bytes_in_buffer) {
+        source->pub.next_input_byte += bytes;
+        source->pub.bytes_in_buffer -= bytes;
+    } else {
+        // Rest of a large marker that has not arrived yet
+        source->skip += bytes - source->pub.bytes_in_buffer;
+        source->pub.next_input_byte += source->pub.bytes_in_buffer;
+        source->pub.bytes_in_buffer = 0;
+    }
+}
+
+void termSource(j_decompress_ptr) {}
+
+/**
+ * EXIF orientation (1-8) from a saved APP1 marker; 1 if absent.
+ */
+int exifOrientation(const jpeg_saved_marker_ptr markers) {
+    for (jpeg_saved_marker_ptr marker = markers; marker; marker = marker->next) {
+        const uint8_t* data = marker->data;
+        const size_t size = marker->data_length;
+        if (marker->marker != JPEG_APP0 + 1 || size < 14 ||
+            std::memcmp(data, "Exif\0\0", 6) != 0) {
+            continue;
+        }
+        const uint8_t* tiff = data + 6;
+        const size_t tiff_size = size - 6;
+        const bool little = tiff[0] == 'I' && tiff[1] == 'I';
+        if (!little && !(tiff[0] == 'M' && tiff[1] == 'M')) {
+            return 1;
+        }
+        auto u16 = [&](size_t at) -> uint32_t {
+            return little ? tiff[at] | (tiff[at + 1] << 8) : (tiff[at] << 8) | tiff[at + 1];
+        };
+        auto u32 = [&](size_t at) -> uint32_t {
+            return little ? u16(at) | (u16(at + 2) << 16) : (u16(at) << 16) | u16(at + 2);
+        };
+
+        // IFD0 entries are 12 bytes: tag, type, count, value
+        const size_t ifd = u32(4);
+        if (ifd + 2 > tiff_size) {
+            return 1;
+        }
+        const size_t entries = u16(ifd);
+        for (size_t i = 0; i < entries && ifd + 2 + 12 * (i + 1) <= tiff_size; ++i) {
+            const size_t entry = ifd + 2 + 12 * i;
+            if (u16(entry) == 0x0112) {
+                const uint32_t orientation = u16(entry + 8);
+                return orientation >= 1 && orientation <= 8 ? static_cast<int>(orientation) : 1;
+            }
+        }
+        return 1;
+    }
+    return 1;
+}
+
+// Matches what cv::imdecode does for the same EXIF tag
+void applyOrientation(cv::Mat& image, int orientation) {
+    switch (orientation) {
+        case 2: cv::flip(image, image, 1); break;
+        case 3: cv::rotate(image, image, cv::ROTATE_180); break;
+        case 4: cv::flip(image, image, 0); break;
+        case 5: cv::transpose(image, image); break;
+        case 6: cv::rotate(image, image, cv::ROTATE_90_CLOCKWISE); break;
+        case 7: cv::transpose(image, image); cv::flip(image, image, -1); break;
+        case 8: cv::rotate(image, image, cv::ROTATE_90_COUNTERCLOCKWISE); break;
+        default: break;
+    }
+}
+
+// Adobe CMYK JPEGs store inverted ink values
+void cmykToBgr(const cv::Mat& cmyk, cv::Mat& bgr) {
+    bgr.create(cmyk.rows, cmyk.cols, CV_8UC3);
+    for (int y = 0; y < cmyk.rows; ++y) {
+        const uint8_t* in = cmyk.ptr<uint8_t>(y);
+        uint8_t* out = bgr.ptr<uint8_t>(y);
+        for (int x = 0; x < cmyk.cols; ++x, in += 4, out += 3) {
+            const int k = in[3];
+            out[0] = static_cast<uint8_t>(in[2] * k / 255);
+            out[1] = static_cast<uint8_t>(in[1] * k / 255);
+            out[2] = static_cast<uint8_t>(in[0] * k / 255);
+        }
+    }
+}
+
+}  // namespace
+
+struct Preprocessor::StreamDecoder::State {
+    enum class Phase { kSniff, kHeader, kStart, kScanlines, kDone, kBuffered };
+
+    Preprocessor* preprocessor;
+    Phase phase = Phase::kSniff;
+    size_t received = 0;
+    int64_t decode_us = 0;
+    std::string error;  // Sticky; libjpeg cannot resume after error_exit
+
+    // Unconsumed JPEG bytes, or the whole input for other formats
+    std::vector<uint8_t> pending;
+
+    jpeg_decompress_struct cinfo;
+    ErrorManager errors;
+    Source source;
+    bool created = false;
+
+    int width = 0;
+    int height = 0;
+    int scale_denom = 1;
+    int orientation = 1;
+    bool cmyk = false;
+    cv::Mat image;
+
+    explicit State(Preprocessor& owner) : preprocessor(&owner) {}
+
+    ~State() {
+        if (created) {
+            jpeg_destroy_decompress(&cinfo);
+        }
+    }
+
+    void create() {
+        cinfo.err = jpeg_std_error(&errors.pub);
+        errors.pub.error_exit = errorExit;
+        errors.pub.output_message = silenceMessage;
+        if (setjmp(errors.jump)) {
+            throw std::runtime_error(std::string("Failed to decode image: ") + errors.message);
+        }
+        jpeg_create_decompress(&cinfo);
+        created = true;
+        cinfo.mem->max_memory_to_use = static_cast<long>(std::min<size_t>(
+            preprocessor->config_.max_stream_decode_bytes,
+            static_cast<size_t>(std::numeric_limits<long>::max())));
+
+        source.pub.init_source = initSource;
+        source.pub.fill_input_buffer = fillInputBuffer;
+        source.pub.skip_input_data = skipInputData;
+        source.pub.resync_to_restart = jpeg_resync_to_restart;
+        source.pub.term_source = termSource;
+        source.pub.next_input_byte = nullptr;
+        source.pub.bytes_in_buffer = 0;
+        cinfo.src = &source.pub;
+
+        // Keep EXIF so the orientation matches decode()
+        jpeg_save_markers(&cinfo, JPEG_APP0 + 1, 0xFFFF);
+    }
+
+    /**
+     * Append bytes behind whatever libjpeg has not consumed yet.
+     */
+    void append(const uint8_t* data, size_t size) {
+        const size_t skipped = std::min(source.skip, size);
+        source.skip -= skipped;
+        data += skipped;
+        size -= skipped;
+
+        pending.erase(pending.begin(),
+                      pending.end() - static_cast<std::ptrdiff_t>(source.pub.bytes_in_buffer));
+        pending.insert(pending.end(), data, data + size);
+        source.pub.next_input_byte = pending.data();
+        source.pub.bytes_in_buffer = pending.size();
+    }
+
+    /**
+     * Full-resolution coefficient buffer a multi-scan JPEG needs.
+     */
+    size_t coefficientBytes() const {
+        size_t bytes = 0;
+        for (int c = 0; c < cinfo.num_components; ++c) {
+            const jpeg_component_info& component = cinfo.comp_info[c];
+            bytes += static_cast<size_t>(component.width_in_blocks) *
+                     component.height_in_blocks * sizeof(JBLOCK);
+        }
+        return bytes;
+    }
+
+    /**
+     * Run libjpeg until it suspends for input or the image is complete.
+     * No object with a destructor may live across the setjmp.
+     */
+    void advance() {
+        if (setjmp(errors.jump)) {
+            error = std::string("Failed to decode image: ") + errors.message;
+            phase = Phase::kDone;
+            return;
+        }
+
+        if (phase == Phase::kHeader) {
+            if (jpeg_read_header(&cinfo, TRUE) == JPEG_SUSPENDED) {
+                return;
+            }
+            width = static_cast<int>(cinfo.image_width);
+            height = static_cast<int>(cinfo.image_height);
+            orientation = exifOrientation(cinfo.marker_list);
+            if (preprocessor->config_.scaled_decode) {
+                scale_denom = chooseScaleDenom(width, height,
+                                               preprocessor->config_.target_width,
+                                               preprocessor->config_.target_height);
+            }
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = static_cast<unsigned int>(scale_denom);
+            cmyk = cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK;
+            cinfo.out_color_space = cmyk ? JCS_CMYK : JCS_EXT_BGR;
+            if (jpeg_has_multiple_scans(&cinfo) &&
+                coefficientBytes() > preprocessor->config_.max_stream_decode_bytes) {
+                error = "Progressive JPEG too large to stream: " +
+                        std::to_string(width) + "x" + std::to_string(height);
+                phase = Phase::kDone;
+                return;
+            }
+            phase = Phase::kStart;
+        }
+
+        if (phase == Phase::kStart) {
+            // Progressive JPEGs suspend here until every scan has arrived,
+            // holding the whole image's coefficients
+            if (!jpeg_start_decompress(&cinfo)) {
+                return;
+            }
+            image.create(static_cast<int>(cinfo.output_height),
+                         static_cast<int>(cinfo.output_width), cmyk ? CV_8UC4 : CV_8UC3);
+            phase = Phase::kScanlines;
+        }
+
+        while (phase == Phase::kScanlines) {
+            if (cinfo.output_scanline >= cinfo.output_height) {
+                // Trailing bytes cannot change the pixels
+                jpeg_abort_decompress(&cinfo);
+                phase = Phase::kDone;
+                break;
+            }
+            JSAMPROW row = image.ptr<JSAMPLE>(static_cast<int>(cinfo.output_scanline));
+            if (jpeg_read_scanlines(&cinfo, &row, 1) == 0) {
+                return;
+            }
+        }
+    }
+
+    void timed(void (State::*step)()) {
+        auto start = std::chrono::steady_clock::now();
+        (this->*step)();
+        decode_us += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+Preprocessor::StreamDecoder::StreamDecoder(Preprocessor& preprocessor)
+    : state_(std::make_unique<State>(preprocessor)) {}
+
+Preprocessor::StreamDecoder::~StreamDecoder() = default;
+Preprocessor::StreamDecoder::StreamDecoder(StreamDecoder&&) noexcept = default;
+Preprocessor::StreamDecoder& Preprocessor::StreamDecoder::operator=(StreamDecoder&&) noexcept =
+    default;
+
+void Preprocessor::StreamDecoder::feed(const uint8_t* data, size_t size) {
+    State& state = *state_;
+    if (!state.error.empty()) {
+        throw std::runtime_error(state.error);
+    }
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max()) - state.received) {
+        state.error = "Image too large to decode";
+        throw std::runtime_error(state.error);
+    }
+    state.received += size;
+
+    switch (state.phase) {
+        case State::Phase::kSniff:
+            state.pending.insert(state.pending.end(), data, data + size);
+            if (state.pending.size() < 2) {
+                return;
+            }
+            if (state.pending[0] != 0xFF || state.pending[1] != 0xD8) {
+                state.phase = State::Phase::kBuffered;
+                return;
+            }
+            state.create();
+            state.source.pub.next_input_byte = state.pending.data();
+            state.source.pub.bytes_in_buffer = state.pending.size();
+            state.phase = State::Phase::kHeader;
+            break;
+        case State::Phase::kBuffered:
+            state.pending.insert(state.pending.end(), data, data + size);
+            return;
+        case State::Phase::kDone:
+            return;  // Trailing bytes after the last scanline
+        default:
+            state.append(data, size);
+            break;
+    }
+
+    TraceSpan span("preprocess.decode_chunk");
+    state.timed(&State::advance);
+    if (!state.error.empty()) {
+        throw std::runtime_error(state.error);
+    }
+}
+
+cv::Mat Preprocessor::StreamDecoder::finish(DecodeInfo* info) {
+    State& state = *state_;
+    if (!state.error.empty()) {
+        throw std::runtime_error(state.error);
+    }
+
+    // Not a JPEG, or too short to tell: decode the buffered bytes whole
+    if (state.phase == State::Phase::kSniff || state.phase == State::Phase::kBuffered) {
+        cv::Mat image = state.preprocessor->decode(state.pending.data(), state.pending.size(), info);
+        state.pending.clear();
+        state.pending.shrink_to_fit();
+        return image;
+    }
+
+    TraceSpan span("preprocess.decode_finish");
+    if (state.phase != State::Phase::kDone) {
+        state.source.eof = true;
+        state.timed(&State::advance);
+    }
+    if (!state.error.empty()) {
+        throw std::runtime_error(state.error);
+    }
+    if (state.phase != State::Phase::kDone || state.image.empty()) {
+        throw std::runtime_error("Failed to decode image");
+    }
+
+    auto convert_start = std::chrono::steady_clock::now();
+    cv::Mat image;
+    if (state.cmyk) {
+        cmykToBgr(state.image, image);
+    } else {
+        image = std::move(state.image);
+    }
+    applyOrientation(image, state.orientation);
+    state.decode_us += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - convert_start).count();
+
+    if (info) {
+        info->source_width = state.width;
+        info->source_height = state.height;
+        info->scale_denom = state.scale_denom;
+        info->decode_time_us = state.decode_us;
+        // The compressed bytes are gone, so reuse decode()'s calibration
+        const float ratio = state.preprocessor->full_decode_ratio_[scaleIndex(state.scale_denom)]
+            .load(std::memory_order_relaxed);
+        info->decode_time_saved_us = ratio > 1.0f
+            ? static_cast<int64_t>(state.decode_us * (ratio - 1.0f))
+            : 0;
+    }
+    state.pending.clear();
+    state.pending.shrink_to_fit();
+    return image;
+}
+
+size_t Preprocessor::StreamDecoder::bytesReceived() const {
+    return state_->received;
+}
+
+size_t Preprocessor::StreamDecoder::bytesBuffered() const {
+    return state_->phase == State::Phase::kSniff || state_->phase == State::Phase::kBuffered
+        ? state_->pending.size()
+        : state_->source.pub.bytes_in_buffer;
+}
+
+}  // namespace ventus
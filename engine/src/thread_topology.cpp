@@ -0,0 +1,296 @@
+#include "thread_topology.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cctype>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <thread>
+
+namespace ventus {
+
+namespace {
+
+std::string readFirstLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Directory entries named <prefix><number>, as numbers
+std::vector<int> numberedEntries(const std::string& dir, const std::string& prefix) {
+    std::vector<int> numbers;
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) {
+        return numbers;
+    }
+    while (dirent* entry = readdir(handle)) {
+        const std::string name = entry->d_name;
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            std::all_of(name.begin() + prefix.size(), name.end(), ::isdigit)) {
+            numbers.push_back(std::stoi(name.substr(prefix.size())));
+        }
+    }
+    closedir(handle);
+    std::sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+void appendCpuList(std::ostream& out, const CpuSet& cpus) {
+    // Collapse runs back into the kernel's range syntax
+    for (size_t i = 0; i < cpus.size();) {
+        size_t end = i;
+        while (end + 1 < cpus.size() && cpus[end + 1] == cpus[end] + 1) {
+            ++end;
+        }
+        out << (i == 0 ? "" : ",") << cpus[i];
+        if (end > i) {
+            out << '-' << cpus[end];
+        }
+        i = end + 1;
+    }
+}
+
+}  // namespace
+
+CpuSet parseCpuList(const std::string& list) {
+    CpuSet cpus;
+    std::stringstream ranges(list);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty()) {
+            continue;
+        }
+        const size_t dash = range.find('-');
+        try {
+            size_t parsed = 0;
+            const int first = std::stoi(range.substr(0, dash), &parsed);
+            if (parsed != (dash == std::string::npos ? range.size() : dash)) {
+                throw std::invalid_argument(range);
+            }
+            int last = first;
+            if (dash != std::string::npos) {
+                const std::string tail = range.substr(dash + 1);
+                last = std::stoi(tail, &parsed);
+                if (parsed != tail.size()) {
+                    throw std::invalid_argument(range);
+                }
+            }
+            if (first < 0 || last < first) {
+                throw std::invalid_argument(range);
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("Malformed CPU list: " + list);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+CpuTopology CpuTopology::detect() {
+    CpuSet allowed = currentThreadAffinity();
+    if (allowed.empty()) {
+        const int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; ++cpu) {
+            allowed.push_back(cpu);
+        }
+    }
+
+    CpuTopology topology;
+    const std::string node_dir = "/sys/devices/system/node";
+    for (int node : numberedEntries(node_dir, "node")) {
+        CpuSet node_cpus;
+        try {
+            node_cpus = parseCpuList(
+                readFirstLine(node_dir + "/node" + std::to_string(node) + "/cpulist"));
+        } catch (const std::invalid_argument&) {
+            continue;
+        }
+        CpuSet usable;
+        std::set_intersection(node_cpus.begin(), node_cpus.end(), allowed.begin(), allowed.end(),
+                              std::back_inserter(usable));
+        if (!usable.empty()) {
+            topology.nodes.push_back(std::move(usable));
+        }
+    }
+
+    // No sysfs, or it disagrees with the affinity mask
+    if (topology.cpuCount() != static_cast<int>(allowed.size())) {
+        topology.nodes = {allowed};
+    }
+    return topology;
+}
+
+CpuTopology CpuTopology::uniform(int nodes, int cpus_per_node) {
+    CpuTopology topology;
+    for (int node = 0; node < std::max(1, nodes); ++node) {
+        CpuSet cpus;
+        for (int i = 0; i < std::max(1, cpus_per_node); ++i) {
+            cpus.push_back(node * cpus_per_node + i);
+        }
+        topology.nodes.push_back(std::move(cpus));
+    }
+    return topology;
+}
+
+int CpuTopology::cpuCount() const {
+    int count = 0;
+    for (const CpuSet& node : nodes) {
+        count += static_cast<int>(node.size());
+    }
+    return count;
+}
+
+ThreadTopology::ThreadTopology(const CpuTopology& cpus, const Config& config)
+    : cpus_(cpus), config_(config) {
+    if (cpus_.cpuCount() == 0) {
+        throw std::invalid_argument("Thread topology needs at least one CPU");
+    }
+    const int total = cpus_.cpuCount();
+
+    // Preprocessing takes CPUs from the end of the last node, leaving whole
+    // nodes at the front for interpreter slices. A single CPU is shared.
+    std::vector<CpuSet> inference_nodes = cpus_.nodes;
+    if (total == 1) {
+        preprocess_cpus_ = inference_nodes.front();
+    } else {
+        int preprocess = config.preprocess_threads > 0 ? config.preprocess_threads
+                                                       : std::max(1, total / 4);
+        preprocess = std::min(preprocess, total - 1);
+        for (auto node = inference_nodes.rbegin(); preprocess > 0; ++node) {
+            while (preprocess > 0 && !node->empty()) {
+                preprocess_cpus_.push_back(node->back());
+                node->pop_back();
+                --preprocess;
+            }
+        }
+        std::sort(preprocess_cpus_.begin(), preprocess_cpus_.end());
+        inference_nodes.erase(std::remove_if(inference_nodes.begin(), inference_nodes.end(),
+                                             [](const CpuSet& node) { return node.empty(); }),
+                              inference_nodes.end());
+    }
+    for (const CpuSet& node : inference_nodes) {
+        inference_cpus_.insert(inference_cpus_.end(), node.begin(), node.end());
+    }
+    std::sort(inference_cpus_.begin(), inference_cpus_.end());
+
+    num_threads_ = std::clamp(config.num_threads, 1, static_cast<int>(inference_cpus_.size()));
+
+    // One slice per num_threads CPUs of a node; a slice larger than every
+    // node spans all inference CPUs instead
+    std::vector<const CpuSet*> slices;
+    for (const CpuSet& node : inference_nodes) {
+        for (size_t i = 0; i + num_threads_ <= node.size(); i += num_threads_) {
+            slices.push_back(&node);
+        }
+    }
+    if (slices.empty()) {
+        slices.push_back(&inference_cpus_);
+    }
+
+    pool_size_ = config.pool_size > 0 ? config.pool_size : static_cast<int>(slices.size());
+    worker_cpus_.reserve(pool_size_);
+    for (int i = 0; i < pool_size_; ++i) {
+        worker_cpus_.push_back(*slices[i % slices.size()]);
+    }
+}
+
+void ThreadTopology::applyOpenCv() const {
+    ::cv::setNumThreads(std::max(1, config_.opencv_threads));
+}
+
+std::string ThreadTopology::describe() const {
+    std::ostringstream out;
+    out << cpus_.cpuCount() << " CPUs on " << cpus_.nodes.size() << " NUMA node"
+        << (cpus_.nodes.size() == 1 ? "" : "s") << "; preprocess ";
+    appendCpuList(out, preprocess_cpus_);
+    out << ", inference ";
+    appendCpuList(out, inference_cpus_);
+    out << " (" << pool_size_ << " x " << num_threads_ << " threads); OpenCV "
+        << std::max(1, config_.opencv_threads) << " thread"
+        << (config_.opencv_threads > 1 ? "s" : "") << (config_.pin ? "; pinned" : "");
+    return out.str();
+}
+
+bool pinCurrentThread(const CpuSet& cpus) {
+    if (cpus.empty()) {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+CpuSet currentThreadAffinity() {
+    CpuSet cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        return cpus;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+ScopedAffinity::ScopedAffinity(const CpuSet& cpus) {
+    if (!cpus.empty()) {
+        previous_ = currentThreadAffinity();
+        active_ = pinCurrentThread(cpus);
+    }
+}
+
+ScopedAffinity::~ScopedAffinity() {
+    if (active_) {
+        pinCurrentThread(previous_);
+    }
+}
+
+SchedulerStats readSchedulerStats() {
+    SchedulerStats stats;
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        stats.voluntary_switches = usage.ru_nvcsw;
+        stats.involuntary_switches = usage.ru_nivcsw;
+        auto ns = [](const timeval& time) {
+            return static_cast<int64_t>(time.tv_sec) * 1000000000 +
+                   static_cast<int64_t>(time.tv_usec) * 1000;
+        };
+        stats.cpu_time_ns = ns(usage.ru_utime) + ns(usage.ru_stime);
+    }
+
+    // schedstat: nanoseconds on CPU, nanoseconds runnable on a run queue,
+    // timeslices run. Exited threads drop out of the run-queue total.
+    const std::string task_dir = "/proc/self/task";
+    for (int tid : numberedEntries(task_dir, "")) {
+        std::ifstream in(task_dir + "/" + std::to_string(tid) + "/schedstat");
+        int64_t cpu_ns = 0;
+        int64_t wait_ns = 0;
+        if (in >> cpu_ns >> wait_ns) {
+            stats.run_queue_wait_ns += wait_ns;
+            stats.threads++;
+        }
+    }
+    return stats;
+}
+
+}  // namespace ventus
@@ -0,0 +1,171 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+namespace ventus {
+
+namespace {
+
+thread_local std::string_view current_request_id;
+
+uint32_t threadNumber() {
+    static std::atomic<uint32_t> next_thread{1};
+    thread_local const uint32_t number = next_thread.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}  // namespace
+
+void writeJsonString(std::ostream& out, std::string_view value) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x",
+                                  static_cast<unsigned int>(static_cast<unsigned char>(c)));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+TraceRecorder::TraceRecorder(size_t capacity)
+    : slots_(roundUpToPowerOfTwo(std::max<size_t>(capacity, 1))),
+      mask_(slots_.size() - 1) {}
+
+TraceRecorder& TraceRecorder::global() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::record(const char* name, std::string_view request_id,
+                           int64_t start_us, int64_t duration_us) {
+    const uint64_t position = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[position & mask_];
+
+    // Claim the slot. If a writer from the previous lap still owns it, or
+    // one from the next lap already filled it, give up rather than wait.
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 || sequence > 2 * position ||
+        !slot.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                               std::memory_order_relaxed)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint64_t words[kRequestIdWords] = {};
+    if (!request_id.empty()) {
+        std::memcpy(words, request_id.data(), std::min(request_id.size(), kMaxRequestIdBytes));
+    }
+    for (size_t i = 0; i < kRequestIdWords; ++i) {
+        slot.request_id[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_us.store(start_us, std::memory_order_relaxed);
+    slot.duration_us.store(duration_us, std::memory_order_relaxed);
+    slot.thread_id.store(threadNumber(), std::memory_order_relaxed);
+
+    slot.sequence.store(2 * position + 2, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceRecorder::snapshot(std::string_view request_id,
+                                                size_t max_events) const {
+    const std::string_view filter = request_id.substr(0, kMaxRequestIdBytes);
+
+    // Read slots with their ring position so the result can be ordered
+    std::vector<std::pair<uint64_t, TraceEvent>> events;
+    events.reserve(slots_.size());
+    for (const Slot& slot : slots_) {
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1) != 0) {
+            continue;
+        }
+
+        uint64_t words[kRequestIdWords];
+        for (size_t i = 0; i < kRequestIdWords; ++i) {
+            words[i] = slot.request_id[i].load(std::memory_order_relaxed);
+        }
+        TraceEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.start_us = slot.start_us.load(std::memory_order_relaxed);
+        event.duration_us = slot.duration_us.load(std::memory_order_relaxed);
+        event.thread_id = slot.thread_id.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            continue;  // Overwritten while reading
+        }
+
+        const char* bytes = reinterpret_cast<const char*>(words);
+        event.request_id.assign(bytes, strnlen(bytes, kMaxRequestIdBytes));
+        if (!filter.empty() && event.request_id != filter) {
+            continue;
+        }
+        events.emplace_back(before / 2 - 1, std::move(event));
+    }
+
+    std::sort(events.begin(), events.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    const size_t first = max_events > 0 && events.size() > max_events
+        ? events.size() - max_events
+        : 0;
+    std::vector<TraceEvent> ordered;
+    ordered.reserve(events.size() - first);
+    for (size_t i = first; i < events.size(); ++i) {
+        ordered.push_back(std::move(events[i].second));
+    }
+    return ordered;
+}
+
+std::string TraceRecorder::toChromeJson(const std::vector<TraceEvent>& events) {
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(out, event.name);
+        out << ",\"cat\":\"ventus\",\"ph\":\"X\",\"ts\":" << event.start_us
+            << ",\"dur\":" << event.duration_us
+            << ",\"pid\":1,\"tid\":" << event.thread_id
+            << ",\"args\":{\"request_id\":";
+        writeJsonString(out, event.request_id);
+        out << "}}";
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+TraceScope::TraceScope(std::string_view request_id) : previous_(current_request_id) {
+    current_request_id = request_id;
+}
+
+TraceScope::~TraceScope() {
+    current_request_id = previous_;
+}
+
+std::string_view TraceScope::current() {
+    return current_request_id;
+}
+
+}  // namespace ventus
@@ -0,0 +1,159 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+
+namespace ventus {
+
+namespace {
+
+thread_local const WorkStealingPool* current_pool = nullptr;
+thread_local int current_worker = -1;
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(const Config& config) : config_(config) {
+    const int num_workers = std::max(1, config_.num_workers);
+    config_.max_in_flight = std::max(1, config_.max_in_flight);
+    queues_.reserve(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        queues_.push_back(std::make_unique<Worker>());
+    }
+    workers_.reserve(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    shutdown();
+}
+
+int WorkStealingPool::currentWorker() {
+    return current_worker;
+}
+
+bool WorkStealingPool::submit(std::function<void()> task) {
+    const bool from_worker = current_pool == this;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        int index = current_worker;
+        if (!from_worker) {
+            // Workers never wait here: a full pool could only drain through them
+            capacity_available_.wait(lock, [this] {
+                return stopping_ || in_flight_ < config_.max_in_flight;
+            });
+            if (stopping_) {
+                return false;
+            }
+            index = static_cast<int>(next_worker_++ % queues_.size());
+        }
+
+        // Publish under the same lock as the stopping_ check, so a worker
+        // deciding to exit on queued_ == 0 can never strand this task
+        {
+            std::lock_guard<std::mutex> queue_lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        }
+        queued_++;
+        in_flight_++;
+    }
+    work_available_.notify_one();
+    return true;
+}
+
+bool WorkStealingPool::take(int index, std::function<void()>& task) {
+    // Own deque newest first, while its data is still in cache
+    {
+        Worker& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Then the oldest task of the next worker that has one
+    const int count = static_cast<int>(queues_.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Worker& victim = *queues_[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen_++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    capacity_available_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+void WorkStealingPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    work_available_.notify_all();
+    capacity_available_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void WorkStealingPool::workerLoop(int index) {
+    if (!config_.worker_cpus.empty()) {
+        pinCurrentThread(config_.worker_cpus[index % config_.worker_cpus.size()]);
+    }
+    current_pool = this;
+    current_worker = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (!take(index, task)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_available_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+
+            // Drain remaining work before exiting so submitted tasks complete
+            if (queued_ == 0) {
+                return;
+            }
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_--;
+        }
+        task();
+        executed_++;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_--;
+        }
+        // Both submitters and wait() listen here
+        capacity_available_.notify_all();
+    }
+}
+
+WorkStealingPool::Stats WorkStealingPool::getStats() const {
+    Stats stats;
+    stats.executed = executed_.load();
+    stats.stolen = stolen_.load();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.in_flight = in_flight_;
+    return stats;
+}
+
+}  // namespace ventus
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "autotuner.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace ventus {
+namespace testing {
+
+class AutotunerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config_.scene_model_path = VENTUS_TEST_MODEL_DIR "/scene_float.tflite";
+        config_.thread_counts = {1};
+        config_.pool_sizes = {1, 2};
+        config_.batch_sizes = {1, 2};
+        config_.seconds_per_trial = 0.2;
+        path_ = ::testing::TempDir() + "autotune_test.txt";
+        std::remove(path_.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+
+    Autotuner::Config config_;
+    std::string path_;
+};
+
+TEST_F(AutotunerTest, SweepsEveryCandidate) {
+    Autotuner tuner(config_);
+    auto result = tuner.run();
+    ASSERT_EQ(result.trials.size(), 4u);
+    for (const auto& trial : result.trials) {
+        EXPECT_TRUE(trial.error.empty()) << trial.error;
+        EXPECT_GT(trial.images_per_second, 0.0);
+        EXPECT_LE(trial.p50_ms, trial.p99_ms);
+    }
+    EXPECT_GT(result.best.images_per_second, 0.0);
+}
+
+TEST_F(AutotunerTest, PicksLowestP99WhenTargetIsUnreachable) {
+    config_.p99_target_ms = 1e-6;
+    auto result = Autotuner(config_).run();
+    EXPECT_FALSE(result.met_target);
+    for (const auto& trial : result.trials) {
+        EXPECT_LE(result.best.p99_ms, trial.p99_ms);
+    }
+}
+
+TEST_F(AutotunerTest, SavedChoiceRoundTrips) {
+    Autotuner tuner(config_);
+    EXPECT_FALSE(tuner.load(path_).has_value());
+
+    Autotuner::Trial trial;
+    trial.num_threads = 2;
+    trial.pool_size = 3;
+    trial.max_batch_size = 4;
+    trial.images_per_second = 123.5;
+    trial.p99_ms = 7.25;
+    tuner.save(path_, trial);
+
+    auto loaded = tuner.load(path_);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->num_threads, 2);
+    EXPECT_EQ(loaded->pool_size, 3);
+    EXPECT_EQ(loaded->max_batch_size, 4);
+    EXPECT_DOUBLE_EQ(loaded->p99_ms, 7.25);
+}
+
+TEST_F(AutotunerTest, IgnoresChoiceTunedForAnotherModel) {
+    Autotuner::Trial trial;
+    Autotuner(config_).save(path_, trial);
+
+    config_.scene_model_path = VENTUS_TEST_MODEL_DIR "/scene_int8.tflite";
+    EXPECT_FALSE(Autotuner(config_).load(path_).has_value());
+
+    config_.scene_model_path = VENTUS_TEST_MODEL_DIR "/scene_float.tflite";
+    config_.p99_target_ms = 10.0;
+    EXPECT_FALSE(Autotuner(config_).load(path_).has_value());
+}
+
+TEST_F(AutotunerTest, IgnoresMalformedFile) {
+    Autotuner tuner(config_);
+    std::ofstream(path_) << "fingerprint=" << tuner.fingerprint() << "\nnum_threads=abc\n";
+    EXPECT_FALSE(tuner.load(path_).has_value());
+}
+
+}  // namespace testing
+}  // namespace ventus
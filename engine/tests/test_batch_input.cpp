@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "batch_input.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+// Builds ustar archives in memory
+class TarBuilder {
+public:
+    void add(const std::string& name, const std::string& data, char type = '0',
+             const std::string& prefix = "") {
+        char header[512] = {};
+        std::strncpy(header, name.c_str(), 100);
+        std::snprintf(header + 100, 8, "%07o", 0644);
+        std::snprintf(header + 124, 12, "%011o", static_cast<unsigned>(data.size()));
+        header[156] = type;
+        std::memcpy(header + 257, "ustar", 6);
+        std::memcpy(header + 263, "00", 2);
+        std::strncpy(header + 345, prefix.c_str(), 155);
+
+        std::memset(header + 148, ' ', 8);
+        unsigned sum = 0;
+        for (char c : header) {
+            sum += static_cast<unsigned char>(c);
+        }
+        std::snprintf(header + 148, 8, "%06o", sum);
+
+        bytes_.append(header, sizeof(header));
+        bytes_ += data;
+        bytes_.append((512 - data.size() % 512) % 512, '\0');
+    }
+
+    std::string finish() const {
+        return bytes_ + std::string(1024, '\0');
+    }
+
+private:
+    std::string bytes_;
+};
+
+class BatchInputTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        archive_ = ::testing::TempDir() + "batch_input_test.tar";
+        checkpoint_ = ::testing::TempDir() + "batch_input_test.checkpoint";
+        std::remove(checkpoint_.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(archive_.c_str());
+        std::remove(checkpoint_.c_str());
+    }
+
+    void writeArchive(const std::string& bytes) {
+        std::ofstream(archive_, std::ios::binary) << bytes;
+    }
+
+    // Names of every regular member, reading the contents of each
+    std::vector<std::string> readAll() {
+        TarReader reader(archive_);
+        std::vector<std::string> names;
+        std::string name;
+        while (reader.next(&name)) {
+            reader.read();
+            names.push_back(name);
+        }
+        return names;
+    }
+
+    std::string archive_;
+    std::string checkpoint_;
+};
+
+TEST_F(BatchInputTest, ReadsRegularMembersInOrder) {
+    TarBuilder tar;
+    tar.add("a.jpg", "first");
+    tar.add("photos", "", '5');
+    tar.add("b.jpg", std::string(600, 'b'), '0', "photos");
+    tar.add("c.jpg", "third");
+    writeArchive(tar.finish());
+
+    TarReader reader(archive_);
+    std::string name;
+    ASSERT_TRUE(reader.next(&name));
+    EXPECT_EQ(name, "a.jpg");
+    auto bytes = reader.read();
+    EXPECT_EQ(std::string(bytes.begin(), bytes.end()), "first");
+
+    // Unread contents are skipped, and the ustar prefix joins the name
+    ASSERT_TRUE(reader.next(&name));
+    EXPECT_EQ(name, "photos/b.jpg");
+    ASSERT_TRUE(reader.next(&name));
+    EXPECT_EQ(name, "c.jpg");
+    bytes = reader.read();
+    EXPECT_EQ(std::string(bytes.begin(), bytes.end()), "third");
+    EXPECT_FALSE(reader.next(&name));
+}
+
+TEST_F(BatchInputTest, AppliesGnuLongNames) {
+    const std::string long_name(150, 'n');
+    TarBuilder tar;
+    tar.add("././@LongLink", long_name + '\0', 'L');
+    tar.add("truncated", "data");
+    writeArchive(tar.finish());
+
+    EXPECT_EQ(readAll(), std::vector<std::string>{long_name});
+}
+
+TEST_F(BatchInputTest, RejectsBadHeaderChecksum) {
+    TarBuilder tar;
+    tar.add("a.jpg", "first");
+    std::string bytes = tar.finish();
+    bytes[0] = 'b';
+    writeArchive(bytes);
+
+    EXPECT_THROW(readAll(), std::runtime_error);
+}
+
+TEST_F(BatchInputTest, ReportsTruncatedArchive) {
+    TarBuilder tar;
+    tar.add("a.jpg", "first");
+    tar.add("b.jpg", std::string(2000, 'b'));
+    const std::string bytes = tar.finish();
+
+    // Inside the second member's data
+    writeArchive(bytes.substr(0, 1024 + 512 + 1000));
+    EXPECT_THROW(readAll(), std::runtime_error);
+
+    // Inside the second header
+    writeArchive(bytes.substr(0, 1024 + 100));
+    EXPECT_THROW(readAll(), std::runtime_error);
+
+    // Without the end-of-archive blocks every member is still there
+    writeArchive(bytes.substr(0, bytes.size() - 1024));
+    EXPECT_EQ(readAll(), (std::vector<std::string>{"a.jpg", "b.jpg"}));
+}
+
+TEST_F(BatchInputTest, CheckpointResumesPastFinishedMembers) {
+    TarBuilder tar;
+    tar.add("a.jpg", "first");
+    tar.add("b.jpg", "second");
+    tar.add("c.jpg", "third");
+    writeArchive(tar.finish());
+
+    // First run finishes the first two members
+    {
+        BatchCheckpoint checkpoint(checkpoint_, "model-1");
+        EXPECT_TRUE(checkpoint.enabled());
+        EXPECT_EQ(checkpoint.size(), 0u);
+        checkpoint.commit({BatchCheckpoint::key(archive_ + ":a.jpg"),
+                           BatchCheckpoint::key(archive_ + ":b.jpg")});
+    }
+
+    BatchCheckpoint resumed(checkpoint_, "model-1");
+    EXPECT_EQ(resumed.size(), 2u);
+    TarReader reader(archive_);
+    std::vector<std::string> remaining;
+    std::string name;
+    while (reader.next(&name)) {
+        if (!resumed.contains(BatchCheckpoint::key(archive_ + ":" + name))) {
+            remaining.push_back(name);
+        }
+    }
+    EXPECT_EQ(remaining, std::vector<std::string>{"c.jpg"});
+
+    EXPECT_THROW(BatchCheckpoint(checkpoint_, "model-2"), std::runtime_error);
+}
+
+TEST_F(BatchInputTest, EmptyCheckpointPathDisablesCheckpointing) {
+    BatchCheckpoint checkpoint("", "model-1");
+    EXPECT_FALSE(checkpoint.enabled());
+    EXPECT_FALSE(checkpoint.contains(BatchCheckpoint::key("a.jpg")));
+}
+
+}  // namespace testing
+}  // namespace ventus
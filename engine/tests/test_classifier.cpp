@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
+#include "micro_batcher.h"
+#include "preprocessing.h"
 #include "scene_classifier.h"
+#include <algorithm>
+#include <thread>
 
 namespace ventus {
 namespace testing {
@@ -28,29 +32,56 @@ TEST_F(SceneClassifierTest, ConfigDefaultsAreReasonable) {
     SceneClassifier::Config config;
     
     EXPECT_EQ(config.num_threads, 4);
-    EXPECT_FALSE(config.use_gpu);
+    EXPECT_EQ(config.delegate, DelegatePolicy::kXnnpack);
     EXPECT_FLOAT_EQ(config.outdoor_threshold, 0.6f);
     EXPECT_EQ(config.top_k, 5);
+    EXPECT_EQ(config.pool_size, 1);
+    EXPECT_TRUE(config.gate_model_path.empty());
+    EXPECT_LT(config.gate_low, config.gate_high);
 }
 
-// Integration tests (require model file)
+TEST_F(SceneClassifierTest, LabelIdsResolveToText) {
+    EXPECT_EQ(sceneLabelName(0), "sky");
+    EXPECT_EQ(sceneLabelName(static_cast<int>(kOutdoorLabels.size())), "indoor");
+    EXPECT_THROW(sceneLabelName(-1), std::out_of_range);
+}
+
+TEST_F(SceneClassifierTest, DelegatePolicyNamesRoundTrip) {
+    for (DelegatePolicy policy : {DelegatePolicy::kXnnpack, DelegatePolicy::kBuiltin,
+                                  DelegatePolicy::kMinimal}) {
+        EXPECT_EQ(parseDelegatePolicy(delegatePolicyName(policy)), policy);
+    }
+    EXPECT_THROW(parseDelegatePolicy("gpu"), std::invalid_argument);
+}
+
+TEST_F(SceneClassifierTest, TensorFormatDefaultsToFloat) {
+    TensorFormat format;
+    
+    EXPECT_FALSE(format.isQuantized());
+    EXPECT_EQ(format.elementSize(), sizeof(float));
+    
+    format.type = TensorType::kInt8;
+    EXPECT_TRUE(format.isQuantized());
+    EXPECT_EQ(format.elementSize(), 1u);
+}
+
+// Integration tests, run against the synthetic models generated at build time
 class SceneClassifierIntegrationTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        config_.model_path = "models/scene_classifier.tflite";
+        config_.model_path = VENTUS_TEST_MODEL_DIR "/scene_float.tflite";
         config_.num_threads = 2;
     }
 
     SceneClassifier::Config config_;
 };
 
-TEST_F(SceneClassifierIntegrationTest, DISABLED_LoadsModelSuccessfully) {
-    // Disabled by default - enable when model file is available
+TEST_F(SceneClassifierIntegrationTest, LoadsModelSuccessfully) {
     SceneClassifier classifier(config_);
     EXPECT_TRUE(classifier.isReady());
 }
 
-TEST_F(SceneClassifierIntegrationTest, DISABLED_ClassifiesOutdoorScene) {
+TEST_F(SceneClassifierIntegrationTest, ClassifiesOutdoorScene) {
     SceneClassifier classifier(config_);
     
     // Create synthetic "outdoor-like" input tensor
@@ -62,7 +93,7 @@ TEST_F(SceneClassifierIntegrationTest, DISABLED_ClassifiesOutdoorScene) {
     EXPECT_GE(result.inference_time_ms, 0);
 }
 
-TEST_F(SceneClassifierIntegrationTest, DISABLED_ReturnsTopKPredictions) {
+TEST_F(SceneClassifierIntegrationTest, ReturnsTopKPredictions) {
     SceneClassifier classifier(config_);
     std::vector<float> input(224 * 224 * 3, 0.5f);
     
@@ -71,6 +102,231 @@ TEST_F(SceneClassifierIntegrationTest, DISABLED_ReturnsTopKPredictions) {
     EXPECT_LE(result.predictions.size(), static_cast<size_t>(config_.top_k));
 }
 
+TEST_F(SceneClassifierIntegrationTest, PoolHandsOutDistinctInterpreters) {
+    config_.pool_size = 3;
+    SceneClassifier classifier(config_);
+    EXPECT_EQ(classifier.poolSize(), 3);
+
+    auto first = classifier.checkout();
+    auto second = classifier.checkout();
+    EXPECT_NE(first.slot(), second.slot());
+
+    classifier.checkin(first);
+    EXPECT_FALSE(first);
+
+    // Moving hands the interpreter over; the source is left empty
+    auto moved = std::move(second);
+    EXPECT_FALSE(second);
+    EXPECT_TRUE(moved);
+    std::vector<float> input(224 * 224 * 3, 0.5f);
+    EXPECT_THROW(classifier.classify(input, second), std::invalid_argument);
+    EXPECT_FALSE(classifier.classify(input, moved).predictions.empty());
+
+    auto arena_bytes = classifier.interpreterArenaBytes();
+    ASSERT_EQ(arena_bytes.size(), 3u);
+    for (size_t bytes : arena_bytes) {
+        EXPECT_GT(bytes, 0u);
+    }
+}
+
+TEST_F(SceneClassifierIntegrationTest, BatchMatchesSingleImage) {
+    SceneClassifier classifier(config_);
+    std::vector<float> first(224 * 224 * 3, 0.5f);
+    std::vector<float> second(224 * 224 * 3, -0.5f);
+
+    auto expected = classifier.classify(second);
+
+    const float* inputs[] = {first.data(), second.data()};
+    auto lease = classifier.checkout();
+    auto results = classifier.classifyBatch(inputs, 2, lease);
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_NEAR(results[1].outdoor_score, expected.outdoor_score, 1e-4f);
+}
+
+TEST_F(SceneClassifierIntegrationTest, PaddedBatchesMatchSingleImage) {
+    SceneClassifier single(config_);
+    config_.max_batch_size = 8;
+    SceneClassifier padded(config_);
+    std::vector<float> first(224 * 224 * 3, 0.5f);
+    std::vector<float> second(224 * 224 * 3, -0.5f);
+    std::vector<float> third(224 * 224 * 3, 0.25f);
+
+    auto expected = single.classify(third);
+
+    // Three images run as a batch of four; the single image that follows
+    // reuses that shape with the stale rows zeroed
+    auto lease = padded.checkout();
+    const float* batch[] = {first.data(), second.data(), third.data()};
+    auto results = padded.classifyBatch(batch, 3, lease);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_NEAR(results[2].outdoor_score, expected.outdoor_score, 1e-4f);
+
+    const float* alone[] = {third.data()};
+    results = padded.classifyBatch(alone, 1, lease);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_NEAR(results[0].outdoor_score, expected.outdoor_score, 1e-4f);
+
+    std::copy(third.begin(), third.end(), static_cast<float*>(padded.inputTensor(lease)));
+    auto in_place = padded.classifyInPlace(lease);
+    EXPECT_NEAR(in_place.outdoor_score, expected.outdoor_score, 1e-4f);
+}
+
+TEST_F(SceneClassifierIntegrationTest, ArenaBytesFollowBatchResizes) {
+    config_.max_batch_size = 8;
+    SceneClassifier classifier(config_);
+    const size_t single = classifier.interpreterArenaBytes()[0];
+    EXPECT_GT(single, 0u);
+
+    std::vector<float> input(224 * 224 * 3, 0.5f);
+    const float* batch[] = {input.data(), input.data(), input.data(), input.data()};
+    auto lease = classifier.checkout();
+    classifier.classifyBatch(batch, 4, lease);
+
+    // Four input images alone take more than the whole batch-1 arena
+    EXPECT_GE(classifier.interpreterArenaBytes()[0],
+              single + 3 * classifier.inputBytes());
+}
+
+TEST_F(SceneClassifierIntegrationTest, MicroBatcherFansOutResults) {
+    config_.pool_size = 2;
+    SceneClassifier classifier(config_);
+
+    MicroBatcher::Config batch_config;
+    batch_config.max_batch_size = 4;
+    batch_config.max_wait_us = 50000;
+    MicroBatcher batcher(classifier, batch_config);
+
+    std::vector<float> input(224 * 224 * 3, 0.5f);
+    std::vector<std::thread> callers;
+    std::vector<ClassificationResult> results(4);
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&, i] { results[i] = batcher.classify(input); });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    for (const auto& result : results) {
+        EXPECT_FALSE(result.predictions.empty());
+    }
+    EXPECT_EQ(batcher.getStats().images, 4);
+    EXPECT_LE(batcher.getStats().batches, 4);
+}
+
+TEST_F(SceneClassifierIntegrationTest, GateDecidesOrEscalates) {
+    SceneClassifier plain(config_);
+
+    // The full model as its own gate with an all-covering band always escalates
+    config_.gate_model_path = config_.model_path;
+    config_.gate_low = -1.0f;
+    config_.gate_high = 2.0f;
+    SceneClassifier escalating(config_);
+    EXPECT_TRUE(escalating.hasGate());
+
+    std::vector<float> input(224 * 224 * 3, 0.5f);
+    auto expected = plain.classify(input);
+    auto escalated = escalating.classify(input);
+    EXPECT_EQ(escalated.gate_decision, GateDecision::kEscalated);
+    EXPECT_NEAR(escalated.outdoor_score, expected.outdoor_score, 1e-4f);
+    EXPECT_NEAR(escalated.gate_score, expected.outdoor_score, 1e-4f);
+
+    // An empty band lets the gate decide every image
+    config_.gate_low = 0.5f;
+    config_.gate_high = 0.5f + 1e-6f;
+    SceneClassifier gated(config_);
+    auto decided = gated.classify(input);
+    EXPECT_NE(decided.gate_decision, GateDecision::kEscalated);
+    EXPECT_EQ(decided.is_outdoor, expected.is_outdoor);
+}
+
+TEST_F(SceneClassifierIntegrationTest, GateRunsWholeBatchAndEscalatesSome) {
+    SceneClassifier plain(config_);
+    std::vector<float> low(224 * 224 * 3, -0.5f);
+    std::vector<float> middle(224 * 224 * 3, 0.25f);
+    std::vector<float> high(224 * 224 * 3, 0.5f);
+    const float* inputs[] = {high.data(), middle.data(), low.data()};
+    auto lease = plain.checkout();
+    auto expected = plain.classifyBatch(inputs, 3, lease);
+    std::vector<float> scores;
+    for (const auto& result : expected) {
+        scores.push_back(result.outdoor_score);
+    }
+    std::sort(scores.begin(), scores.end());
+    ASSERT_LT(scores[0], scores[1]);
+    ASSERT_LT(scores[1], scores[2]);
+
+    // A band around the middle score escalates exactly one image
+    config_.gate_model_path = config_.model_path;
+    config_.gate_low = (scores[0] + scores[1]) / 2;
+    config_.gate_high = (scores[1] + scores[2]) / 2;
+    config_.max_batch_size = 4;
+    SceneClassifier gated(config_);
+    auto gated_lease = gated.checkout();
+    auto results = gated.classifyBatch(inputs, 3, gated_lease);
+
+    ASSERT_EQ(results.size(), 3u);
+    int escalated = 0;
+    for (int b = 0; b < 3; ++b) {
+        EXPECT_NEAR(results[b].gate_score, expected[b].outdoor_score, 1e-4f);
+        EXPECT_NEAR(results[b].outdoor_score, expected[b].outdoor_score, 1e-4f);
+        escalated += results[b].gate_decision == GateDecision::kEscalated;
+    }
+    EXPECT_EQ(escalated, 1);
+}
+
+TEST_F(SceneClassifierIntegrationTest, QuantizedModelTracksFloat) {
+    SceneClassifier float_classifier(config_);
+    config_.model_path = VENTUS_TEST_MODEL_DIR "/scene_int8.tflite";
+    SceneClassifier int8_classifier(config_);
+    ASSERT_EQ(int8_classifier.inputFormat().type, TensorType::kInt8);
+
+    // The same image preprocessed for each model's input format
+    cv::Mat image(480, 640, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+    Preprocessor float_preprocessor;
+    Preprocessor::Config int8_config;
+    int8_config.input_format = int8_classifier.inputFormat();
+    Preprocessor int8_preprocessor(int8_config);
+
+    std::vector<uint8_t> float_input(float_preprocessor.tensorBytes());
+    std::vector<uint8_t> int8_input(int8_preprocessor.tensorBytes());
+    float_preprocessor.processInto(image, float_input.data());
+    int8_preprocessor.processInto(image, int8_input.data());
+
+    auto expected = float_classifier.classify(float_input);
+    auto quantized = int8_classifier.classify(int8_input);
+    ASSERT_EQ(quantized.predictions.size(), expected.predictions.size());
+    EXPECT_NEAR(quantized.outdoor_score, expected.outdoor_score, 0.05f);
+}
+
+TEST_F(SceneClassifierIntegrationTest, DelegatePoliciesAgree) {
+    std::vector<float> input(224 * 224 * 3, 0.5f);
+    config_.delegate = DelegatePolicy::kBuiltin;
+    auto expected = SceneClassifier(config_).classify(input);
+
+    // XNNPACK may reassociate float math, so allow a little drift
+    for (DelegatePolicy policy : {DelegatePolicy::kXnnpack, DelegatePolicy::kMinimal}) {
+        config_.delegate = policy;
+        config_.pool_size = 2;
+        SceneClassifier classifier(config_);
+        EXPECT_EQ(classifier.delegatePolicy(), policy);
+        auto result = classifier.classify(input);
+        EXPECT_NEAR(result.outdoor_score, expected.outdoor_score, 1e-3f)
+            << delegatePolicyName(policy);
+    }
+}
+
+TEST_F(SceneClassifierIntegrationTest, BenchmarksEveryDelegatePolicy) {
+    SceneClassifier classifier(config_);
+    auto benchmarks = classifier.benchmarkDelegates(2);
+    ASSERT_EQ(benchmarks.size(), 3u);
+    for (const DelegateBenchmark& benchmark : benchmarks) {
+        EXPECT_TRUE(benchmark.error.empty()) << benchmark.error;
+        EXPECT_GT(benchmark.invoke_ms, 0.0);
+    }
+}
+
 }  // namespace testing
 }  // namespace ventus
 
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "face_decode.h"
+#include <cmath>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+namespace {
+
+constexpr int kInputSize = 128;
+constexpr int kBoxStride = 16;
+
+// Raw outputs where no anchor reports a face until one is set
+struct RawOutputs {
+    std::vector<float> boxes = std::vector<float>(kFaceAnchors * kBoxStride, 0.0f);
+    std::vector<float> scores = std::vector<float>(kFaceAnchors, -10.0f);
+
+    void set(int anchor, float dx, float dy, float w, float h, float logit) {
+        float* r = &boxes[anchor * kBoxStride];
+        r[0] = dx;
+        r[1] = dy;
+        r[2] = w;
+        r[3] = h;
+        scores[anchor] = logit;
+    }
+};
+
+float sigmoid(float x) {
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+}  // namespace
+
+TEST(FaceDecodeTest, AnchorsFollowBlazeFaceLayout) {
+    FaceAnchors anchors = blazeFaceAnchors(kInputSize, kInputSize);
+    ASSERT_EQ(anchors.x.size(), static_cast<size_t>(kFaceAnchors));
+
+    // Stride 8: two anchors per cell of the 16x16 grid
+    EXPECT_FLOAT_EQ(anchors.x[0], 0.5f / 16);
+    EXPECT_FLOAT_EQ(anchors.x[1], 0.5f / 16);
+    EXPECT_FLOAT_EQ(anchors.x[2], 1.5f / 16);
+    EXPECT_FLOAT_EQ(anchors.y[32], 1.5f / 16);
+
+    // Stride 16: six anchors per cell of the 8x8 grid
+    EXPECT_FLOAT_EQ(anchors.x[512], 0.5f / 8);
+    EXPECT_FLOAT_EQ(anchors.x[518], 1.5f / 8);
+    EXPECT_FLOAT_EQ(anchors.y[895], 7.5f / 8);
+
+    EXPECT_THROW(blazeFaceAnchors(96, 96), std::runtime_error);
+}
+
+TEST(FaceDecodeTest, AnchorHitMapsToNormalizedBox) {
+    FaceAnchors anchors = blazeFaceAnchors(kInputSize, kInputSize);
+    RawOutputs raw;
+
+    // Anchor 272 is cell (8, 8) of the stride-8 grid, centered at 0.53125;
+    // regressors are in input pixels
+    raw.set(272, 6.4f, -12.8f, 32.0f, 16.0f, 2.0f);
+    auto candidates = decodeFaceCandidates(raw.boxes.data(), kBoxStride, raw.scores.data(),
+                                           anchors, kInputSize, kInputSize, 0.5f);
+    ASSERT_EQ(candidates.size(), 1u);
+    EXPECT_FLOAT_EQ(candidates[0].score, sigmoid(2.0f));
+
+    auto faces = mergeFaceDetections(candidates, FaceLetterbox{}, 0.3f, 8);
+    ASSERT_EQ(faces.size(), 1u);
+    EXPECT_NEAR(faces[0].x, 0.45625f, 1e-6f);
+    EXPECT_NEAR(faces[0].y, 0.36875f, 1e-6f);
+    EXPECT_NEAR(faces[0].width, 0.25f, 1e-6f);
+    EXPECT_NEAR(faces[0].height, 0.125f, 1e-6f);
+    EXPECT_FLOAT_EQ(faces[0].confidence, sigmoid(2.0f));
+}
+
+TEST(FaceDecodeTest, UndoesLetterbox) {
+    // A 4:3 image fills the width and is padded 16 px top and bottom
+    FaceLetterbox letterbox;
+    letterbox.offset_y = 16.0f / kInputSize;
+    letterbox.scale_y = static_cast<float>(kInputSize) / 96;
+
+    auto faces = mergeFaceDetections({{0.25f, 0.2f, 0.75f, 0.55f, 0.9f}}, letterbox, 0.3f, 8);
+    ASSERT_EQ(faces.size(), 1u);
+    EXPECT_NEAR(faces[0].x, 0.25f, 1e-6f);
+    EXPECT_NEAR(faces[0].width, 0.5f, 1e-6f);
+    EXPECT_NEAR(faces[0].y, 0.1f, 1e-6f);
+    EXPECT_NEAR(faces[0].height, 0.35f * 4 / 3, 1e-6f);
+}
+
+TEST(FaceDecodeTest, MergesOverlapsWeightedByScore) {
+    // Given out of order: merging starts from the strongest box
+    std::vector<FaceDetection> candidates = {
+        {0.12f, 0.1f, 0.32f, 0.3f, 0.6f},
+        {0.6f, 0.6f, 0.8f, 0.8f, 0.7f},
+        {0.1f, 0.1f, 0.3f, 0.3f, 0.9f},
+    };
+
+    auto faces = mergeFaceDetections(candidates, FaceLetterbox{}, 0.3f, 8);
+    ASSERT_EQ(faces.size(), 2u);
+
+    // The two overlapping boxes average as (0.1 * 0.9 + 0.12 * 0.6) / 1.5
+    EXPECT_NEAR(faces[0].x, 0.108f, 1e-6f);
+    EXPECT_NEAR(faces[0].width, 0.2f, 1e-6f);
+    EXPECT_NEAR(faces[0].y, 0.1f, 1e-6f);
+    EXPECT_FLOAT_EQ(faces[0].confidence, 0.9f);
+
+    EXPECT_NEAR(faces[1].x, 0.6f, 1e-6f);
+    EXPECT_FLOAT_EQ(faces[1].confidence, 0.7f);
+}
+
+TEST(FaceDecodeTest, DropsSubThresholdLogits) {
+    FaceAnchors anchors = blazeFaceAnchors(kInputSize, kInputSize);
+    RawOutputs raw;
+
+    // A 0.8 threshold is a logit of about 1.386
+    raw.set(100, 0.0f, 0.0f, 16.0f, 16.0f, 1.3f);
+    raw.set(600, 0.0f, 0.0f, 16.0f, 16.0f, 1.5f);
+    // Above threshold but with an empty box
+    raw.set(700, 0.0f, 0.0f, 0.0f, 16.0f, 5.0f);
+
+    auto candidates = decodeFaceCandidates(raw.boxes.data(), kBoxStride, raw.scores.data(),
+                                           anchors, kInputSize, kInputSize, 0.8f);
+    ASSERT_EQ(candidates.size(), 1u);
+    EXPECT_FLOAT_EQ(candidates[0].score, sigmoid(1.5f));
+    EXPECT_NEAR((candidates[0].xmin + candidates[0].xmax) / 2, anchors.x[600], 1e-6f);
+}
+
+TEST(FaceDecodeTest, MaxFacesCapsOutput) {
+    std::vector<FaceDetection> candidates;
+    for (int i = 0; i < 5; ++i) {
+        const float x = 0.2f * i;
+        candidates.push_back({x, 0.0f, x + 0.1f, 0.1f, 0.5f + 0.1f * i});
+    }
+
+    auto faces = mergeFaceDetections(candidates, FaceLetterbox{}, 0.3f, 3);
+    ASSERT_EQ(faces.size(), 3u);
+    EXPECT_FLOAT_EQ(faces[0].confidence, 0.9f);
+    EXPECT_FLOAT_EQ(faces[1].confidence, 0.8f);
+    EXPECT_FLOAT_EQ(faces[2].confidence, 0.7f);
+}
+
+}  // namespace testing
+}  // namespace ventus
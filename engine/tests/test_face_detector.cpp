@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "face_detector.h"
+
+namespace ventus {
+namespace testing {
+
+TEST(FaceDetectorTest, ConfigDefaultsAreReasonable) {
+    FaceDetector::Config config;
+
+    EXPECT_EQ(config.num_threads, 1);
+    EXPECT_EQ(config.pool_size, 1);
+    EXPECT_FLOAT_EQ(config.score_threshold, 0.5f);
+    EXPECT_FLOAT_EQ(config.iou_threshold, 0.3f);
+    EXPECT_GT(config.max_faces, 0);
+}
+
+TEST(FaceDetectorTest, ThrowsOnMissingModel) {
+    FaceDetector::Config config;
+    config.model_path = "models/does_not_exist.tflite";
+
+    EXPECT_THROW(FaceDetector detector(config), std::runtime_error);
+}
+
+// Integration tests, run against the synthetic model generated at build
+// time; it has BlazeFace's shapes but never reports a face, so decoding is
+// covered on hand-built outputs in test_face_decode.cpp
+class FaceDetectorIntegrationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config_.model_path = VENTUS_TEST_MODEL_DIR "/face_float.tflite";
+    }
+
+    FaceDetector::Config config_;
+};
+
+TEST_F(FaceDetectorIntegrationTest, BlankImageHasNoFaces) {
+    FaceDetector detector(config_);
+    ASSERT_TRUE(detector.isReady());
+
+    cv::Mat blank(480, 640, CV_8UC3, cv::Scalar(0, 0, 0));
+    EXPECT_TRUE(detector.detect(blank).empty());
+}
+
+TEST_F(FaceDetectorIntegrationTest, PreparedInputMatchesDirectDetection) {
+    FaceDetector detector(config_);
+
+    cv::Mat image(480, 640, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    std::vector<uint8_t> input(detector.inputBytes());
+    auto letterbox = detector.prepareInput(image, input.data());
+    // 4:3 image letterboxed into a square pads top and bottom only
+    EXPECT_FLOAT_EQ(letterbox.offset_x, 0.0f);
+    EXPECT_GT(letterbox.offset_y, 0.0f);
+
+    auto direct = detector.detect(image);
+    auto prepared = detector.detect(input.data(), letterbox);
+    ASSERT_EQ(direct.size(), prepared.size());
+    for (size_t i = 0; i < direct.size(); ++i) {
+        EXPECT_FLOAT_EQ(direct[i].x, prepared[i].x);
+        EXPECT_FLOAT_EQ(direct[i].confidence, prepared[i].confidence);
+    }
+}
+
+}  // namespace testing
+}  // namespace ventus
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include "inference_engine.h"
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+// Integration tests, run against the synthetic models generated at build time
+class InferenceEngineReloadTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config_.scene_model_path = VENTUS_TEST_MODEL_DIR "/scene_float.tflite";
+        config_.num_threads = 1;
+        config_.pool_size = 2;
+
+        ::cv::Mat image(480, 640, CV_8UC3, ::cv::Scalar(180, 140, 90));
+        ASSERT_TRUE(::cv::imencode(".jpg", image, jpeg_));
+    }
+
+    VerificationResult verify(InferenceEngine& engine) {
+        return engine.verify(jpeg_.data(), jpeg_.size());
+    }
+
+    InferenceEngine::Config config_;
+    std::vector<uint8_t> jpeg_;
+};
+
+TEST_F(InferenceEngineReloadTest, ReportsInitialModel) {
+    InferenceEngine engine(config_);
+    auto info = engine.modelInfo();
+    EXPECT_EQ(info.generation, 1);
+    EXPECT_EQ(info.model_path, config_.scene_model_path);
+    EXPECT_EQ(info.model_hash.size(), 32u);
+}
+
+TEST_F(InferenceEngineReloadTest, SwapsInNewModel) {
+    InferenceEngine engine(config_);
+    const auto before = engine.modelInfo();
+    ASSERT_TRUE(verify(engine).success);
+
+    auto after = engine.reloadModel(VENTUS_TEST_MODEL_DIR "/scene_int8.tflite");
+    EXPECT_EQ(after.generation, 2);
+    EXPECT_NE(after.model_hash, before.model_hash);
+    EXPECT_EQ(engine.modelInfo().model_hash, after.model_hash);
+
+    // The preprocessor follows the new model's quantized input
+    EXPECT_TRUE(verify(engine).success);
+}
+
+TEST_F(InferenceEngineReloadTest, ReloadingSameFileKeepsHash) {
+    InferenceEngine engine(config_);
+    const auto before = engine.modelInfo();
+    auto after = engine.reloadModel();
+    EXPECT_EQ(after.generation, 2);
+    EXPECT_EQ(after.model_path, before.model_path);
+    EXPECT_EQ(after.model_hash, before.model_hash);
+}
+
+TEST_F(InferenceEngineReloadTest, FailedReloadKeepsCurrentModel) {
+    InferenceEngine engine(config_);
+    EXPECT_THROW(engine.reloadModel("/nonexistent/model.tflite"), std::runtime_error);
+    EXPECT_EQ(engine.modelInfo().generation, 1);
+    EXPECT_TRUE(engine.isReady());
+    EXPECT_TRUE(verify(engine).success);
+}
+
+TEST_F(InferenceEngineReloadTest, PreparedImageOutlivesReload) {
+    InferenceEngine engine(config_);
+    PreparedImage prepared = engine.prepare(jpeg_.data(), jpeg_.size());
+    ASSERT_TRUE(prepared.success);
+
+    // The float tensor must still run on the float model it was built for
+    engine.reloadModel(VENTUS_TEST_MODEL_DIR "/scene_int8.tflite");
+    auto result = engine.infer(prepared);
+    EXPECT_TRUE(result.success) << result.error_message;
+}
+
+// Same setup; shedding needs a real model for the stages it skips
+using InferenceEngineDeadlineTest = InferenceEngineReloadTest;
+
+TEST_F(InferenceEngineDeadlineTest, ShedsCancelledRequestBeforeDecode) {
+    InferenceEngine engine(config_);
+    RequestDeadline cancelled(RequestDeadline::Clock::time_point::max(), [] { return true; });
+
+    auto result = engine.verify(jpeg_.data(), jpeg_.size(), cancelled);
+    EXPECT_FALSE(result.success);
+    EXPECT_TRUE(result.shed);
+    EXPECT_EQ(engine.stageMetrics().shed(Stage::kDecode), 1);
+}
+
+TEST_F(InferenceEngineDeadlineTest, ShedsExpiredRequestBeforeEachStage) {
+    InferenceEngine engine(config_);
+    const RequestDeadline expired(RequestDeadline::Clock::now() - std::chrono::seconds(1));
+
+    EXPECT_TRUE(engine.verify(jpeg_.data(), jpeg_.size(), expired).shed);
+
+    // Prepared in time, but stale by the time inference would start
+    PreparedImage prepared = engine.prepare(jpeg_.data(), jpeg_.size());
+    ASSERT_TRUE(prepared.success);
+    auto result = engine.infer(prepared, expired);
+    EXPECT_TRUE(result.shed);
+    EXPECT_EQ(engine.stageMetrics().shed(Stage::kInvoke), 1);
+
+    // A generous deadline is met
+    const RequestDeadline relaxed(RequestDeadline::Clock::now() + std::chrono::seconds(30));
+    auto met = engine.verify(jpeg_.data(), jpeg_.size(), relaxed);
+    EXPECT_TRUE(met.success) << met.error_message;
+    EXPECT_FALSE(met.shed);
+}
+
+TEST_F(InferenceEngineDeadlineTest, ShedResultIsNotCached) {
+    config_.cache_bytes = 1 << 20;
+    InferenceEngine engine(config_);
+    const RequestDeadline expired(RequestDeadline::Clock::now() - std::chrono::seconds(1));
+    ASSERT_TRUE(engine.verify(jpeg_.data(), jpeg_.size(), expired).shed);
+
+    auto result = verify(engine);
+    EXPECT_TRUE(result.success);
+    EXPECT_FALSE(result.cache_hit);
+}
+
+// Same setup with a face model that always reports faces
+class InferenceEngineFaceTest : public InferenceEngineReloadTest {
+protected:
+    void SetUp() override {
+        InferenceEngineReloadTest::SetUp();
+        config_.face_model_path = VENTUS_TEST_MODEL_DIR "/face_hits.tflite";
+    }
+};
+
+TEST_F(InferenceEngineFaceTest, ParallelModelsMatchSequential) {
+    InferenceEngine sequential(config_);
+    config_.parallel_models = true;
+    InferenceEngine parallel(config_);
+
+    auto expected = verify(sequential);
+    ASSERT_TRUE(expected.success) << expected.error_message;
+    ASSERT_FALSE(expected.faces.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        auto result = verify(parallel);
+        ASSERT_TRUE(result.success) << result.error_message;
+        EXPECT_EQ(result.is_outdoor, expected.is_outdoor);
+        EXPECT_FLOAT_EQ(result.outdoor_confidence, expected.outdoor_confidence);
+        EXPECT_EQ(result.face_detected, expected.face_detected);
+        EXPECT_FLOAT_EQ(result.face_confidence, expected.face_confidence);
+        EXPECT_EQ(result.verification_passed, expected.verification_passed);
+        ASSERT_EQ(result.faces.size(), expected.faces.size());
+        for (size_t f = 0; f < result.faces.size(); ++f) {
+            EXPECT_FLOAT_EQ(result.faces[f].x, expected.faces[f].x);
+            EXPECT_FLOAT_EQ(result.faces[f].y, expected.faces[f].y);
+            EXPECT_FLOAT_EQ(result.faces[f].width, expected.faces[f].width);
+            EXPECT_FLOAT_EQ(result.faces[f].confidence, expected.faces[f].confidence);
+        }
+    }
+}
+
+TEST_F(InferenceEngineFaceTest, EarlyCancelDropsFacesOnceSceneRulesOutPass) {
+    // More outdoor labels than top_k can ever return: no scene passes
+    config_.min_outdoor_labels = 100;
+    InferenceEngine uncancelled(config_);
+    auto baseline = verify(uncancelled);
+    ASSERT_TRUE(baseline.success) << baseline.error_message;
+    EXPECT_FALSE(baseline.faces.empty());
+
+    config_.early_cancel = true;
+    for (bool parallel : {false, true}) {
+        config_.parallel_models = parallel;
+        InferenceEngine engine(config_);
+        for (int i = 0; i < 4; ++i) {
+            auto result = verify(engine);
+            ASSERT_TRUE(result.success) << result.error_message;
+            EXPECT_TRUE(result.faces.empty()) << "parallel=" << parallel;
+            EXPECT_FALSE(result.face_detected);
+            EXPECT_FALSE(result.verification_passed);
+            EXPECT_FLOAT_EQ(result.outdoor_confidence, baseline.outdoor_confidence);
+        }
+    }
+}
+
+}  // namespace testing
+}  // namespace ventus
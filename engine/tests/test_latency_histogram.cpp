@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "latency_histogram.h"
+
+namespace ventus {
+namespace testing {
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (int64_t v = 1; v <= 100; ++v) {
+        histogram.record(v);
+    }
+
+    EXPECT_EQ(histogram.count(), 100);
+    EXPECT_EQ(histogram.min(), 1);
+    EXPECT_EQ(histogram.max(), 100);
+    EXPECT_EQ(histogram.percentile(50), 50);
+    EXPECT_EQ(histogram.percentile(99), 99);
+    EXPECT_EQ(histogram.percentile(100), 100);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 50.5);
+}
+
+TEST(LatencyHistogramTest, LargeValuesKeepRelativePrecision) {
+    LatencyHistogram histogram;
+    const int64_t values[] = {1000, 12345, 987654, 123456789};
+    for (int64_t value : values) {
+        histogram.reset();
+        histogram.record(value);
+        const int64_t reported = histogram.percentile(50);
+        EXPECT_LE(reported, value);
+        EXPECT_GE(reported, value - value / (LatencyHistogram::kSubBuckets / 2));
+    }
+}
+
+TEST(LatencyHistogramTest, TailPercentilesSeeOutliers) {
+    LatencyHistogram histogram;
+    histogram.record(1000, 990);
+    histogram.record(50000, 9);
+    histogram.record(2000000, 1);
+
+    EXPECT_NEAR(histogram.percentile(50), 1000, 10);
+    EXPECT_NEAR(histogram.percentile(99.9), 50000, 500);
+    EXPECT_EQ(histogram.percentile(100), 2000000);
+}
+
+TEST(LatencyHistogramTest, ClampsOutOfRangeValues) {
+    LatencyHistogram histogram(10000);
+    histogram.record(-5);
+    histogram.record(1 << 30);
+
+    EXPECT_EQ(histogram.min(), 0);
+    EXPECT_EQ(histogram.max(), 10000);
+    EXPECT_THROW(LatencyHistogram(10), std::invalid_argument);
+}
+
+TEST(LatencyHistogramTest, MergeAddsCounts) {
+    LatencyHistogram first;
+    LatencyHistogram second;
+    first.record(10, 3);
+    second.record(20000, 1);
+
+    first.merge(second);
+    EXPECT_EQ(first.count(), 4);
+    EXPECT_EQ(first.min(), 10);
+    EXPECT_EQ(first.max(), 20000);
+    EXPECT_EQ(first.percentile(75), 10);
+
+    LatencyHistogram narrow(1000);
+    EXPECT_THROW(first.merge(narrow), std::invalid_argument);
+}
+
+TEST(LatencyHistogramTest, EmptyReportsZero) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.min(), 0);
+    EXPECT_EQ(histogram.percentile(99), 0);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 0.0);
+}
+
+}  // namespace testing
+}  // namespace ventus
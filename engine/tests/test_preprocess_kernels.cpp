@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include "preprocess_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+using kernels::Isa;
+
+class PreprocessKernelTest : public ::testing::TestWithParam<Isa> {
+protected:
+    void SetUp() override {
+        const float mean[3] = {0.485f, 0.456f, 0.406f};
+        const float std[3] = {0.229f, 0.224f, 0.225f};
+        for (int c = 0; c < 3; ++c) {
+            params_.scale[c] = 1.0f / (255.0f * std[c]);
+            params_.bias[c] = -mean[c] / std[c];
+        }
+    }
+
+    kernels::NormalizeParams params_;
+};
+
+TEST_P(PreprocessKernelTest, MatchesScalarReference) {
+    auto kernel = kernels::bgrToRgbFloatFor(GetParam());
+    if (!kernel) {
+        GTEST_SKIP() << kernels::isaName(GetParam()) << " not supported on this CPU";
+    }
+
+    std::mt19937 rng(42);
+    // Sizes straddle every kernel's vector width and tail handling
+    for (size_t pixels : {0u, 1u, 5u, 6u, 11u, 18u, 19u, 20u, 35u, 224u * 224u}) {
+        std::vector<uint8_t> src(pixels * 3);
+        for (auto& byte : src) {
+            byte = static_cast<uint8_t>(rng());
+        }
+
+        std::vector<float> expected(pixels * 3);
+        kernels::bgrToRgbFloatScalar(src.data(), expected.data(), pixels, params_);
+
+        // One guard element past the end must stay untouched
+        std::vector<float> actual(pixels * 3 + 1, -1000.0f);
+        kernel(src.data(), actual.data(), pixels, params_);
+
+        for (size_t i = 0; i < pixels * 3; ++i) {
+            ASSERT_NEAR(actual[i], expected[i], 1e-5f)
+                << "pixels=" << pixels << " index=" << i;
+        }
+        EXPECT_EQ(actual[pixels * 3], -1000.0f) << "pixels=" << pixels;
+    }
+}
+
+TEST_P(PreprocessKernelTest, SwapsChannelsAndNormalizes) {
+    auto kernel = kernels::bgrToRgbFloatFor(GetParam());
+    if (!kernel) {
+        GTEST_SKIP() << kernels::isaName(GetParam()) << " not supported on this CPU";
+    }
+
+    // Pure blue in BGR order
+    std::vector<uint8_t> src;
+    for (int p = 0; p < 64; ++p) {
+        src.insert(src.end(), {255, 0, 0});
+    }
+    std::vector<float> out(src.size());
+    kernel(src.data(), out.data(), 64, params_);
+
+    for (int p = 0; p < 64; ++p) {
+        EXPECT_NEAR(out[3 * p + 0], params_.bias[0], 1e-5f);
+        EXPECT_NEAR(out[3 * p + 1], params_.bias[1], 1e-5f);
+        EXPECT_NEAR(out[3 * p + 2], 255.0f * params_.scale[2] + params_.bias[2], 1e-5f);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllIsas, PreprocessKernelTest,
+    ::testing::Values(Isa::kScalar, Isa::kSse41, Isa::kAvx2, Isa::kAvx512),
+    [](const ::testing::TestParamInfo<Isa>& info) {
+        std::string name = kernels::isaName(info.param);
+        name.erase(std::remove(name.begin(), name.end(), '.'), name.end());
+        return name;
+    });
+
+TEST(PreprocessKernelDispatchTest, DetectedIsaIsSupported) {
+    EXPECT_TRUE(kernels::isaSupported(kernels::detectIsa()));
+    EXPECT_NE(kernels::bgrToRgbFloatFor(kernels::detectIsa()), nullptr);
+}
+
+TEST(QuantizeKernelTest, IdentityQuantizationSwapsChannels) {
+    // Unnormalized [0, 1] pixels quantized with scale 1/255 map back to bytes
+    kernels::NormalizeParams params;
+    for (int c = 0; c < 3; ++c) {
+        params.scale[c] = 1.0f / 255.0f;
+        params.bias[c] = 0.0f;
+    }
+    auto table = kernels::buildQuantizeTable(params, 1.0f / 255.0f, 0, false);
+
+    std::vector<uint8_t> src(256 * 3);
+    for (int v = 0; v < 256; ++v) {
+        src[3 * v + 0] = static_cast<uint8_t>(v);
+        src[3 * v + 1] = static_cast<uint8_t>(255 - v);
+        src[3 * v + 2] = static_cast<uint8_t>(v / 2);
+    }
+    std::vector<uint8_t> out(src.size());
+    kernels::bgrToRgbQuantized(src.data(), out.data(), 256, table);
+
+    for (int v = 0; v < 256; ++v) {
+        EXPECT_EQ(out[3 * v + 0], src[3 * v + 2]);
+        EXPECT_EQ(out[3 * v + 1], src[3 * v + 1]);
+        EXPECT_EQ(out[3 * v + 2], src[3 * v + 0]);
+    }
+}
+
+TEST(QuantizeKernelTest, FoldsNormalizationIntoInt8) {
+    const float mean[3] = {0.485f, 0.456f, 0.406f};
+    const float std[3] = {0.229f, 0.224f, 0.225f};
+    kernels::NormalizeParams params;
+    for (int c = 0; c < 3; ++c) {
+        params.scale[c] = 1.0f / (255.0f * std[c]);
+        params.bias[c] = -mean[c] / std[c];
+    }
+    const float scale = 0.0187f;
+    const int zero_point = -14;
+    auto table = kernels::buildQuantizeTable(params, scale, zero_point, true);
+
+    for (int c = 0; c < 3; ++c) {
+        for (int v = 0; v < 256; ++v) {
+            const float normalized = v * params.scale[c] + params.bias[c];
+            const int8_t q = static_cast<int8_t>(table.lut[c][v]);
+            // Dequantized value is within half a step of the float pipeline
+            EXPECT_NEAR(scale * (q - zero_point), normalized, scale * 0.5f + 1e-5f)
+                << "channel " << c << " value " << v;
+        }
+    }
+}
+
+TEST(QuantizeKernelTest, SaturatesToOutputRange) {
+    kernels::NormalizeParams params;
+    for (int c = 0; c < 3; ++c) {
+        params.scale[c] = 1.0f;
+        params.bias[c] = -128.0f;
+    }
+    auto signed_table = kernels::buildQuantizeTable(params, 0.25f, 0, true);
+    auto unsigned_table = kernels::buildQuantizeTable(params, 0.25f, 0, false);
+
+    EXPECT_EQ(static_cast<int8_t>(signed_table.lut[0][0]), -128);
+    EXPECT_EQ(static_cast<int8_t>(signed_table.lut[0][255]), 127);
+    EXPECT_EQ(unsigned_table.lut[0][0], 0);
+    EXPECT_EQ(unsigned_table.lut[0][255], 255);
+}
+
+}  // namespace testing
+}  // namespace ventus
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "preprocessing.h"
+#include <algorithm>
 #include <fstream>
 #include <vector>
 
@@ -61,6 +62,258 @@ TEST_F(PreprocessorTest, HandlesVariousImageSizes) {
     }
 }
 
+// Reference: the original multi-pass OpenCV pipeline
+std::vector<float> referenceProcess(const cv::Mat& image, const Preprocessor::Config& config) {
+    cv::Mat resized;
+    cv::resize(image, resized, cv::Size(config.target_width, config.target_height),
+               0, 0, cv::INTER_LINEAR);
+
+    cv::Mat rgb;
+    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+    cv::Mat float_img;
+    rgb.convertTo(float_img, CV_32FC3, 1.0 / 255.0);
+
+    std::vector<cv::Mat> channels(3);
+    cv::split(float_img, channels);
+    for (int i = 0; i < 3; ++i) {
+        channels[i] = (channels[i] - config.mean[i]) / config.std[i];
+    }
+    cv::merge(channels, float_img);
+
+    std::vector<float> output;
+    for (int y = 0; y < float_img.rows; ++y) {
+        for (int x = 0; x < float_img.cols; ++x) {
+            cv::Vec3f pixel = float_img.at<cv::Vec3f>(y, x);
+            output.insert(output.end(), {pixel[0], pixel[1], pixel[2]});
+        }
+    }
+    return output;
+}
+
+TEST_F(PreprocessorTest, FusedPathMatchesReferencePipeline) {
+    cv::RNG rng(7);
+    for (const cv::Size& size : {cv::Size(224, 224), cv::Size(640, 480), cv::Size(333, 517)}) {
+        cv::Mat image(size.height, size.width, CV_8UC3);
+        rng.fill(image, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+
+        auto expected = referenceProcess(image, Preprocessor::Config{});
+        auto actual = preprocessor_->process(image);
+
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            ASSERT_NEAR(actual[i], expected[i], 1e-4f)
+                << "size " << size.width << "x" << size.height << " index " << i;
+        }
+    }
+}
+
+TEST_F(PreprocessorTest, ProcessIntoHandlesNonContinuousInput) {
+    cv::Mat padded(224, 300, CV_8UC3, cv::Scalar(10, 120, 240));
+    cv::Mat roi = padded(cv::Rect(0, 0, 224, 224));
+    ASSERT_FALSE(roi.isContinuous());
+
+    std::vector<float> direct(224 * 224 * 3);
+    preprocessor_->processInto(roi, direct.data());
+
+    EXPECT_EQ(direct, preprocessor_->process(roi.clone()));
+}
+
+TEST_F(PreprocessorTest, QuantizedFormatMatchesFloatPipeline) {
+    Preprocessor::Config config;
+    config.input_format.type = TensorType::kUInt8;
+    config.input_format.scale = 0.0186f;
+    config.input_format.zero_point = 114;
+    Preprocessor quantized(config);
+    ASSERT_EQ(quantized.tensorBytes(), 224u * 224u * 3u);
+
+    cv::Mat image(480, 640, CV_8UC3);
+    cv::RNG(11).fill(image, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    std::vector<uint8_t> bytes(quantized.tensorBytes());
+    quantized.processInto(image, bytes.data());
+    auto expected = preprocessor_->process(image);
+
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        const float dequantized = config.input_format.scale *
+                                  (bytes[i] - config.input_format.zero_point);
+        ASSERT_NEAR(dequantized, expected[i], config.input_format.scale * 0.5f + 1e-4f)
+            << "index " << i;
+    }
+    EXPECT_THROW(quantized.process(image), std::logic_error);
+}
+
+TEST_F(PreprocessorTest, ChoosesLargestScaleCoveringTarget) {
+    EXPECT_EQ(Preprocessor::chooseScaleDenom(4032, 3024, 224, 224), 8);
+    EXPECT_EQ(Preprocessor::chooseScaleDenom(1600, 2000, 224, 224), 4);
+    EXPECT_EQ(Preprocessor::chooseScaleDenom(640, 480, 224, 224), 2);
+    EXPECT_EQ(Preprocessor::chooseScaleDenom(320, 240, 224, 224), 1);
+    // Rounded up like libjpeg: ceil(1785 / 8) == 224
+    EXPECT_EQ(Preprocessor::chooseScaleDenom(1785, 1785, 224, 224), 8);
+}
+
+TEST_F(PreprocessorTest, ReadsJpegHeaderOnly) {
+    cv::Mat image(480, 640, CV_8UC3, cv::Scalar(30, 60, 90));
+    std::vector<uint8_t> jpeg;
+    std::vector<uint8_t> png;
+    ASSERT_TRUE(cv::imencode(".jpg", image, jpeg));
+    ASSERT_TRUE(cv::imencode(".png", image, png));
+
+    int width = 0;
+    int height = 0;
+    ASSERT_TRUE(Preprocessor::readJpegSize(jpeg.data(), jpeg.size(), &width, &height));
+    EXPECT_EQ(width, 640);
+    EXPECT_EQ(height, 480);
+
+    EXPECT_FALSE(Preprocessor::readJpegSize(png.data(), png.size(), &width, &height));
+    EXPECT_FALSE(Preprocessor::readJpegSize(jpeg.data(), 20, &width, &height));
+}
+
+TEST_F(PreprocessorTest, DecodesJpegAtReducedScale) {
+    cv::Mat image(1600, 2000, CV_8UC3, cv::Scalar(30, 60, 90));
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(cv::imencode(".jpg", image, jpeg));
+
+    DecodeInfo info;
+    cv::Mat decoded = preprocessor_->decode(jpeg.data(), jpeg.size(), &info);
+
+    EXPECT_EQ(info.scale_denom, 4);
+    EXPECT_EQ(info.source_width, 2000);
+    EXPECT_EQ(info.source_height, 1600);
+    EXPECT_EQ(decoded.cols, 500);
+    EXPECT_EQ(decoded.rows, 400);
+    EXPECT_EQ(preprocessor_->process(decoded).size(), 224 * 224 * 3);
+}
+
+TEST_F(PreprocessorTest, ReportsDecodeSavingOnlyOnceCalibrated) {
+    cv::Mat image(1600, 2000, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(cv::imencode(".jpg", image, jpeg));
+
+    DecodeInfo info;
+    preprocessor_->decode(jpeg.data(), jpeg.size(), &info);
+    EXPECT_EQ(info.decode_time_saved_us, 0);
+
+    preprocessor_->calibrateDecode();
+    preprocessor_->decode(jpeg.data(), jpeg.size(), &info);
+    EXPECT_EQ(info.scale_denom, 4);
+    EXPECT_GT(info.decode_time_saved_us, 0);
+}
+
+TEST_F(PreprocessorTest, ScaledDecodeCanBeDisabled) {
+    Preprocessor::Config config;
+    config.scaled_decode = false;
+    Preprocessor full(config);
+
+    cv::Mat image(1600, 2000, CV_8UC3, cv::Scalar(30, 60, 90));
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(cv::imencode(".jpg", image, jpeg));
+
+    DecodeInfo info;
+    cv::Mat decoded = full.decode(jpeg.data(), jpeg.size(), &info);
+
+    EXPECT_EQ(info.scale_denom, 1);
+    EXPECT_EQ(decoded.cols, 2000);
+    EXPECT_EQ(info.decode_time_saved_us, 0);
+}
+
+TEST_F(PreprocessorTest, StreamDecodeMatchesWholeDecode) {
+    cv::Mat image(1600, 2000, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(cv::imencode(".jpg", image, jpeg));
+
+    DecodeInfo whole_info;
+    cv::Mat whole = preprocessor_->decode(jpeg.data(), jpeg.size(), &whole_info);
+
+    Preprocessor::StreamDecoder decoder(*preprocessor_);
+    const size_t chunk = 4096;
+    size_t max_buffered = 0;
+    for (size_t offset = 0; offset < jpeg.size(); offset += chunk) {
+        decoder.feed(jpeg.data() + offset, std::min(chunk, jpeg.size() - offset));
+        max_buffered = std::max(max_buffered, decoder.bytesBuffered());
+    }
+    DecodeInfo info;
+    cv::Mat streamed = decoder.finish(&info);
+
+    EXPECT_EQ(decoder.bytesReceived(), jpeg.size());
+    EXPECT_LT(max_buffered, jpeg.size() / 2);
+    EXPECT_EQ(info.scale_denom, whole_info.scale_denom);
+    EXPECT_EQ(info.source_width, 2000);
+    ASSERT_EQ(streamed.size(), whole.size());
+    EXPECT_LE(cv::norm(streamed, whole, cv::NORM_INF), 2.0);
+}
+
+TEST_F(PreprocessorTest, StreamDecodesProgressiveJpeg) {
+    cv::Mat image(480, 640, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(cv::imencode(".jpg", image, jpeg, {cv::IMWRITE_JPEG_PROGRESSIVE, 1}));
+
+    // Scans are absorbed into libjpeg's coefficient buffer as they arrive,
+    // so compressed bytes still do not pile up
+    Preprocessor::StreamDecoder decoder(*preprocessor_);
+    size_t max_buffered = 0;
+    for (size_t offset = 0; offset < jpeg.size(); offset += 1024) {
+        decoder.feed(jpeg.data() + offset, std::min<size_t>(1024, jpeg.size() - offset));
+        max_buffered = std::max(max_buffered, decoder.bytesBuffered());
+    }
+    cv::Mat streamed = decoder.finish();
+
+    EXPECT_LT(max_buffered, jpeg.size() / 2);
+    EXPECT_EQ(streamed.cols, 320);
+    EXPECT_EQ(streamed.rows, 240);
+}
+
+TEST_F(PreprocessorTest, StreamDecodeRejectsProgressiveJpegOverMemoryLimit) {
+    // 640x480 4:2:0 has 7200 DCT blocks, 900 KiB of coefficients
+    Preprocessor::Config config;
+    config.max_stream_decode_bytes = 512 << 10;
+    Preprocessor limited(config);
+
+    cv::Mat image(480, 640, CV_8UC3);
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    std::vector<uint8_t> progressive;
+    ASSERT_TRUE(cv::imencode(".jpg", image, progressive, {cv::IMWRITE_JPEG_PROGRESSIVE, 1}));
+    std::vector<uint8_t> baseline;
+    ASSERT_TRUE(cv::imencode(".jpg", image, baseline));
+
+    // Rejected once the header is in, long before the upload completes
+    Preprocessor::StreamDecoder rejected(limited);
+    EXPECT_THROW(rejected.feed(progressive.data(), 4096), std::runtime_error);
+    EXPECT_THROW(rejected.finish(), std::runtime_error);
+
+    // Baseline decoding needs only a few rows, well under the same limit
+    Preprocessor::StreamDecoder decoder(limited);
+    decoder.feed(baseline.data(), baseline.size());
+    EXPECT_EQ(decoder.finish().cols, 320);
+}
+
+TEST_F(PreprocessorTest, StreamDecodeBuffersOtherFormats) {
+    cv::Mat image(48, 64, CV_8UC3, cv::Scalar(30, 60, 90));
+    std::vector<uint8_t> png;
+    ASSERT_TRUE(cv::imencode(".png", image, png));
+
+    Preprocessor::StreamDecoder decoder(*preprocessor_);
+    decoder.feed(png.data(), 10);
+    decoder.feed(png.data() + 10, png.size() - 10);
+    EXPECT_EQ(decoder.bytesBuffered(), png.size());
+
+    cv::Mat streamed = decoder.finish();
+    EXPECT_EQ(streamed.cols, 64);
+    EXPECT_EQ(cv::norm(streamed, image, cv::NORM_INF), 0.0);
+}
+
+TEST_F(PreprocessorTest, StreamDecodeThrowsOnTruncatedHeader) {
+    cv::Mat image(480, 640, CV_8UC3, cv::Scalar(30, 60, 90));
+    std::vector<uint8_t> jpeg;
+    ASSERT_TRUE(cv::imencode(".jpg", image, jpeg));
+
+    Preprocessor::StreamDecoder decoder(*preprocessor_);
+    decoder.feed(jpeg.data(), 20);
+    EXPECT_THROW(decoder.finish(), std::runtime_error);
+}
+
 TEST_F(PreprocessorTest, DecodeThrowsOnInvalidData) {
     std::vector<uint8_t> invalid_data = {0, 1, 2, 3, 4, 5};
     
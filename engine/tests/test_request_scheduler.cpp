@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "request_scheduler.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+TEST(RequestSchedulerTest, RunsAdmittedTasks) {
+    RequestScheduler::Config config;
+    config.num_workers = 2;
+    config.max_in_flight = 16;
+
+    std::atomic<int> completed{0};
+    {
+        RequestScheduler scheduler(config);
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_TRUE(scheduler.trySubmit([&completed] { completed++; }));
+        }
+    }
+
+    EXPECT_EQ(completed.load(), 10);
+}
+
+TEST(RequestSchedulerTest, RejectsWhenAtCapacity) {
+    RequestScheduler::Config config;
+    config.num_workers = 1;
+    config.max_in_flight = 2;
+
+    RequestScheduler scheduler(config);
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+
+    EXPECT_TRUE(scheduler.trySubmit([gate] { gate.wait(); }));
+    EXPECT_TRUE(scheduler.trySubmit([gate] { gate.wait(); }));
+    EXPECT_FALSE(scheduler.trySubmit([] {}));
+
+    auto stats = scheduler.getStats();
+    EXPECT_EQ(stats.admitted, 2);
+    EXPECT_EQ(stats.rejected, 1);
+    EXPECT_EQ(stats.in_flight, 2);
+
+    release.set_value();
+}
+
+TEST(RequestSchedulerTest, SubmitBlocksUntilCapacityFrees) {
+    RequestScheduler::Config config;
+    config.num_workers = 1;
+    config.max_in_flight = 1;
+
+    RequestScheduler scheduler(config);
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    ASSERT_TRUE(scheduler.trySubmit([gate] { gate.wait(); }));
+
+    std::atomic<bool> second_ran{false};
+    auto blocked = std::async(std::launch::async, [&] {
+        return scheduler.submit([&second_ran] { second_ran = true; });
+    });
+
+    EXPECT_EQ(blocked.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    release.set_value();
+    EXPECT_TRUE(blocked.get());
+
+    scheduler.shutdown();
+    EXPECT_TRUE(second_ran.load());
+}
+
+TEST(RequestSchedulerTest, RunsEarliestDeadlineFirst) {
+    RequestScheduler::Config config;
+    config.num_workers = 1;
+    config.max_in_flight = 16;
+
+    RequestScheduler scheduler(config);
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    ASSERT_TRUE(scheduler.trySubmit([gate] { gate.wait(); }));
+
+    // Queued behind the blocked worker, out of deadline order
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int id) {
+        return [&mutex, &order, id] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(id);
+        };
+    };
+    const auto now = RequestScheduler::Clock::now();
+    ASSERT_TRUE(scheduler.trySubmit(record(4)));
+    ASSERT_TRUE(scheduler.trySubmit(record(3), now + std::chrono::seconds(3)));
+    ASSERT_TRUE(scheduler.trySubmit(record(1), now + std::chrono::seconds(1)));
+    ASSERT_TRUE(scheduler.trySubmit(record(5)));
+    ASSERT_TRUE(scheduler.trySubmit(record(2), now + std::chrono::seconds(1)));
+
+    release.set_value();
+    scheduler.shutdown();
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3, 4, 5}));
+}
+
+TEST(RequestSchedulerTest, ReservedSlotOutlivesItsTasks) {
+    RequestScheduler::Config config;
+    config.num_workers = 1;
+    config.max_in_flight = 1;
+
+    RequestScheduler scheduler(config);
+    ASSERT_TRUE(scheduler.tryReserve());
+    EXPECT_FALSE(scheduler.tryReserve());
+
+    // Every task of the reserved request runs, while others stay rejected
+    std::atomic<int> completed{0};
+    for (int i = 0; i < 5; ++i) {
+        std::promise<void> done;
+        std::future<void> ran = done.get_future();
+        ASSERT_TRUE(scheduler.submitReserved([&completed, &done] {
+            completed++;
+            done.set_value();
+        }));
+        ran.wait();
+        EXPECT_FALSE(scheduler.trySubmit([] {}));
+    }
+    EXPECT_EQ(completed.load(), 5);
+
+    auto stats = scheduler.getStats();
+    EXPECT_EQ(stats.admitted, 1);
+    EXPECT_EQ(stats.in_flight, 1);
+
+    scheduler.release();
+    EXPECT_TRUE(scheduler.trySubmit([] {}));
+}
+
+TEST(RequestSchedulerTest, RejectsAfterShutdown) {
+    RequestScheduler scheduler(RequestScheduler::Config{});
+    scheduler.shutdown();
+
+    EXPECT_FALSE(scheduler.trySubmit([] {}));
+    EXPECT_FALSE(scheduler.tryReserve());
+    EXPECT_FALSE(scheduler.submitReserved([] {}));
+}
+
+}  // namespace testing
+}  // namespace ventus
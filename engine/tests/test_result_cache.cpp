@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "result_cache.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+namespace {
+
+ContentHash keyFor(const std::string& text, uint64_t seed = 0) {
+    return hashBytes(reinterpret_cast<const uint8_t*>(text.data()), text.size(), seed);
+}
+
+size_t stringCost(const std::string& value) {
+    return value.size();
+}
+
+bool always(const std::string&) {
+    return true;
+}
+
+}  // namespace
+
+TEST(ContentHashTest, DependsOnBytesLengthAndSeed) {
+    EXPECT_EQ(keyFor("selfie"), keyFor("selfie"));
+    EXPECT_FALSE(keyFor("selfie") == keyFor("selfiE"));
+    EXPECT_FALSE(keyFor("selfie") == keyFor("selfie", 1));
+
+    // Trailing zero bytes must not collide with the shorter input
+    std::string padded("selfie\0\0", 8);
+    EXPECT_FALSE(keyFor("selfie") == keyFor(padded));
+}
+
+TEST(ContentHashTest, KeyedHashMatchesSipHashReference) {
+    // Reference SipHash-2-4-128 vectors (key 00..0f, messages 00..n-1);
+    // lo holds output bytes 0-7 little-endian
+    HashKey key{0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+    const uint8_t message[] = {0x00};
+    const ContentHash empty = keyedHash(message, 0, key);
+    EXPECT_EQ(empty.hi, 0x930255c71472f66dULL);
+    EXPECT_EQ(empty.lo, 0xe6a825ba047f81a3ULL);
+    const ContentHash one = keyedHash(message, 1, key);
+    EXPECT_EQ(one.hi, 0x45fc229b11597634ULL);
+    EXPECT_EQ(one.lo, 0x44af996bd8c187daULL);
+
+    const HashKey other = HashKey::random();
+    EXPECT_FALSE(keyedHash(message, 1, key) == keyedHash(message, 1, other));
+}
+
+TEST(ResultCacheTest, HitsAfterFirstCompute) {
+    ResultCache<std::string> cache({}, stringCost);
+    int computed = 0;
+    auto compute = [&computed] { computed++; return std::string("outdoor"); };
+
+    bool hit = true;
+    EXPECT_EQ(cache.getOrCompute(keyFor("a"), compute, always, &hit), "outdoor");
+    EXPECT_FALSE(hit);
+    EXPECT_EQ(cache.getOrCompute(keyFor("a"), compute, always, &hit), "outdoor");
+    EXPECT_TRUE(hit);
+
+    EXPECT_EQ(computed, 1);
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.entries, 1);
+}
+
+TEST(ResultCacheTest, SkipsUncacheableValues) {
+    ResultCache<std::string> cache({}, stringCost);
+    auto failed = [] { return std::string("error"); };
+    auto never = [](const std::string&) { return false; };
+
+    cache.getOrCompute(keyFor("a"), failed, never);
+    cache.getOrCompute(keyFor("a"), failed, never);
+
+    EXPECT_EQ(cache.getStats().misses, 2);
+    EXPECT_EQ(cache.getStats().entries, 0);
+}
+
+TEST(ResultCacheTest, EvictsLeastRecentlyUsed) {
+    ResultCache<std::string>::Config config;
+    config.num_shards = 1;
+    config.capacity = 3 * (sizeof(std::string) + 64 + 100);
+    ResultCache<std::string> cache(config, [](const std::string&) { return size_t{100}; });
+
+    for (const char* key : {"a", "b", "c"}) {
+        cache.getOrCompute(keyFor(key), [key] { return std::string(key); }, always);
+    }
+    // Touch "a" so "b" is the oldest
+    cache.getOrCompute(keyFor("a"), [] { return std::string("recomputed"); }, always);
+    cache.getOrCompute(keyFor("d"), [] { return std::string("d"); }, always);
+
+    auto stats = cache.getStats();
+    EXPECT_GE(stats.evictions, 1);
+    bool hit = false;
+    EXPECT_EQ(cache.getOrCompute(keyFor("a"), [] { return std::string("x"); }, always, &hit), "a");
+    EXPECT_TRUE(hit);
+    cache.getOrCompute(keyFor("b"), [] { return std::string("b"); }, always, &hit);
+    EXPECT_FALSE(hit);
+}
+
+TEST(ResultCacheTest, CoalescesConcurrentIdenticalRequests) {
+    ResultCache<std::string> cache({}, stringCost);
+    std::atomic<int> computed{0};
+    auto slow = [&computed] {
+        computed++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return std::string("shared");
+    };
+
+    std::vector<std::thread> callers;
+    std::vector<std::string> results(8);
+    for (int i = 0; i < 8; ++i) {
+        callers.emplace_back([&, i] { results[i] = cache.getOrCompute(keyFor("same"), slow, always); });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    EXPECT_EQ(computed.load(), 1);
+    for (const auto& result : results) {
+        EXPECT_EQ(result, "shared");
+    }
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits + stats.coalesced, 7);
+}
+
+TEST(ResultCacheTest, PropagatesComputeErrorsToWaiters) {
+    ResultCache<std::string> cache({}, stringCost);
+    auto failing = []() -> std::string { throw std::runtime_error("decode failed"); };
+
+    EXPECT_THROW(cache.getOrCompute(keyFor("bad"), failing, always), std::runtime_error);
+    EXPECT_EQ(cache.getStats().entries, 0);
+}
+
+}  // namespace testing
+}  // namespace ventus
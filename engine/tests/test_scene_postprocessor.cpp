@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "scene_postprocessor.h"
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+TEST(ScenePostprocessorTest, KeepsTopKInDescendingOrder) {
+    ScenePostprocessor postprocessor(6, {0, 1}, 3, 0.5f);
+    std::vector<float> scores = {0.05f, 0.30f, 0.10f, 0.40f, 0.15f, 0.0f};
+
+    ClassificationResult result;
+    postprocessor.run(scores.data(), result);
+
+    ASSERT_EQ(result.predictions.size(), 3u);
+    EXPECT_EQ(result.predictions[0].label_id, 3);
+    EXPECT_EQ(result.predictions[1].label_id, 1);
+    EXPECT_EQ(result.predictions[2].label_id, 4);
+    EXPECT_FLOAT_EQ(result.predictions[0].confidence, 0.40f);
+    EXPECT_FALSE(result.predictions[0].is_outdoor);
+    EXPECT_TRUE(result.predictions[1].is_outdoor);
+}
+
+TEST(ScenePostprocessorTest, SumsOutdoorClassesAgainstThreshold) {
+    ScenePostprocessor postprocessor(4, {0, 2}, 2, 0.6f);
+
+    ClassificationResult outdoor;
+    std::vector<float> outdoor_scores = {0.35f, 0.1f, 0.3f, 0.25f};
+    postprocessor.run(outdoor_scores.data(), outdoor);
+    EXPECT_NEAR(outdoor.outdoor_score, 0.65f, 1e-6f);
+    EXPECT_TRUE(outdoor.is_outdoor);
+
+    ClassificationResult indoor;
+    std::vector<float> indoor_scores = {0.1f, 0.5f, 0.1f, 0.3f};
+    postprocessor.run(indoor_scores.data(), indoor);
+    EXPECT_NEAR(indoor.outdoor_score, 0.2f, 1e-6f);
+    EXPECT_FALSE(indoor.is_outdoor);
+}
+
+TEST(ScenePostprocessorTest, BreaksTiesByLowerLabelId) {
+    ScenePostprocessor postprocessor(5, {}, 3, 0.5f);
+    std::vector<float> scores = {0.2f, 0.2f, 0.2f, 0.2f, 0.2f};
+
+    ClassificationResult result;
+    postprocessor.run(scores.data(), result);
+
+    ASSERT_EQ(result.predictions.size(), 3u);
+    EXPECT_EQ(result.predictions[0].label_id, 0);
+    EXPECT_EQ(result.predictions[1].label_id, 1);
+    EXPECT_EQ(result.predictions[2].label_id, 2);
+}
+
+TEST(ScenePostprocessorTest, ReusedResultIsOverwritten) {
+    ScenePostprocessor postprocessor(3, {0}, 2, 0.5f);
+    std::vector<float> first = {0.9f, 0.05f, 0.05f};
+    std::vector<float> second = {0.1f, 0.2f, 0.7f};
+
+    ClassificationResult result;
+    postprocessor.run(first.data(), result);
+    postprocessor.run(second.data(), result);
+
+    ASSERT_EQ(result.predictions.size(), 2u);
+    EXPECT_EQ(result.predictions[0].label_id, 2);
+    EXPECT_FALSE(result.is_outdoor);
+}
+
+TEST(ScenePostprocessorTest, RejectsInvalidConfig) {
+    EXPECT_THROW(ScenePostprocessor(10, {}, PredictionList::kCapacity + 1, 0.5f),
+                 std::invalid_argument);
+    EXPECT_THROW(ScenePostprocessor(10, {10}, 5, 0.5f), std::invalid_argument);
+}
+
+}  // namespace testing
+}  // namespace ventus
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "metrics_server.h"
+#include "stage_metrics.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+namespace {
+
+// Sends one HTTP request to the metrics server and returns the raw response
+std::string httpGet(int port, const std::string& path) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return "";
+    }
+
+    const std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return response;
+}
+
+}  // namespace
+
+TEST(ShardedHistogramTest, ConcurrentRecordsAreAllCounted) {
+    ShardedHistogram histogram;
+    constexpr int kThreads = 16;
+    constexpr int kPerThread = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                histogram.record(100 + t);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const LatencyHistogram snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count(), kThreads * kPerThread);
+    EXPECT_EQ(snapshot.min(), 100);
+    EXPECT_EQ(snapshot.max(), 100 + kThreads - 1);
+}
+
+TEST(StageMetricsTest, SkipsStagesThatDidNotRun) {
+    StageMetrics metrics;
+    StageTimings timings;
+    timings[Stage::kDecode] = 1200;
+    timings[Stage::kInvoke] = 8000;
+    timings[Stage::kRequest] = 9500;
+    metrics.record(timings);
+
+    EXPECT_EQ(metrics.snapshot(Stage::kDecode).count(), 1);
+    EXPECT_EQ(metrics.snapshot(Stage::kInvoke).count(), 1);
+    EXPECT_EQ(metrics.snapshot(Stage::kRequest).count(), 1);
+    EXPECT_EQ(metrics.snapshot(Stage::kTensorCopy).count(), 0);
+    EXPECT_EQ(metrics.snapshot(Stage::kFace).count(), 0);
+}
+
+TEST(StageMetricsTest, WritesCumulativePrometheusBuckets) {
+    StageMetrics metrics;
+    metrics.record(Stage::kInvoke, 40);
+    metrics.record(Stage::kInvoke, 4000);
+    metrics.record(Stage::kInvoke, 40000);
+
+    std::ostringstream out;
+    metrics.writePrometheus(out);
+    const std::string text = out.str();
+
+    EXPECT_NE(text.find("# TYPE ventus_stage_duration_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("ventus_stage_duration_seconds_bucket{stage=\"invoke\",le=\"5e-05\"} 1"),
+              std::string::npos);
+    EXPECT_NE(text.find("ventus_stage_duration_seconds_bucket{stage=\"invoke\",le=\"0.005\"} 2"),
+              std::string::npos);
+    EXPECT_NE(text.find("ventus_stage_duration_seconds_bucket{stage=\"invoke\",le=\"+Inf\"} 3"),
+              std::string::npos);
+    EXPECT_NE(text.find("ventus_stage_duration_seconds_count{stage=\"invoke\"} 3"),
+              std::string::npos);
+    EXPECT_NE(text.find("ventus_stage_duration_seconds_count{stage=\"decode\"} 0"),
+              std::string::npos);
+}
+
+TEST(StageMetricsTest, TracksTypicalDuration) {
+    StageMetrics metrics;
+    EXPECT_EQ(metrics.typicalUs(Stage::kInvoke), 0);
+    metrics.record(Stage::kInvoke, 1600);
+    EXPECT_EQ(metrics.typicalUs(Stage::kInvoke), 1600);
+    metrics.record(Stage::kInvoke, 3200);
+    EXPECT_EQ(metrics.typicalUs(Stage::kInvoke), 1700);
+}
+
+TEST(StageMetricsTest, ExportsShedCounts) {
+    StageMetrics metrics;
+    metrics.recordShed(Stage::kDecode);
+    metrics.recordShed(Stage::kDecode);
+    metrics.recordShed(Stage::kInvoke);
+    EXPECT_EQ(metrics.shed(Stage::kDecode), 2);
+
+    std::ostringstream out;
+    metrics.writePrometheus(out);
+    const std::string text = out.str();
+    EXPECT_NE(text.find("# TYPE ventus_requests_shed_total counter"), std::string::npos);
+    EXPECT_NE(text.find("ventus_requests_shed_total{stage=\"decode\"} 2"), std::string::npos);
+    EXPECT_NE(text.find("ventus_requests_shed_total{stage=\"invoke\"} 1"), std::string::npos);
+    EXPECT_NE(text.find("ventus_requests_shed_total{stage=\"preprocess\"} 0"), std::string::npos);
+}
+
+TEST(MetricsServerTest, ServesMetricsPath) {
+    MetricsServer::Config config;
+    config.port = 0;
+    MetricsServer server(config, [] { return std::string("ventus_up 1\n"); });
+    ASSERT_GT(server.port(), 0);
+
+    const std::string response = httpGet(server.port(), "/metrics");
+    EXPECT_EQ(response.rfind("HTTP/1.1 200", 0), 0u);
+    EXPECT_NE(response.find("text/plain; version=0.0.4"), std::string::npos);
+    EXPECT_NE(response.find("ventus_up 1"), std::string::npos);
+
+    EXPECT_EQ(httpGet(server.port(), "/other").rfind("HTTP/1.1 404", 0), 0u);
+}
+
+TEST(MetricsServerTest, RenderFailureIsServerError) {
+    MetricsServer::Config config;
+    config.port = 0;
+    MetricsServer server(config, []() -> std::string {
+        throw std::runtime_error("engine not ready");
+    });
+
+    EXPECT_EQ(httpGet(server.port(), "/metrics").rfind("HTTP/1.1 500", 0), 0u);
+}
+
+}  // namespace testing
+}  // namespace ventus
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "request_scheduler.h"
+#include "thread_topology.h"
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace ventus {
+namespace testing {
+
+TEST(ThreadTopologyTest, ParsesKernelCpuLists) {
+    EXPECT_EQ(parseCpuList("0-3,8,10-11\n"), (CpuSet{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parseCpuList("5"), (CpuSet{5}));
+    EXPECT_TRUE(parseCpuList("").empty());
+    EXPECT_THROW(parseCpuList("3-1"), std::invalid_argument);
+    EXPECT_THROW(parseCpuList("0-x"), std::invalid_argument);
+}
+
+TEST(ThreadTopologyTest, SplitsCpusBetweenStages) {
+    ThreadTopology::Config config;
+    config.num_threads = 2;
+    ThreadTopology topology(CpuTopology::uniform(1, 8), config);
+
+    EXPECT_EQ(topology.preprocessCpus(), (CpuSet{6, 7}));
+    EXPECT_EQ(topology.inferenceCpus(), (CpuSet{0, 1, 2, 3, 4, 5}));
+    EXPECT_EQ(topology.numThreads(), 2);
+    EXPECT_EQ(topology.poolSize(), 3);
+    EXPECT_EQ(topology.preprocessThreads() + topology.poolSize() * topology.numThreads(), 8);
+}
+
+TEST(ThreadTopologyTest, KeepsSlicesInsideNumaNodes) {
+    ThreadTopology::Config config;
+    config.num_threads = 3;
+    config.preprocess_threads = 2;
+    ThreadTopology topology(CpuTopology::uniform(2, 4), config);
+
+    // Node 1 loses two CPUs to preprocessing, leaving no room for a slice
+    EXPECT_EQ(topology.preprocessCpus(), (CpuSet{6, 7}));
+    EXPECT_EQ(topology.poolSize(), 1);
+    ASSERT_EQ(topology.inferenceWorkerCpus().size(), 1u);
+    EXPECT_EQ(topology.inferenceWorkerCpus()[0], (CpuSet{0, 1, 2, 3}));
+
+    config.num_threads = 2;
+    config.pool_size = 4;
+    ThreadTopology two_nodes(CpuTopology::uniform(2, 4), config);
+    ASSERT_EQ(two_nodes.inferenceWorkerCpus().size(), 4u);
+    EXPECT_EQ(two_nodes.inferenceWorkerCpus()[1], (CpuSet{0, 1, 2, 3}));
+    EXPECT_EQ(two_nodes.inferenceWorkerCpus()[2], (CpuSet{4, 5}));
+}
+
+TEST(ThreadTopologyTest, SingleCpuIsShared) {
+    ThreadTopology::Config config;
+    config.num_threads = 4;
+    ThreadTopology topology(CpuTopology::uniform(1, 1), config);
+    EXPECT_EQ(topology.numThreads(), 1);
+    EXPECT_EQ(topology.poolSize(), 1);
+    EXPECT_EQ(topology.preprocessCpus(), topology.inferenceCpus());
+}
+
+TEST(ThreadTopologyTest, DetectsAllowedCpus) {
+    auto cpus = CpuTopology::detect();
+    ASSERT_FALSE(cpus.nodes.empty());
+    EXPECT_EQ(static_cast<size_t>(cpus.cpuCount()), currentThreadAffinity().size());
+}
+
+TEST(ThreadTopologyTest, SchedulerPinsWorkers) {
+    const CpuSet allowed = currentThreadAffinity();
+    ASSERT_FALSE(allowed.empty());
+
+    RequestScheduler::Config config;
+    config.num_workers = 1;
+    config.worker_cpus = {{allowed.front()}};
+    RequestScheduler scheduler(config);
+
+    std::promise<CpuSet> affinity;
+    ASSERT_TRUE(scheduler.trySubmit([&affinity] { affinity.set_value(currentThreadAffinity()); }));
+    EXPECT_EQ(affinity.get_future().get(), CpuSet{allowed.front()});
+    EXPECT_EQ(currentThreadAffinity(), allowed);
+}
+
+TEST(ThreadTopologyTest, ScopedAffinityRestoresPreviousSet) {
+    const CpuSet allowed = currentThreadAffinity();
+    ASSERT_FALSE(allowed.empty());
+    {
+        ScopedAffinity affinity({allowed.back()});
+        EXPECT_EQ(currentThreadAffinity(), CpuSet{allowed.back()});
+    }
+    EXPECT_EQ(currentThreadAffinity(), allowed);
+}
+
+TEST(ThreadTopologyTest, ReadsSchedulerStats) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto stats = readSchedulerStats();
+    EXPECT_GT(stats.voluntary_switches, 0);
+    EXPECT_GE(stats.threads, 1);
+    EXPECT_GE(stats.run_queue_wait_ns, 0);
+}
+
+TEST(ThreadTopologyTest, CpuTimeKeepsExitedThreads) {
+    const int64_t before = readSchedulerStats().cpu_time_ns;
+    std::thread([] {
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }).join();
+
+    EXPECT_GE(readSchedulerStats().cpu_time_ns - before, 20000000);
+}
+
+}  // namespace testing
+}  // namespace ventus
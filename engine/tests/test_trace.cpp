@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "trace.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+TEST(TraceRecorderTest, SnapshotIsOldestFirst) {
+    TraceRecorder recorder(8);
+    recorder.record("decode", "req-1", 100, 10);
+    recorder.record("invoke", "req-1", 110, 20);
+
+    auto events = recorder.snapshot();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_STREQ(events[0].name, "decode");
+    EXPECT_EQ(events[0].request_id, "req-1");
+    EXPECT_EQ(events[0].start_us, 100);
+    EXPECT_EQ(events[0].duration_us, 10);
+    EXPECT_STREQ(events[1].name, "invoke");
+}
+
+TEST(TraceRecorderTest, RingKeepsNewestSpans) {
+    TraceRecorder recorder(4);
+    EXPECT_EQ(recorder.capacity(), 4u);
+    for (int i = 0; i < 10; ++i) {
+        recorder.record("span", "req-" + std::to_string(i), i, 1);
+    }
+
+    auto events = recorder.snapshot();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events.front().request_id, "req-6");
+    EXPECT_EQ(events.back().request_id, "req-9");
+    EXPECT_EQ(recorder.recorded(), 10);
+
+    auto newest = recorder.snapshot({}, 2);
+    ASSERT_EQ(newest.size(), 2u);
+    EXPECT_EQ(newest.front().request_id, "req-8");
+}
+
+TEST(TraceRecorderTest, FiltersByRequestId) {
+    TraceRecorder recorder(16);
+    recorder.record("decode", "req-a", 0, 1);
+    recorder.record("decode", "req-b", 0, 1);
+    recorder.record("invoke", "req-a", 1, 1);
+
+    auto events = recorder.snapshot("req-a");
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_STREQ(events[1].name, "invoke");
+
+    // Long IDs are stored and matched by their prefix
+    const std::string long_id(64, 'x');
+    recorder.record("decode", long_id, 0, 1);
+    auto long_events = recorder.snapshot(long_id);
+    ASSERT_EQ(long_events.size(), 1u);
+    EXPECT_EQ(long_events[0].request_id.size(), TraceRecorder::kMaxRequestIdBytes);
+}
+
+TEST(TraceRecorderTest, ConcurrentWritersNeverTearSpans) {
+    TraceRecorder recorder(64);
+    constexpr int kThreads = 8;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&recorder, t] {
+            const std::string id = "thread-" + std::to_string(t);
+            for (int i = 0; i < 20000; ++i) {
+                // Duration doubles as a checksum of the request ID
+                recorder.record("span", id, i, t);
+            }
+        });
+    }
+
+    // Read while writers lap the ring
+    for (int i = 0; i < 100; ++i) {
+        for (const TraceEvent& event : recorder.snapshot()) {
+            EXPECT_EQ(event.request_id, "thread-" + std::to_string(event.duration_us));
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(recorder.recorded(), kThreads * 20000);
+}
+
+TEST(TraceRecorderTest, ChromeJsonEscapesRequestIds) {
+    TraceRecorder recorder(8);
+    recorder.record("decode", "a\"b\\c\n", 5, 7);
+
+    const std::string json = TraceRecorder::toChromeJson(recorder.snapshot());
+    EXPECT_NE(json.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"decode\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"X\",\"ts\":5,\"dur\":7"), std::string::npos);
+    EXPECT_NE(json.find("\"request_id\":\"a\\\"b\\\\c\\n\""), std::string::npos);
+}
+
+TEST(TraceSpanTest, TagsSpansWithInnermostScope) {
+    // The global recorder outlives the test, so IDs are fresh on every
+    // run of it (e.g. under --gtest_repeat)
+    static int run = 0;
+    const std::string suffix = "-" + std::to_string(++run);
+    const std::string outer_id = "trace-test-outer" + suffix;
+    const std::string inner_id = "trace-test-inner" + suffix;
+    const std::string disabled_id = "trace-test-disabled" + suffix;
+
+    TraceRecorder& recorder = TraceRecorder::global();
+    {
+        TraceScope outer(outer_id);
+        TraceSpan span("outer");
+        {
+            TraceScope inner(inner_id);
+            TraceSpan inner_span("inner");
+        }
+        EXPECT_EQ(TraceScope::current(), outer_id);
+    }
+    EXPECT_TRUE(TraceScope::current().empty());
+
+    auto inner = recorder.snapshot(inner_id);
+    ASSERT_EQ(inner.size(), 1u);
+    EXPECT_STREQ(inner[0].name, "inner");
+    auto outer = recorder.snapshot(outer_id);
+    ASSERT_EQ(outer.size(), 1u);
+    EXPECT_GE(outer[0].duration_us, inner[0].duration_us);
+
+    recorder.setEnabled(false);
+    {
+        TraceScope scope(disabled_id);
+        TraceSpan span("disabled");
+    }
+    recorder.setEnabled(true);
+    EXPECT_TRUE(recorder.snapshot(disabled_id).empty());
+}
+
+TEST(TraceRecorderTest, WritesEscapedJsonStrings) {
+    std::ostringstream out;
+    writeJsonString(out, std::string("a\"b\\c\r\n\x01\x1f") + "\xc3\xa9");
+    EXPECT_EQ(out.str(), "\"a\\\"b\\\\c\\r\\n\\u0001\\u001f\xc3\xa9\"");
+}
+
+}  // namespace testing
+}  // namespace ventus
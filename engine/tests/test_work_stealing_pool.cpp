@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "work_stealing_pool.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <set>
+#include <vector>
+
+namespace ventus {
+namespace testing {
+
+TEST(WorkStealingPoolTest, RunsEverySubmittedTask) {
+    WorkStealingPool::Config config;
+    config.num_workers = 4;
+    config.max_in_flight = 8;
+
+    std::atomic<int> completed{0};
+    WorkStealingPool pool(config);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(pool.submit([&completed] { completed++; }));
+    }
+    pool.wait();
+
+    EXPECT_EQ(completed.load(), 1000);
+    EXPECT_EQ(pool.getStats().executed, 1000);
+    EXPECT_EQ(pool.getStats().in_flight, 0);
+}
+
+TEST(WorkStealingPoolTest, IdleWorkersStealFromABusyOne) {
+    WorkStealingPool::Config config;
+    config.num_workers = 4;
+
+    WorkStealingPool pool(config);
+    std::mutex mutex;
+    std::set<int> ran_on;
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+
+    // Fan out onto one worker's own deque, then keep that worker busy
+    pool.submit([&] {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                std::lock_guard<std::mutex> lock(mutex);
+                ran_on.insert(WorkStealingPool::currentWorker());
+            });
+        }
+        gate.wait();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    release.set_value();
+    pool.wait();
+
+    EXPECT_GT(pool.getStats().stolen, 0);
+    EXPECT_GT(ran_on.size(), 1u);
+}
+
+TEST(WorkStealingPoolTest, SubmitBlocksAtCapacity) {
+    WorkStealingPool::Config config;
+    config.num_workers = 1;
+    config.max_in_flight = 2;
+
+    WorkStealingPool pool(config);
+    std::promise<void> release;
+    std::shared_future<void> gate = release.get_future().share();
+    pool.submit([gate] { gate.wait(); });
+    pool.submit([gate] { gate.wait(); });
+
+    auto third = std::async(std::launch::async, [&] { return pool.submit([] {}); });
+    EXPECT_EQ(third.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+    release.set_value();
+    EXPECT_TRUE(third.get());
+    pool.wait();
+    EXPECT_EQ(pool.getStats().executed, 3);
+}
+
+TEST(WorkStealingPoolTest, ReportsWorkerIndex) {
+    WorkStealingPool::Config config;
+    config.num_workers = 2;
+
+    EXPECT_EQ(WorkStealingPool::currentWorker(), -1);
+    WorkStealingPool pool(config);
+    std::atomic<bool> in_range{true};
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([&in_range] {
+            const int worker = WorkStealingPool::currentWorker();
+            if (worker < 0 || worker >= 2) {
+                in_range = false;
+            }
+        });
+    }
+    pool.wait();
+    EXPECT_TRUE(in_range.load());
+}
+
+TEST(WorkStealingPoolTest, ShutdownDrainsAndRejects) {
+    WorkStealingPool::Config config;
+    config.num_workers = 2;
+
+    std::atomic<int> completed{0};
+    WorkStealingPool pool(config);
+    for (int i = 0; i < 50; ++i) {
+        pool.submit([&completed] { completed++; });
+    }
+    pool.shutdown();
+
+    EXPECT_EQ(completed.load(), 50);
+    EXPECT_FALSE(pool.submit([] {}));
+}
+
+}  // namespace testing
+}  // namespace ventus
@@ -0,0 +1,437 @@
+// Offline bulk verification, for re-scoring an archive after a model
+// update without going through gRPC.
+//
+// Inputs are a directory (searched recursively for .jpg/.jpeg/.png), a tar
+// archive, or a text file listing one image path per line. Images run
+// through decode, preprocessing and inference on a work-stealing pool, one
+// interpreter per worker, and results are written as JSON lines in
+// completion order.
+//
+// With --checkpoint, every input whose result line has been flushed is
+// recorded, and a re-run skips it without reading it again. Results
+// written after the last checkpoint flush are redone, so an interrupted
+// run can repeat a few lines but never loses one. A checkpoint only
+// resumes with the scene model that wrote it.
+
+#include "batch_input.h"
+#include "inference_engine.h"
+#include "result_cache.h"
+#include "trace.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using ventus::BatchCheckpoint;
+using ventus::ContentHash;
+using ventus::InferenceEngine;
+using ventus::VerificationResult;
+using ventus::WorkStealingPool;
+
+struct Options {
+    std::string input;
+    std::string output;           // Empty = stdout
+    std::string checkpoint;       // Empty = not resumable
+    int checkpoint_every = 256;   // Results between checkpoint flushes
+    int jobs = 0;                 // 0 = every CPU but the reader's
+    bool pin = false;             // Pin workers and the reader to their CPUs
+    int read_ahead = 0;           // Images queued or running; 0 = 4 per job
+    InferenceEngine::Config engine;
+};
+
+volatile std::sig_atomic_t interrupted = 0;
+
+void onInterrupt(int) {
+    interrupted = 1;
+}
+
+std::string toJsonLine(const std::string& name, const VerificationResult& result) {
+    std::ostringstream line;
+    line << "{\"path\":";
+    ventus::writeJsonString(line, name);
+    line << ",\"success\":" << (result.success ? "true" : "false");
+    if (!result.success) {
+        line << ",\"error\":";
+        ventus::writeJsonString(line, result.error_message);
+        line << "}\n";
+        return line.str();
+    }
+    line << ",\"verification_passed\":" << (result.verification_passed ? "true" : "false")
+         << ",\"is_outdoor\":" << (result.is_outdoor ? "true" : "false")
+         << ",\"outdoor_confidence\":" << result.outdoor_confidence
+         << ",\"face_detected\":" << (result.face_detected ? "true" : "false")
+         << ",\"face_confidence\":" << result.face_confidence
+         << ",\"faces\":" << result.faces.size()
+         << ",\"scene_labels\":[";
+    for (size_t i = 0; i < result.scene_labels.size(); ++i) {
+        const auto& label = result.scene_labels[i];
+        line << (i ? "," : "") << "{\"label\":";
+        ventus::writeJsonString(line, ventus::sceneLabelName(label.label_id));
+        line << ",\"confidence\":" << label.confidence << "}";
+    }
+    line << "],\"decode_us\":" << result.decode.decode_time_us
+         << ",\"latency_us\":" << result.timings[ventus::Stage::kRequest] << "}\n";
+    return line.str();
+}
+
+/**
+ * Serializes result lines from the workers and advances the checkpoint
+ * only past lines that have reached the output.
+ */
+class ResultWriter {
+public:
+    ResultWriter(std::ostream& out, BatchCheckpoint& checkpoint, int checkpoint_every)
+        : out_(out), checkpoint_(checkpoint),
+          checkpoint_every_(std::max(1, checkpoint_every)), start_(Clock::now()),
+          last_report_(start_) {}
+
+    void write(const std::string& name, const std::string& line, bool success) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out_ << line;
+        completed_++;
+        if (!success) {
+            failed_++;
+        }
+        if (checkpoint_.enabled()) {
+            uncommitted_.push_back(BatchCheckpoint::key(name));
+            if (static_cast<int>(uncommitted_.size()) >= checkpoint_every_) {
+                commitLocked();
+            }
+        }
+
+        const Clock::time_point now = Clock::now();
+        if (now - last_report_ >= std::chrono::seconds(10)) {
+            last_report_ = now;
+            reportLocked(std::cerr, now);
+        }
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commitLocked();
+        out_.flush();
+    }
+
+    void report(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reportLocked(out, Clock::now());
+    }
+
+    int64_t failed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failed_;
+    }
+
+private:
+    std::ostream& out_;
+    BatchCheckpoint& checkpoint_;
+    const int checkpoint_every_;
+    const Clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::vector<ContentHash> uncommitted_;
+    int64_t completed_ = 0;
+    int64_t failed_ = 0;
+    Clock::time_point last_report_;
+
+    void commitLocked() {
+        out_.flush();
+        if (checkpoint_.enabled() && !uncommitted_.empty()) {
+            checkpoint_.commit(uncommitted_);
+            uncommitted_.clear();
+        }
+    }
+
+    void reportLocked(std::ostream& out, Clock::time_point now) const {
+        const double elapsed_s = std::chrono::duration<double>(now - start_).count();
+        out << "Processed " << completed_ << " images (" << failed_ << " failed)";
+        if (elapsed_s > 0.0) {
+            out << ", " << static_cast<int64_t>(completed_ / elapsed_s) << " images/s";
+        }
+        out << std::endl;
+    }
+};
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error("Cannot read " + path);
+    }
+    return bytes;
+}
+
+/**
+ * Open the results file: appended to when resuming from a checkpoint,
+ * after terminating a line a crash may have cut short, else replaced.
+ */
+void openOutput(std::ofstream& output, const std::string& path, bool resume) {
+    bool torn = false;
+    if (resume) {
+        std::ifstream existing(path, std::ios::binary | std::ios::ate);
+        if (existing && existing.tellg() > 0) {
+            existing.seekg(-1, std::ios::end);
+            torn = existing.get() != '\n';
+        }
+    }
+    output.open(path, resume ? std::ios::app : std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+    if (torn) {
+        output << "\n";
+    }
+}
+
+bool isImagePath(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png";
+}
+
+/**
+ * Walk the input and submit one task per image not already in the
+ * checkpoint. Files are read by the workers; archive members are read
+ * here, since a tar can only be read in order, and the pool's in-flight
+ * cap bounds how far ahead that gets. Returns, or rethrows a failure of
+ * the walk, only once every submitted task has finished.
+ * @return Inputs skipped as already done
+ */
+int64_t submitInputs(const Options& options, const BatchCheckpoint& checkpoint,
+                     InferenceEngine& engine, WorkStealingPool& pool, ResultWriter& writer) {
+    int64_t skipped = 0;
+    auto is_done = [&](const std::string& name) {
+        if (checkpoint.size() > 0 && checkpoint.contains(BatchCheckpoint::key(name))) {
+            skipped++;
+            return true;
+        }
+        return false;
+    };
+    // Tasks hold pointers to the engine and writer, never to locals here
+    InferenceEngine* const engine_ptr = &engine;
+    ResultWriter* const writer_ptr = &writer;
+    auto verify = [engine_ptr, writer_ptr](const std::string& name,
+                                           const std::vector<uint8_t>& bytes) {
+        VerificationResult result = engine_ptr->verify(bytes.data(), bytes.size());
+        writer_ptr->write(name, toJsonLine(name, result), result.success);
+    };
+    auto submit_file = [&](const std::string& path) {
+        if (is_done(path)) {
+            return;
+        }
+        pool.submit([path, verify, writer_ptr] {
+            std::vector<uint8_t> bytes;
+            try {
+                bytes = readFile(path);
+            } catch (const std::exception& e) {
+                VerificationResult failed;
+                failed.error_message = e.what();
+                writer_ptr->write(path, toJsonLine(path, failed), false);
+                return;
+            }
+            verify(path, bytes);
+        });
+    };
+
+    namespace fs = std::filesystem;
+    const fs::path input(options.input);
+    try {
+        if (fs::is_directory(input)) {
+            for (auto it = fs::recursive_directory_iterator(input);
+                 it != fs::recursive_directory_iterator() && !interrupted; ++it) {
+                if (it->is_regular_file() && isImagePath(it->path())) {
+                    submit_file(it->path().string());
+                }
+            }
+        } else if (input.extension() == ".tar") {
+            ventus::TarReader archive(options.input);
+            std::string member;
+            while (!interrupted && archive.next(&member)) {
+                const std::string name = options.input + ":" + member;
+                if (!isImagePath(member) || is_done(name)) {
+                    continue;
+                }
+                auto bytes = std::make_shared<const std::vector<uint8_t>>(archive.read());
+                pool.submit([name, bytes, verify] { verify(name, *bytes); });
+            }
+        } else {
+            std::ifstream list(options.input);
+            if (!list) {
+                throw std::runtime_error("Cannot open " + options.input);
+            }
+            std::string path;
+            while (!interrupted && std::getline(list, path)) {
+                if (!path.empty()) {
+                    submit_file(path);
+                }
+            }
+        }
+    } catch (...) {
+        pool.wait();
+        throw;
+    }
+    pool.wait();
+    return skipped;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --input PATH [options]\n"
+              << "  --input PATH            Image directory, .tar archive, or file with one path per line\n"
+              << "  --output FILE           JSON-lines results; appended to with --checkpoint (default stdout)\n"
+              << "  --checkpoint FILE       Record finished inputs; re-runs skip them\n"
+              << "  --checkpoint-every N    Results between checkpoint flushes (default 256)\n"
+              << "  --jobs N                Workers, one interpreter each (default: all CPUs but one)\n"
+              << "  --pin-threads           Pin workers to inference CPUs, input reading to the rest\n"
+              << "  --read-ahead N          Images queued or running (default 4 per job)\n"
+              << "  --model PATH            Scene model (default models/scene_classifier.tflite)\n"
+              << "  --face-model PATH       Face model; empty disables (default models/face_detector.tflite)\n"
+              << "  --gate-model PATH       Scene cascade gate model\n"
+              << "  --delegate NAME         xnnpack, builtin or minimal (default xnnpack)\n"
+              << "Exits 2 if any image failed, 130 if interrupted.\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    options.engine.scene_model_path = "models/scene_classifier.tflite";
+    options.engine.face_model_path = "models/face_detector.tflite";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) {
+            options.input = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            options.checkpoint = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            options.checkpoint_every = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            options.jobs = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--pin-threads") {
+            options.pin = true;
+        } else if (arg == "--read-ahead" && i + 1 < argc) {
+            options.read_ahead = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--model" && i + 1 < argc) {
+            options.engine.scene_model_path = argv[++i];
+        } else if (arg == "--face-model" && i + 1 < argc) {
+            options.engine.face_model_path = argv[++i];
+        } else if (arg == "--gate-model" && i + 1 < argc) {
+            options.engine.gate_model_path = argv[++i];
+        } else if (arg == "--delegate" && i + 1 < argc) {
+            options.engine.delegate = ventus::parseDelegatePolicy(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.input.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // The main thread only lists and reads input, so it keeps one CPU and
+    // the workers get the rest
+    const int cpus = ventus::CpuTopology::detect().cpuCount();
+    if (options.jobs == 0) {
+        options.jobs = std::max(1, cpus - 1);
+    }
+    if (options.read_ahead == 0) {
+        options.read_ahead = options.jobs * 4;
+    }
+
+    // One single-threaded interpreter per worker, so a worker never waits
+    // on checkout and parallelism comes from images, not from inside a
+    // model. Workers decode and preprocess their own images; the topology's
+    // one preprocessing CPU is where the reader runs.
+    options.engine.num_threads = 1;
+    options.engine.pool_size = options.jobs;
+    options.engine.preprocess_threads = 1;
+    options.engine.pin_threads = options.pin;
+    options.engine.opencv_threads = 1;
+
+    try {
+        InferenceEngine engine(options.engine);
+        if (!engine.isReady()) {
+            std::cerr << "Error: engine failed to initialize" << std::endl;
+            return 1;
+        }
+        const InferenceEngine::ModelInfo model = engine.modelInfo();
+        BatchCheckpoint checkpoint(options.checkpoint, model.model_hash);
+
+        std::ofstream output_file;
+        if (!options.output.empty()) {
+            openOutput(output_file, options.output, checkpoint.enabled());
+        }
+        std::ostream& output = options.output.empty() ? std::cout : output_file;
+
+        std::cerr << "Scene model " << model.model_path << " (" << model.model_hash << "), "
+                  << options.jobs << " workers";
+        if (checkpoint.size() > 0) {
+            std::cerr << ", resuming past " << checkpoint.size() << " finished inputs";
+        }
+        std::cerr << std::endl;
+
+        // Stop reading new inputs on Ctrl-C; queued images still finish and
+        // are checkpointed
+        std::signal(SIGINT, onInterrupt);
+        std::signal(SIGTERM, onInterrupt);
+
+        ResultWriter writer(output, checkpoint, options.checkpoint_every);
+        const ventus::ThreadTopology& topology = engine.threadTopology();
+        WorkStealingPool::Config pool_config;
+        pool_config.num_workers = options.jobs;
+        pool_config.max_in_flight = options.read_ahead;
+        if (topology.pinned()) {
+            pool_config.worker_cpus = topology.inferenceWorkerCpus();
+        }
+        WorkStealingPool pool(pool_config);
+        if (topology.pinned()) {
+            ventus::pinCurrentThread(topology.preprocessCpus());
+        }
+
+        int64_t skipped = 0;
+        try {
+            skipped = submitInputs(options, checkpoint, engine, pool, writer);
+        } catch (...) {
+            writer.flush();
+            throw;
+        }
+        writer.flush();
+
+        writer.report(std::cerr);
+        if (skipped > 0) {
+            std::cerr << "Skipped " << skipped << " inputs already in the checkpoint" << std::endl;
+        }
+        if (interrupted) {
+            std::cerr << "Interrupted; re-run with the same --checkpoint to continue" << std::endl;
+            return 130;
+        }
+        std::cerr << "Steals: " << pool.getStats().stolen << std::endl;
+        return writer.failed() > 0 ? 2 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,521 @@
+// Load generator for the verification service.
+//
+// Closed loop: N callers each send a request and wait for its response
+// before sending the next, measuring service time at that concurrency.
+//
+// Open loop: requests are sent on a fixed schedule whether or not earlier
+// ones have completed. Latency is measured from each request's scheduled
+// send time, not from when it was actually sent, so a stalled server is
+// charged for the requests it delayed (coordinated omission correction).
+//
+// Replay: open loop on the schedule recorded with a captured image set,
+// sped up or slowed down by --time-scale.
+
+#include "latency_histogram.h"
+#include "verification.grpc.pb.h"
+#include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using ventus::LatencyHistogram;
+using ventus::cv::VerificationService;
+using ventus::cv::VerifyImageRequest;
+using ventus::cv::VerifyImageResponse;
+
+enum class Mode { kClosed, kOpen, kReplay };
+
+struct Options {
+    std::string target = "localhost:50051";
+    std::string images_dir;
+    bool stream = false;         // VerifyImageStream instead of VerifyImage
+    Mode mode = Mode::kClosed;
+    int concurrency = 8;         // Closed: callers; open/replay: connections
+    double rate = 100.0;         // Open: requests per second
+    double time_scale = 1.0;     // Replay: >1 replays faster than captured
+    double duration_s = 30.0;
+    double warmup_s = 5.0;       // Excluded from the report
+    int max_outstanding = 1024;  // Open/replay: requests in flight at once
+    int deadline_ms = 10000;
+};
+
+/**
+ * A captured image and when it arrived, relative to the first one.
+ */
+struct Capture {
+    VerifyImageRequest request;
+    std::chrono::nanoseconds offset{0};
+};
+
+/**
+ * Thread-safe latency and outcome counters for the measured window.
+ */
+class Recorder {
+public:
+    explicit Recorder(Clock::time_point measure_from) : measure_from_(measure_from) {}
+
+    /**
+     * @param intended When the request was scheduled (open loop) or sent
+     *        (closed loop); latency is measured from here
+     */
+    void record(Clock::time_point intended, const grpc::Status& status,
+                const VerifyImageResponse& response) {
+        const Clock::time_point now = Clock::now();
+        if (intended < measure_from_) {
+            return;
+        }
+        const int64_t latency_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(now - intended).count();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_completion_ = std::max(last_completion_, now);
+        if (!status.ok()) {
+            errors_[status.error_code()]++;
+            return;
+        }
+        if (!response.success()) {
+            failed_++;
+        }
+        latency_.record(latency_us);
+        server_.record(response.inference_time_ms() * 1000);
+    }
+
+    void report(std::ostream& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const double elapsed_s =
+            std::chrono::duration<double>(last_completion_ - measure_from_).count();
+        int64_t errors = 0;
+        for (const auto& entry : errors_) {
+            errors += entry.second;
+        }
+        const int64_t completed = latency_.count();
+
+        out << "Requests:   " << completed + errors << " (" << errors << " RPC errors, "
+            << failed_ << " unsuccessful responses)\n";
+        if (elapsed_s > 0.0) {
+            out << "Throughput: " << static_cast<int64_t>(completed / elapsed_s) << " req/s\n";
+        }
+        for (const auto& entry : errors_) {
+            out << "  status " << entry.first << ": " << entry.second << "\n";
+        }
+        printPercentiles(out, "Latency", latency_);
+        printPercentiles(out, "Server", server_);
+    }
+
+private:
+    const Clock::time_point measure_from_;
+    mutable std::mutex mutex_;
+    LatencyHistogram latency_;
+    LatencyHistogram server_;  // inference_time_ms as reported by the server
+    std::map<int, int64_t> errors_;
+    int64_t failed_ = 0;
+    Clock::time_point last_completion_;
+
+    static void printPercentiles(std::ostream& out, const char* name,
+                                 const LatencyHistogram& histogram) {
+        char line[160];
+        std::snprintf(line, sizeof(line),
+                      "%-10s  p50 %8.2f  p90 %8.2f  p99 %8.2f  p99.9 %8.2f  max %8.2f ms\n",
+                      name, histogram.percentile(50) / 1000.0, histogram.percentile(90) / 1000.0,
+                      histogram.percentile(99) / 1000.0, histogram.percentile(99.9) / 1000.0,
+                      histogram.max() / 1000.0);
+        out << line;
+    }
+};
+
+/**
+ * Load images from a directory. The replay schedule comes from
+ * `replay.csv` (`<offset_ms>,<file>` per line) when present, else from
+ * file modification times.
+ */
+std::vector<Capture> loadCaptures(const std::string& dir) {
+    namespace fs = std::filesystem;
+
+    auto readFile = [](const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Failed to read " + path.string());
+        }
+        std::ostringstream data;
+        data << in.rdbuf();
+        return data.str();
+    };
+
+    std::vector<std::pair<std::chrono::nanoseconds, fs::path>> schedule;
+    const fs::path manifest = fs::path(dir) / "replay.csv";
+    if (fs::exists(manifest)) {
+        std::ifstream in(manifest);
+        std::string line;
+        while (std::getline(in, line)) {
+            const size_t comma = line.find(',');
+            if (line.empty() || line[0] == '#' || comma == std::string::npos) {
+                continue;
+            }
+            const auto offset = std::chrono::duration<double, std::milli>(
+                std::stod(line.substr(0, comma)));
+            schedule.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(offset),
+                                  fs::path(dir) / line.substr(comma + 1));
+        }
+    } else {
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.is_regular_file()) {
+                schedule.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          entry.last_write_time().time_since_epoch()),
+                                      entry.path());
+            }
+        }
+        std::sort(schedule.begin(), schedule.end());
+        if (!schedule.empty()) {
+            const auto first = schedule.front().first;
+            for (auto& item : schedule) {
+                item.first -= first;
+            }
+        }
+    }
+
+    std::vector<Capture> captures(schedule.size());
+    for (size_t i = 0; i < schedule.size(); ++i) {
+        captures[i].offset = schedule[i].first;
+        captures[i].request.set_image_data(readFile(schedule[i].second));
+        captures[i].request.set_request_id(schedule[i].second.filename().string());
+    }
+    if (captures.empty()) {
+        throw std::runtime_error("No images found in " + dir);
+    }
+    return captures;
+}
+
+std::vector<std::unique_ptr<VerificationService::Stub>> connect(const Options& options) {
+    std::vector<std::unique_ptr<VerificationService::Stub>> stubs;
+    for (int i = 0; i < options.concurrency; ++i) {
+        // A local subchannel pool gives each stub its own HTTP/2 connection
+        grpc::ChannelArguments args;
+        args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+        args.SetMaxReceiveMessageSize(-1);
+        args.SetMaxSendMessageSize(-1);
+        stubs.push_back(VerificationService::NewStub(grpc::CreateCustomChannel(
+            options.target, grpc::InsecureChannelCredentials(), args)));
+    }
+    return stubs;
+}
+
+void setDeadline(grpc::ClientContext& context, const Options& options) {
+    context.set_deadline(std::chrono::system_clock::now() +
+                         std::chrono::milliseconds(options.deadline_ms));
+}
+
+void runClosedLoop(const Options& options, const std::vector<Capture>& captures,
+                   Clock::time_point end, Recorder& recorder) {
+    auto stubs = connect(options);
+    std::atomic<size_t> next{0};
+
+    std::vector<std::thread> callers;
+    for (int c = 0; c < options.concurrency; ++c) {
+        callers.emplace_back([&, c] {
+            VerificationService::Stub& stub = *stubs[c];
+
+            if (!options.stream) {
+                while (Clock::now() < end) {
+                    const Capture& capture = captures[next++ % captures.size()];
+                    grpc::ClientContext context;
+                    setDeadline(context, options);
+                    VerifyImageResponse response;
+                    const Clock::time_point sent = Clock::now();
+                    grpc::Status status = stub.VerifyImage(&context, capture.request, &response);
+                    recorder.record(sent, status, response);
+                }
+                return;
+            }
+
+            // One request in flight per stream, so responses arrive in order
+            grpc::ClientContext context;
+            auto stream = stub.VerifyImageStream(&context);
+            VerifyImageResponse response;
+            while (Clock::now() < end) {
+                const Capture& capture = captures[next++ % captures.size()];
+                const Clock::time_point sent = Clock::now();
+                if (!stream->Write(capture.request) || !stream->Read(&response)) {
+                    break;
+                }
+                recorder.record(sent, grpc::Status::OK, response);
+            }
+            stream->WritesDone();
+            grpc::Status status = stream->Finish();
+            if (!status.ok()) {
+                recorder.record(Clock::now(), status, response);
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+}
+
+/**
+ * Caps requests in flight in open-loop modes, so an overloaded server
+ * delays sends rather than exhausting client memory. Delayed requests are
+ * still timed from their scheduled send.
+ */
+class Outstanding {
+public:
+    explicit Outstanding(int limit) : limit_(limit) {}
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        released_.wait(lock, [this] { return count_ < limit_; });
+        count_++;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_--;
+        released_.notify_all();
+    }
+
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        released_.wait(lock, [this] { return count_ == 0; });
+    }
+
+private:
+    const int limit_;
+    std::mutex mutex_;
+    std::condition_variable released_;
+    int count_ = 0;
+};
+
+/**
+ * Open-loop stream connection: the dispatcher writes, a reader thread
+ * matches responses back to their scheduled send time by request ID.
+ */
+struct OpenStream {
+    grpc::ClientContext context;
+    std::unique_ptr<grpc::ClientReaderWriter<VerifyImageRequest, VerifyImageResponse>> stream;
+    std::mutex mutex;
+    std::unordered_map<std::string, Clock::time_point> pending;
+    bool closed = false;  // Reader saw the stream end
+    std::thread reader;
+};
+
+template <typename ScheduleFn>
+void runOpenLoop(const Options& options, std::vector<Capture>& captures,
+                 ScheduleFn schedule, Clock::time_point end, Recorder& recorder) {
+    auto stubs = connect(options);
+    Outstanding outstanding(options.max_outstanding);
+
+    std::vector<std::unique_ptr<OpenStream>> streams;
+    if (options.stream) {
+        for (auto& stub : stubs) {
+            auto open = std::make_unique<OpenStream>();
+            open->stream = stub->VerifyImageStream(&open->context);
+            OpenStream* raw = open.get();
+            open->reader = std::thread([raw, &outstanding, &recorder] {
+                VerifyImageResponse response;
+                while (raw->stream->Read(&response)) {
+                    Clock::time_point intended;
+                    {
+                        std::lock_guard<std::mutex> lock(raw->mutex);
+                        auto found = raw->pending.find(response.request_id());
+                        if (found == raw->pending.end()) {
+                            continue;
+                        }
+                        intended = found->second;
+                        raw->pending.erase(found);
+                    }
+                    recorder.record(intended, grpc::Status::OK, response);
+                    outstanding.release();
+                }
+
+                // The stream ended; nothing still pending will come back
+                std::lock_guard<std::mutex> lock(raw->mutex);
+                const grpc::Status lost(grpc::StatusCode::UNAVAILABLE, "Stream closed");
+                for (const auto& entry : raw->pending) {
+                    recorder.record(entry.second, lost, VerifyImageResponse());
+                    outstanding.release();
+                }
+                raw->pending.clear();
+                raw->closed = true;
+            });
+            streams.push_back(std::move(open));
+        }
+    }
+
+    for (uint64_t i = 0;; ++i) {
+        const Clock::time_point intended = schedule(i);
+        if (intended >= end) {
+            break;
+        }
+        std::this_thread::sleep_until(intended);
+        outstanding.acquire();
+
+        const size_t connection = i % stubs.size();
+        Capture& capture = captures[i % captures.size()];
+
+        if (options.stream) {
+            // Unique per write; the dispatcher is the only writer, so the
+            // shared request can be relabelled in place
+            OpenStream& open = *streams[connection];
+            const std::string id = std::to_string(i);
+            {
+                std::lock_guard<std::mutex> lock(open.mutex);
+                if (open.closed) {
+                    recorder.record(intended, grpc::Status(grpc::StatusCode::UNAVAILABLE,
+                                                           "Stream closed"),
+                                    VerifyImageResponse());
+                    outstanding.release();
+                    continue;
+                }
+                open.pending[id] = intended;
+            }
+            capture.request.set_request_id(id);
+            // A failed write is accounted for by the reader once it sees the
+            // stream end
+            open.stream->Write(capture.request);
+            continue;
+        }
+
+        struct Call {
+            grpc::ClientContext context;
+            VerifyImageResponse response;
+        };
+        auto* call = new Call;
+        setDeadline(call->context, options);
+        stubs[connection]->async()->VerifyImage(
+            &call->context, &capture.request, &call->response,
+            [call, intended, &recorder, &outstanding](grpc::Status status) {
+                recorder.record(intended, status, call->response);
+                delete call;
+                outstanding.release();
+            });
+    }
+
+    if (!options.stream) {
+        outstanding.drain();
+        return;
+    }
+    for (auto& open : streams) {
+        open->stream->WritesDone();
+        open->reader.join();
+        grpc::Status status = open->stream->Finish();
+        if (!status.ok()) {
+            std::cerr << "Stream ended with " << status.error_message() << std::endl;
+        }
+    }
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --images DIR [options]\n"
+              << "  --target HOST:PORT      Server address (default localhost:50051)\n"
+              << "  --rpc unary|stream      VerifyImage or VerifyImageStream (default unary)\n"
+              << "  --mode closed|open|replay\n"
+              << "  --concurrency N         Closed: callers; open/replay: connections (default 8)\n"
+              << "  --rate R                Open: requests per second (default 100)\n"
+              << "  --time-scale X          Replay: speed-up over the captured timing (default 1)\n"
+              << "  --duration S            Run time in seconds (default 30)\n"
+              << "  --warmup S              Seconds excluded from the report (default 5)\n"
+              << "  --max-outstanding N     Open/replay: requests in flight (default 1024)\n"
+              << "  --deadline-ms MS        Per-request deadline (default 10000)\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--target" && i + 1 < argc) {
+            options.target = argv[++i];
+        } else if (arg == "--images" && i + 1 < argc) {
+            options.images_dir = argv[++i];
+        } else if (arg == "--rpc" && i + 1 < argc) {
+            options.stream = std::string(argv[++i]) == "stream";
+        } else if (arg == "--mode" && i + 1 < argc) {
+            const std::string mode = argv[++i];
+            options.mode = mode == "open" ? Mode::kOpen
+                         : mode == "replay" ? Mode::kReplay
+                         : Mode::kClosed;
+        } else if (arg == "--concurrency" && i + 1 < argc) {
+            options.concurrency = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            options.rate = std::stod(argv[++i]);
+        } else if (arg == "--time-scale" && i + 1 < argc) {
+            options.time_scale = std::stod(argv[++i]);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            options.duration_s = std::stod(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup_s = std::stod(argv[++i]);
+        } else if (arg == "--max-outstanding" && i + 1 < argc) {
+            options.max_outstanding = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--deadline-ms" && i + 1 < argc) {
+            options.deadline_ms = std::stoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.images_dir.empty() || options.rate <= 0.0 || options.time_scale <= 0.0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::vector<Capture> captures = loadCaptures(options.images_dir);
+        std::cout << "Loaded " << captures.size() << " images" << std::endl;
+
+        const Clock::time_point start = Clock::now();
+        const auto seconds = [](double s) {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(s));
+        };
+        const Clock::time_point end = start + seconds(options.duration_s);
+        Recorder recorder(start + seconds(options.warmup_s));
+
+        switch (options.mode) {
+        case Mode::kClosed:
+            runClosedLoop(options, captures, end, recorder);
+            break;
+        case Mode::kOpen: {
+            const auto interval = seconds(1.0 / options.rate);
+            runOpenLoop(options, captures,
+                        [&](uint64_t i) { return start + interval * static_cast<int64_t>(i); },
+                        end, recorder);
+            break;
+        }
+        case Mode::kReplay: {
+            // One pass over the capture; --duration still cuts it short
+            const double scale = options.time_scale;
+            runOpenLoop(options, captures,
+                        [&](uint64_t i) {
+                            if (i >= captures.size()) {
+                                return Clock::time_point::max();
+                            }
+                            return start + std::chrono::duration_cast<Clock::duration>(
+                                               captures[i].offset / scale);
+                        },
+                        end, recorder);
+            break;
+        }
+        }
+
+        recorder.report(std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
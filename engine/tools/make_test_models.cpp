@@ -0,0 +1,438 @@
+// Writes small, deterministic stand-in models with the tensor shapes and
+// op mix of the production ones, so tests, benchmarks and load tests run
+// without the real model files:
+//
+//   scene_float.tflite  MobileNet-style scene classifier, 51-way softmax
+//   scene_int8.tflite   The same weights quantized to int8 end to end
+//   face_float.tflite   BlazeFace-shaped detector, 896 anchors, no faces
+//   face_hits.tflite    The same detector with every anchor scoring high
+//
+// Usage: ventus_make_test_models <output_dir>
+
+#include "flatbuffers/flatbuffers.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// kOutdoorLabels followed by kIndoorLabels
+constexpr int kSceneClasses = 51;
+constexpr uint32_t kSeed = 20240611;
+
+/**
+ * Affine int8 quantization of an activation tensor. Ignored by float models.
+ */
+struct Quant {
+    float scale = 1.0f;
+    int zero_point = 0;
+
+    // Parameters covering [min, max]
+    static Quant range(float min, float max) {
+        Quant quant;
+        quant.scale = (max - min) / 255.0f;
+        quant.zero_point = -128 - static_cast<int>(std::lround(min / quant.scale));
+        return quant;
+    }
+};
+
+/**
+ * xorshift32, so the generated weights are identical on every platform
+ * and standard library.
+ */
+class Random {
+public:
+    explicit Random(uint32_t seed) : state_(seed) {}
+
+    // Uniform in [-limit, limit)
+    float uniform(float limit) {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return limit * (static_cast<float>(state_ >> 8) / 8388608.0f - 1.0f);
+    }
+
+private:
+    uint32_t state_;
+};
+
+/**
+ * Builds a single-subgraph model, in float or with int8 activations,
+ * per-channel int8 weights and int32 biases.
+ */
+class GraphBuilder {
+public:
+    GraphBuilder(bool quantized, uint32_t seed) : quantized_(quantized), random_(seed) {
+        model_.version = 3;
+        model_.subgraphs.push_back(std::make_unique<tflite::SubGraphT>());
+        graph_ = model_.subgraphs.back().get();
+        // Buffer 0 is the empty sentinel for tensors without data
+        model_.buffers.push_back(std::make_unique<tflite::BufferT>());
+    }
+
+    int input(const std::vector<int32_t>& shape, const Quant& quant) {
+        const int tensor = activation(shape, quant, "input");
+        graph_->inputs.push_back(tensor);
+        return tensor;
+    }
+
+    void output(int tensor) { graph_->outputs.push_back(tensor); }
+
+    /**
+     * SAME-padded convolution with He-uniform weights.
+     * @param gain Weight scale relative to He initialization
+     * @param bias Value of every bias
+     */
+    int conv(int input, int channels, int kernel, int stride, const Quant& quant,
+             tflite::ActivationFunctionType activation_fn = tflite::ActivationFunctionType_RELU6,
+             float gain = 1.0f, float bias = 0.0f) {
+        const std::vector<int32_t>& in = shape(input);
+        const int in_channels = in[3];
+        const float limit = gain * std::sqrt(6.0f / (kernel * kernel * in_channels));
+        const int filter = weights({channels, kernel, kernel, in_channels}, 0, limit, "conv_filter");
+        const int biases = biasTensor(input, filter, channels, bias, "conv_bias");
+        const int out = activation({in[0], outSize(in[1], stride), outSize(in[2], stride), channels},
+                                   quant, "conv");
+
+        tflite::Conv2DOptionsT options;
+        options.padding = tflite::Padding_SAME;
+        options.stride_w = stride;
+        options.stride_h = stride;
+        options.fused_activation_function = activation_fn;
+        addOperator(tflite::BuiltinOperator_CONV_2D, {input, filter, biases}, {out}, options);
+        return out;
+    }
+
+    int depthwise(int input, int kernel, int stride, const Quant& quant) {
+        const std::vector<int32_t>& in = shape(input);
+        const int channels = in[3];
+        const float limit = std::sqrt(6.0f / (kernel * kernel));
+        const int filter = weights({1, kernel, kernel, channels}, 3, limit, "depthwise_filter");
+        const int biases = biasTensor(input, filter, channels, 0.0f, "depthwise_bias");
+        const int out = activation({in[0], outSize(in[1], stride), outSize(in[2], stride), channels},
+                                   quant, "depthwise");
+
+        tflite::DepthwiseConv2DOptionsT options;
+        options.padding = tflite::Padding_SAME;
+        options.stride_w = stride;
+        options.stride_h = stride;
+        options.depth_multiplier = 1;
+        options.fused_activation_function = tflite::ActivationFunctionType_RELU6;
+        addOperator(tflite::BuiltinOperator_DEPTHWISE_CONV_2D, {input, filter, biases}, {out},
+                    options);
+        return out;
+    }
+
+    // Global average pool over height and width
+    int mean(int input) {
+        const std::vector<int32_t>& in = shape(input);
+        const int32_t axes[] = {1, 2};
+        const int axis = constant({2}, tflite::TensorType_INT32, axes, sizeof(axes), nullptr, "axes");
+        const int out = activation({in[0], in[3]}, quantOf(input), "mean");
+
+        tflite::ReducerOptionsT options;
+        options.keep_dims = false;
+        addOperator(tflite::BuiltinOperator_MEAN, {input, axis}, {out}, options);
+        return out;
+    }
+
+    int fullyConnected(int input, int units, const Quant& quant, float gain) {
+        const std::vector<int32_t>& in = shape(input);
+        const float limit = gain * std::sqrt(6.0f / in[1]);
+        const int filter = weights({units, in[1]}, -1, limit, "fc_filter");
+        const int biases = biasTensor(input, filter, units, 0.0f, "fc_bias");
+        const int out = activation({in[0], units}, quant, "logits");
+
+        tflite::FullyConnectedOptionsT options;
+        options.fused_activation_function = tflite::ActivationFunctionType_NONE;
+        addOperator(tflite::BuiltinOperator_FULLY_CONNECTED, {input, filter, biases}, {out},
+                    options);
+        return out;
+    }
+
+    int softmax(int input) {
+        // The int8 kernel requires exactly this output quantization
+        const int out = activation(shape(input), Quant{1.0f / 256.0f, -128}, "scores");
+
+        tflite::SoftmaxOptionsT options;
+        options.beta = 1.0f;
+        addOperator(tflite::BuiltinOperator_SOFTMAX, {input}, {out}, options);
+        return out;
+    }
+
+    int reshape(int input, const std::vector<int32_t>& new_shape) {
+        const int target = constant({static_cast<int32_t>(new_shape.size())},
+                                    tflite::TensorType_INT32, new_shape.data(),
+                                    new_shape.size() * sizeof(int32_t), nullptr, "shape");
+        const int out = activation(new_shape, quantOf(input), "reshape");
+
+        tflite::ReshapeOptionsT options;
+        options.new_shape = new_shape;
+        addOperator(tflite::BuiltinOperator_RESHAPE, {input, target}, {out}, options);
+        return out;
+    }
+
+    int concat(const std::vector<int32_t>& inputs, int axis) {
+        std::vector<int32_t> out_shape = shape(inputs[0]);
+        out_shape[axis] = 0;
+        for (int input : inputs) {
+            out_shape[axis] += shape(input)[axis];
+        }
+        const int out = activation(out_shape, quantOf(inputs[0]), "concat");
+
+        tflite::ConcatenationOptionsT options;
+        options.axis = axis;
+        addOperator(tflite::BuiltinOperator_CONCATENATION, inputs, {out}, options);
+        return out;
+    }
+
+    /**
+     * Serialize the model as a .tflite flatbuffer.
+     */
+    std::vector<uint8_t> finish(const std::string& description) {
+        model_.description = description;
+        flatbuffers::FlatBufferBuilder builder;
+        tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, &model_));
+        return std::vector<uint8_t>(builder.GetBufferPointer(),
+                                    builder.GetBufferPointer() + builder.GetSize());
+    }
+
+private:
+    bool quantized_;
+    Random random_;
+    tflite::ModelT model_;
+    tflite::SubGraphT* graph_;
+    std::map<tflite::BuiltinOperator, uint32_t> opcodes_;
+
+    static int outSize(int size, int stride) { return (size + stride - 1) / stride; }
+
+    const std::vector<int32_t>& shape(int tensor) const { return graph_->tensors[tensor]->shape; }
+
+    Quant quantOf(int tensor) const {
+        Quant quant;
+        if (const auto& params = graph_->tensors[tensor]->quantization) {
+            quant.scale = params->scale[0];
+            quant.zero_point = static_cast<int>(params->zero_point[0]);
+        }
+        return quant;
+    }
+
+    static std::unique_ptr<tflite::QuantizationParametersT> quantization(
+        const std::vector<float>& scales, int zero_point, int dimension) {
+        auto params = std::make_unique<tflite::QuantizationParametersT>();
+        params->scale = scales;
+        params->zero_point.assign(scales.size(), zero_point);
+        params->quantized_dimension = dimension;
+        return params;
+    }
+
+    int addTensor(const std::vector<int32_t>& shape, tflite::TensorType type, uint32_t buffer,
+                  std::unique_ptr<tflite::QuantizationParametersT> quant, const std::string& name) {
+        auto tensor = std::make_unique<tflite::TensorT>();
+        tensor->shape = shape;
+        tensor->type = type;
+        tensor->buffer = buffer;
+        tensor->name = name + "_" + std::to_string(graph_->tensors.size());
+        tensor->quantization = std::move(quant);
+        graph_->tensors.push_back(std::move(tensor));
+        return static_cast<int>(graph_->tensors.size() - 1);
+    }
+
+    int activation(const std::vector<int32_t>& shape, const Quant& quant, const std::string& name) {
+        if (!quantized_) {
+            return addTensor(shape, tflite::TensorType_FLOAT32, 0, nullptr, name);
+        }
+        return addTensor(shape, tflite::TensorType_INT8, 0,
+                         quantization({quant.scale}, quant.zero_point, 0), name);
+    }
+
+    int constant(const std::vector<int32_t>& shape, tflite::TensorType type, const void* data,
+                 size_t bytes, std::unique_ptr<tflite::QuantizationParametersT> quant,
+                 const std::string& name) {
+        auto buffer = std::make_unique<tflite::BufferT>();
+        buffer->data.resize(bytes);
+        std::memcpy(buffer->data.data(), data, bytes);
+        model_.buffers.push_back(std::move(buffer));
+        return addTensor(shape, type, static_cast<uint32_t>(model_.buffers.size() - 1),
+                         std::move(quant), name);
+    }
+
+    /**
+     * Random weights, quantized symmetrically per slice of `channel_dim`
+     * (-1 for a single per-tensor scale) in int8 models.
+     */
+    int weights(const std::vector<int32_t>& shape, int channel_dim, float limit,
+                const std::string& name) {
+        size_t count = 1;
+        for (int32_t dim : shape) {
+            count *= dim;
+        }
+        std::vector<float> values(count);
+        for (float& value : values) {
+            value = random_.uniform(limit);
+        }
+        if (!quantized_) {
+            return constant(shape, tflite::TensorType_FLOAT32, values.data(),
+                            values.size() * sizeof(float), nullptr, name);
+        }
+
+        // Elements of channel c are those whose index along channel_dim is c
+        const int channels = channel_dim < 0 ? 1 : shape[channel_dim];
+        size_t inner = 1;
+        for (size_t d = channel_dim < 0 ? shape.size() : channel_dim + 1; d < shape.size(); ++d) {
+            inner *= shape[d];
+        }
+        auto channelOf = [&](size_t i) { return static_cast<int>((i / inner) % channels); };
+
+        std::vector<float> scales(channels, 0.0f);
+        for (size_t i = 0; i < count; ++i) {
+            scales[channelOf(i)] = std::max(scales[channelOf(i)], std::fabs(values[i]));
+        }
+        for (float& scale : scales) {
+            scale = scale > 0.0f ? scale / 127.0f : 1.0f;
+        }
+        std::vector<int8_t> quantized(count);
+        for (size_t i = 0; i < count; ++i) {
+            const long q = std::lround(values[i] / scales[channelOf(i)]);
+            quantized[i] = static_cast<int8_t>(std::min(127L, std::max(-127L, q)));
+        }
+        return constant(shape, tflite::TensorType_INT8, quantized.data(), quantized.size(),
+                        quantization(scales, 0, std::max(0, channel_dim)), name);
+    }
+
+    // Biases are int32 at input scale x weight scale in int8 models
+    int biasTensor(int input, int filter, int channels, float bias, const std::string& name) {
+        std::vector<float> values(channels, bias);
+        if (!quantized_) {
+            return constant({channels}, tflite::TensorType_FLOAT32, values.data(),
+                            values.size() * sizeof(float), nullptr, name);
+        }
+
+        const float input_scale = quantOf(input).scale;
+        const std::vector<float>& filter_scales = graph_->tensors[filter]->quantization->scale;
+        std::vector<float> scales(channels);
+        std::vector<int32_t> quantized(channels);
+        for (int c = 0; c < channels; ++c) {
+            scales[c] = input_scale * filter_scales[filter_scales.size() == 1 ? 0 : c];
+            quantized[c] = static_cast<int32_t>(std::lround(values[c] / scales[c]));
+        }
+        return constant({channels}, tflite::TensorType_INT32, quantized.data(),
+                        quantized.size() * sizeof(int32_t), quantization(scales, 0, 0), name);
+    }
+
+    template <typename Options>
+    void addOperator(tflite::BuiltinOperator op, const std::vector<int32_t>& inputs,
+                     const std::vector<int32_t>& outputs, Options options) {
+        auto found = opcodes_.find(op);
+        if (found == opcodes_.end()) {
+            auto code = std::make_unique<tflite::OperatorCodeT>();
+            code->builtin_code = op;
+            code->deprecated_builtin_code = static_cast<int8_t>(op);
+            code->version = 1;
+            model_.operator_codes.push_back(std::move(code));
+            found = opcodes_.emplace(op, static_cast<uint32_t>(model_.operator_codes.size() - 1))
+                        .first;
+        }
+
+        auto operation = std::make_unique<tflite::OperatorT>();
+        operation->opcode_index = found->second;
+        operation->inputs = inputs;
+        operation->outputs = outputs;
+        operation->builtin_options.Set(std::move(options));
+        graph_->operators.push_back(std::move(operation));
+    }
+};
+
+// ReLU6 activations span [0, 6]
+const Quant kRelu6 = Quant::range(0.0f, 6.0f);
+
+std::vector<uint8_t> sceneModel(bool quantized) {
+    GraphBuilder graph(quantized, kSeed);
+
+    // ImageNet-normalized pixels span about [-2.12, 2.64]
+    int x = graph.input({1, 224, 224, 3}, Quant::range(-2.12f, 2.64f));
+    x = graph.conv(x, 16, 3, 2, kRelu6);
+    x = graph.depthwise(x, 3, 2, kRelu6);
+    x = graph.conv(x, 32, 1, 1, kRelu6);
+    x = graph.depthwise(x, 3, 2, kRelu6);
+    x = graph.conv(x, 64, 1, 1, kRelu6);
+    x = graph.depthwise(x, 3, 2, kRelu6);
+    x = graph.mean(x);
+    // Small logits keep the softmax spread out but input-dependent
+    x = graph.fullyConnected(x, kSceneClasses, Quant::range(-8.0f, 8.0f), 0.25f);
+    graph.output(graph.softmax(x));
+
+    return graph.finish(quantized ? "Synthetic int8 scene classifier"
+                                  : "Synthetic float scene classifier");
+}
+
+std::vector<uint8_t> faceModel(float score_bias) {
+    GraphBuilder graph(false, kSeed + 1);
+
+    int x = graph.input({1, 128, 128, 3}, Quant::range(-1.0f, 1.0f));
+    x = graph.conv(x, 16, 3, 2, kRelu6);
+    x = graph.depthwise(x, 3, 2, kRelu6);
+    x = graph.conv(x, 24, 1, 1, kRelu6);
+    const int fine = graph.depthwise(x, 3, 2, kRelu6);  // 16x16, stride 8
+    x = graph.depthwise(fine, 3, 2, kRelu6);
+    const int coarse = graph.conv(x, 32, 1, 1, kRelu6);  // 8x8, stride 16
+
+    // Per-cell heads flattened to anchors in BlazeFace order: 2 per cell on
+    // the 16x16 grid, then 6 per cell on the 8x8 grid
+    const auto none = tflite::ActivationFunctionType_NONE;
+    const Quant unused;
+    const int fine_boxes = graph.reshape(graph.conv(fine, 2 * 16, 1, 1, unused, none), {1, 512, 16});
+    const int coarse_boxes = graph.reshape(graph.conv(coarse, 6 * 16, 1, 1, unused, none),
+                                           {1, 384, 16});
+    // Near-zero weights leave every logit at about the bias: a strongly
+    // negative one never clears a sane score threshold, a positive one
+    // always does
+    const int fine_scores = graph.reshape(
+        graph.conv(fine, 2, 1, 1, unused, none, 0.01f, score_bias), {1, 512, 1});
+    const int coarse_scores = graph.reshape(
+        graph.conv(coarse, 6, 1, 1, unused, none, 0.01f, score_bias), {1, 384, 1});
+
+    graph.output(graph.concat({fine_boxes, coarse_boxes}, 1));
+    graph.output(graph.concat({fine_scores, coarse_scores}, 1));
+    return graph.finish("Synthetic BlazeFace-shaped face detector");
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!out) {
+        throw std::runtime_error("Failed to write " + path.string());
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <output_dir>" << std::endl;
+        return 1;
+    }
+
+    try {
+        const std::filesystem::path dir(argv[1]);
+        std::filesystem::create_directories(dir);
+        writeFile(dir / "scene_float.tflite", sceneModel(false));
+        writeFile(dir / "scene_int8.tflite", sceneModel(true));
+        writeFile(dir / "face_float.tflite", faceModel(-6.0f));
+        writeFile(dir / "face_hits.tflite", faceModel(6.0f));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}